@@ -1,20 +1,32 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Application.h"
+#include "gemcutter/Application/Lock.h"
 #include "gemcutter/Application/Logging.h"
+#include "gemcutter/Application/Profiler.h"
+#include "gemcutter/Application/Threading.h"
 #include "gemcutter/Application/Timer.h"
-#include "gemcutter/Input/Input.h"
+#include "gemcutter/Math/Math.h"
 #include "gemcutter/Rendering/Light.h"
 #include "gemcutter/Rendering/ParticleEmitter.h"
 #include "gemcutter/Rendering/Rendering.h"
 #include "gemcutter/Resource/Font.h"
 #include "gemcutter/Resource/Model.h"
 #include "gemcutter/Resource/ParticleBuffer.h"
+#include "gemcutter/Resource/Resource.h"
 #include "gemcutter/Resource/Shader.h"
 #include "gemcutter/Resource/Texture.h"
 #include "gemcutter/Resource/VertexArray.h"
 #include "gemcutter/Sound/SoundSystem.h"
+#include "gemcutter/Utilities/ScopeGuard.h"
 
+#include <algorithm>
+#include <chrono>
 #include <glew/glew.h>
+#include <thread>
+
+#ifdef _WIN32
+#include "gemcutter/Input/Input.h"
+
 #include <glew/wglew.h>
 
 // This is the HINSTANCE of the application.
@@ -230,6 +242,7 @@ namespace
 	}
 #endif
 }
+#endif
 
 namespace gem
 {
@@ -237,6 +250,7 @@ namespace gem
 
 	void ApplicationSingleton::DrainEventQueue()
 	{
+#ifdef _WIN32
 		// Windows message loop.
 		MSG msg;
 		while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
@@ -259,10 +273,30 @@ namespace gem
 				DispatchMessage(&msg);
 			}
 		}
+#endif
+	}
+
+	bool ApplicationSingleton::HasWindow() const
+	{
+#ifdef _WIN32
+		return hwnd != NULL;
+#else
+		return false;
+#endif
+	}
+
+	void ApplicationSingleton::PresentFrame()
+	{
+		GEM_PROFILE_SCOPE("Application::PresentFrame");
+
+#ifdef _WIN32
+		SwapBuffers(deviceContext);
+#endif
 	}
 
 	bool ApplicationSingleton::CreateGameWindow(std::string_view title, unsigned _glMajorVersion, unsigned _glMinorVersion)
 	{
+#ifdef _WIN32
 		ASSERT(hwnd == NULL, "A game window is already open.");
 		ASSERT(_glMajorVersion > 3 || (_glMajorVersion == 3 && _glMinorVersion == 3), "OpenGL version must be 3.3 or greater.");
 
@@ -320,11 +354,15 @@ namespace gem
 		SetUpdatesPerSecond(updatesPerSecond);
 
 		return true;
+#else
+		Error("Console: Game windows are only supported on Windows.");
+		return false;
+#endif
 	}
 
 	void ApplicationSingleton::DestroyGameWindow()
 	{
-		ASSERT(hwnd != NULL, "A game window must be created before calling this function.");
+		ASSERT(HasWindow(), "A game window must be created before calling this function.");
 
 		// Delete all resources that require the OpenGL context.
 		UnloadAll<Font>();
@@ -344,6 +382,7 @@ namespace gem
 		// Some drivers will emit erroneous errors on shutdown, so we disable debug info first.
 		glDebugMessageCallback(NULL, NULL);
 #endif
+#ifdef _WIN32
 		// Release Device and Render Contexts.
 		wglMakeCurrent(NULL, NULL);
 		wglDeleteContext(renderContext);
@@ -354,6 +393,7 @@ namespace gem
 		renderContext = NULL;
 		deviceContext = NULL;
 		hwnd = NULL;
+#endif
 	}
 
 	void ApplicationSingleton::GameLoop(const std::function<void()>& update, const std::function<void()>& draw)
@@ -361,18 +401,31 @@ namespace gem
 		ASSERT(update, "An update function must be provided.");
 		ASSERT(draw, "A draw function must be provided.");
 
-		if (hwnd == NULL)
+		if (!HasWindow())
 		{
 			Error("Application: Must be initialized and have a window created before a call to GameLoop().");
 			return;
 		}
 
+		if (!JobSystem.IsRunning())
+		{
+			JobSystem.Start();
+		}
+
 		// Timing control variables.
-		constexpr unsigned MAX_CONCURRENT_UPDATES = 5;
 		unsigned fpsCounter = 0;
-		__int64 lastUpdate = Timer::GetCurrentTick();
-		__int64 lastRender = lastUpdate;
-		__int64 lastFpsCapture = lastRender;
+		frameClock.Reset();
+		std::int64_t lastUpdate = frameClock.GetFrameTick();
+		std::int64_t lastRender = lastUpdate;
+		std::int64_t lastFpsCapture = lastRender;
+		std::int64_t lastFrameEnd = lastRender;
+		// The time spent updating since the last frame.
+		std::int64_t updateTicks = 0;
+
+		defer { SaveFrameStats(); };
+
+		// Otherwise, on Windows, every sleep between updates would last a whole 15.6ms scheduler tick.
+		const SleepResolutionScope sleepResolution;
 
 		while (true)
 		{
@@ -381,64 +434,347 @@ namespace gem
 			if (!appIsRunning)
 				return;
 
-			// Record the FPS for the previous second of time.
-			__int64 currentTime = Timer::GetCurrentTick();
-			if (currentTime - lastFpsCapture >= Timer::GetTicksPerSecond())
-			{
-				// We don't want to update the timer variable with "+= 1.0" here. After a lag spike this
-				// would cause FPS to suddenly be recorded more often than once a second.
-				lastFpsCapture = currentTime;
-
-				fps = fpsCounter;
-				fpsCounter = 0;
-			}
+			std::int64_t currentTime = frameClock.Tick();
+			RecordFPS(currentTime, lastFpsCapture, fpsCounter);
+			Profiler.Collect();
 
 			// Update to keep up with real time.
-			unsigned updateCount = 0;
-			while (currentTime - lastUpdate >= updateStep)
+			const std::int64_t updateStart = Timer::GetCurrentTick();
+			unsigned updateCount = StepSimulation(update, currentTime, lastUpdate);
+			if (updateCount > 0)
 			{
-				update();
-
-				// The user might have requested to exit during update().
-				if (!appIsRunning)
-					return;
+				updateTicks += Timer::GetCurrentTick() - updateStart;
+			}
 
-				lastUpdate += updateStep;
-				updateCount++;
+			// The user might have requested to exit during update().
+			if (!appIsRunning)
+				return;
 
-				if (skipToPresent)
+			if (updateCount > 0)
+			{
+				// If the frame rate is uncapped or we are due for a new frame, render the latest game-state.
+				if (FPSCap == 0 || (currentTime - lastRender) >= renderStep)
 				{
-					lastUpdate = currentTime;
-					skipToPresent = false;
-					break;
+					GEM_PROFILE_SCOPE("Application::Draw");
+					const std::int64_t renderStart = Timer::GetCurrentTick();
+					interpolation = GetStepFraction(currentTime - lastUpdate);
+					draw();
+					PresentFrame();
+
+					RecordFrame(updateTicks, Timer::GetCurrentTick() - renderStart, lastFrameEnd);
+					updateTicks = 0;
+
+					lastRender += renderStep;
+					fpsCounter++;
 				}
+			}
+
+			// Frames are only drawn after an update, so there is nothing to do until the next one is due.
+			WaitUntil(lastUpdate + updateStep);
+		}
+	}
 
-				// Avoid spiral of death. This also allows us to keep rendering even in a worst-case scenario.
-				if (updateCount >= MAX_CONCURRENT_UPDATES)
-					break;
+	void ApplicationSingleton::PipelinedGameLoop(const std::function<void()>& update, const std::function<void()>& snapshot, const std::function<void()>& draw)
+	{
+		ASSERT(update, "An update function must be provided.");
+		ASSERT(snapshot, "A snapshot function must be provided.");
+		ASSERT(draw, "A draw function must be provided.");
+
+		if (!HasWindow())
+		{
+			Error("Application: Must be initialized and have a window created before a call to PipelinedGameLoop().");
+			return;
+		}
+
+		if (!JobSystem.IsRunning())
+		{
+			JobSystem.Start();
+		}
+
+		// Timing control variables.
+		unsigned fpsCounter = 0;
+		frameClock.Reset();
+		std::int64_t lastUpdate = frameClock.GetFrameTick();
+		std::int64_t lastRender = lastUpdate;
+		std::int64_t lastFpsCapture = lastRender;
+		std::int64_t lastFrameEnd = lastRender;
+		// The time spent updating since the last frame.
+		std::int64_t updateTicks = 0;
+
+		defer { SaveFrameStats(); };
+
+		// Otherwise, on Windows, every sleep between updates would last a whole 15.6ms scheduler tick.
+		const SleepResolutionScope sleepResolution;
+
+		// The simulation time captured by the latest snapshot.
+		std::int64_t snapshotTime = lastUpdate;
+		bool hasNewSnapshot = false;
+
+		while (true)
+		{
+			// Updates our input and Windows OS events.
+			DrainEventQueue();
+			if (!appIsRunning)
+				return;
+
+			std::int64_t currentTime = frameClock.Tick();
+			RecordFPS(currentTime, lastFpsCapture, fpsCounter);
+			Profiler.Collect();
+
+			// The next steps of the simulation run on a worker, while this thread draws the previous snapshot.
+			unsigned updateCount = 0;
+			std::int64_t simulationTicks = 0;
+			JobCounter simulation;
+			if (currentTime - lastUpdate >= updateStep)
+			{
+				JobSystem.Run([&]() {
+					const std::int64_t updateStart = Timer::GetCurrentTick();
+					updateCount = StepSimulation(update, currentTime, lastUpdate);
+					simulationTicks = Timer::GetCurrentTick() - updateStart;
+				}, &simulation);
 			}
 
-			if (updateCount > 0)
+			if (hasNewSnapshot)
 			{
-				// If the frame rate is uncapped or we are due for a new frame, render the latest game-state.
 				if (FPSCap == 0 || (currentTime - lastRender) >= renderStep)
 				{
+					GEM_PROFILE_SCOPE("Application::Draw");
+					const std::int64_t renderStart = Timer::GetCurrentTick();
+					interpolation = GetStepFraction(currentTime - snapshotTime);
 					draw();
-					SwapBuffers(deviceContext);
+					PresentFrame();
+
+					RecordFrame(updateTicks, Timer::GetCurrentTick() - renderStart, lastFrameEnd);
+					updateTicks = 0;
 
 					lastRender += renderStep;
 					fpsCounter++;
+					hasNewSnapshot = false;
 				}
 			}
+
+			// Any main thread work requested by the simulation is run while we wait.
+			JobSystem.Wait(simulation);
+			updateTicks += simulationTicks;
+
+			// The user might have requested to exit during update().
+			if (!appIsRunning)
+				return;
+
+			if (updateCount > 0)
+			{
+				// Neither update() nor draw() are running, so the snapshot can be taken safely.
+				GEM_PROFILE_SCOPE("Application::Snapshot");
+				snapshot();
+				snapshotTime = lastUpdate;
+				hasNewSnapshot = true;
+			}
+
+			// Frames are only drawn after an update, so there is nothing to do until the next one is due.
+			WaitUntil(lastUpdate + updateStep);
 		}
 	}
 
+	void ApplicationSingleton::WindowlessGameLoop(const std::function<void()>& update)
+	{
+		ASSERT(update, "An update function must be provided.");
+		ASSERT(!HasWindow(), "The windowless game-loop cannot drive a game window.");
+
+		if (!JobSystem.IsRunning())
+		{
+			JobSystem.Start();
+		}
+
+		// The step rate is normally computed when the game window is created.
+		SetUpdatesPerSecond(updatesPerSecond);
+		windowless = true;
+
+		// Timing control variables.
+		unsigned fpsCounter = 0;
+		frameClock.Reset();
+		std::int64_t lastUpdate = frameClock.GetFrameTick();
+		std::int64_t lastFpsCapture = lastUpdate;
+		std::int64_t lastFrameEnd = lastUpdate;
+
+		defer { SaveFrameStats(); };
+
+		// Otherwise, on Windows, every sleep between updates would last a whole 15.6ms scheduler tick.
+		const SleepResolutionScope sleepResolution;
+
+		while (appIsRunning)
+		{
+			std::int64_t currentTime = frameClock.Tick();
+			RecordFPS(currentTime, lastFpsCapture, fpsCounter);
+			Profiler.Collect();
+
+			// With nothing to draw, each pass through the loop which updates counts as a frame.
+			const std::int64_t updateStart = Timer::GetCurrentTick();
+			if (StepSimulation(update, currentTime, lastUpdate) > 0)
+			{
+				RecordFrame(Timer::GetCurrentTick() - updateStart, 0, lastFrameEnd);
+				fpsCounter++;
+			}
+
+			if (appIsRunning)
+			{
+				WaitUntil(lastUpdate + updateStep);
+			}
+		}
+
+		windowless = false;
+	}
+
+	unsigned ApplicationSingleton::StepSimulation(const std::function<void()>& update, std::int64_t currentTime, std::int64_t& lastUpdate)
+	{
+		constexpr unsigned MAX_CONCURRENT_UPDATES = 5;
+		unsigned updateCount = 0;
+
+		while (currentTime - lastUpdate >= updateStep)
+		{
+			{
+				GEM_PROFILE_SCOPE("Application::Update");
+				update();
+			}
+
+			// The user might have requested to exit during update().
+			if (!appIsRunning)
+				break;
+
+			lastUpdate += updateStep;
+			updateCount++;
+
+			if (skipToPresent)
+			{
+				lastUpdate = currentTime;
+				skipToPresent = false;
+				break;
+			}
+
+			// Avoid spiral of death. This also allows us to keep rendering even in a worst-case scenario.
+			if (updateCount >= MAX_CONCURRENT_UPDATES)
+				break;
+		}
+
+		return updateCount;
+	}
+
+	void ApplicationSingleton::RecordFPS(std::int64_t currentTime, std::int64_t& lastFpsCapture, unsigned& fpsCounter)
+	{
+		// Record the FPS for the previous second of time.
+		if (currentTime - lastFpsCapture >= Timer::GetTicksPerSecond())
+		{
+			// We don't want to update the timer variable with "+= 1.0" here. After a lag spike this
+			// would cause FPS to suddenly be recorded more often than once a second.
+			lastFpsCapture = currentTime;
+
+			fps = fpsCounter;
+			fpsCounter = 0;
+		}
+	}
+
+	void ApplicationSingleton::RecordFrame(std::int64_t updateTicks, std::int64_t renderTicks, std::int64_t& lastFrameEnd)
+	{
+		const std::int64_t frameEnd = Timer::GetCurrentTick();
+		const double ticksPerMS = static_cast<double>(Timer::GetTicksPerMS());
+
+		FrameTiming frame;
+		frame.updateMS = static_cast<float>(updateTicks / ticksPerMS);
+		frame.renderMS = static_cast<float>(renderTicks / ticksPerMS);
+		frame.totalMS = static_cast<float>((frameEnd - lastFrameEnd) / ticksPerMS);
+		// Updates overlap with rendering in the pipelined game-loop, so this can't simply be subtracted.
+		frame.idleMS = std::max(frame.totalMS - frame.updateMS - frame.renderMS, 0.0f);
+
+		frameStats.AddFrame(frame);
+		lastFrameEnd = frameEnd;
+	}
+
+	void ApplicationSingleton::SaveFrameStats() const
+	{
+		if (!frameStatsFile.empty())
+		{
+			frameStats.Save(frameStatsFile);
+		}
+	}
+
+	void ApplicationSingleton::WaitUntil(std::int64_t tick)
+	{
+		if (Timer::GetCurrentTick() >= tick)
+		{
+			return;
+		}
+
+		switch (idleMode)
+		{
+		case IdleMode::Spin:
+			while (Timer::GetCurrentTick() < tick)
+			{
+				CpuRelax();
+			}
+			break;
+
+		case IdleMode::SleepAndSpin:
+			Timer::SleepUntil(tick);
+			break;
+
+		case IdleMode::Sleep:
+			std::this_thread::sleep_for(std::chrono::nanoseconds(tick - Timer::GetCurrentTick()));
+			break;
+		}
+
+		const std::int64_t lateness = Timer::GetCurrentTick() - tick;
+		frameStats.AddWakeLatency(static_cast<float>(lateness / static_cast<double>(Timer::GetTicksPerMS())));
+	}
+
+	float ApplicationSingleton::GetStepFraction(std::int64_t elapsed) const
+	{
+		return Clamp(static_cast<float>(elapsed) / static_cast<float>(updateStep), 0.0f, 1.0f);
+	}
+
 	void ApplicationSingleton::UpdateEngine()
+	{
+		GEM_PROFILE_SCOPE("Application::UpdateEngine");
+
+		if (JobSystem.IsMainThread())
+		{
+			UpdateEngineOnMainThread();
+		}
+		else
+		{
+			// The pipelined game loop runs update() on a worker. Event listeners, the rendering components and the
+			// SoundSystem all expect the main thread and its contexts, so they are updated once it has finished drawing.
+			JobCounter counter;
+			JobSystem.Run([this]() { UpdateEngineOnMainThread(); }, &counter, JobAffinity::MainThread);
+			JobSystem.Wait(counter);
+		}
+	}
+
+	void ApplicationSingleton::UpdateEngineOnMainThread()
 	{
 		// Distribute all queued events to their listeners.
 		EventQueue.Dispatch();
 
-		// Update engine components.
+		// Run the work handed back to the main thread by background jobs.
+		JobSystem.ProcessMainThreadJobs();
+		ReloadChangedResources();
+		ProcessResourceUploads();
+		EnforceResourceBudgets();
+
+		if (!windowless)
+		{
+			UpdateRenderingComponents();
+
+			// Step the SoundSystem.
+			SoundSystem.Update();
+		}
+	}
+
+	bool ApplicationSingleton::IsWindowless() const
+	{
+		return windowless;
+	}
+
+	void ApplicationSingleton::UpdateRenderingComponents()
+	{
 		for (Entity& entity : With<ParticleUpdaterTag>())
 		{
 			entity.Get<ParticleEmitter>().Update();
@@ -448,9 +784,6 @@ namespace gem
 		{
 			light.Update();
 		}
-
-		// Step the SoundSystem.
-		SoundSystem.Update();
 	}
 
 	void ApplicationSingleton::Exit()
@@ -460,12 +793,16 @@ namespace gem
 
 	void ApplicationSingleton::EnableCursor()
 	{
+#ifdef _WIN32
 		while (ShowCursor(true) <= 0);
+#endif
 	}
 
 	void ApplicationSingleton::DisableCursor()
 	{
+#ifdef _WIN32
 		while (ShowCursor(false) > 0);
+#endif
 	}
 
 	bool ApplicationSingleton::IsFullscreen() const
@@ -485,7 +822,7 @@ namespace gem
 
 	std::string ApplicationSingleton::GetOpenGLVersionString() const
 	{
-		ASSERT(hwnd != NULL, "A game window must be created before calling this function.");
+		ASSERT(HasWindow(), "A game window must be created before calling this function.");
 
 		return reinterpret_cast<const char*>(glGetString(GL_VERSION));
 	}
@@ -510,11 +847,36 @@ namespace gem
 		return 1.0f / updatesPerSecond;
 	}
 
+	float ApplicationSingleton::GetInterpolation() const
+	{
+		return interpolation;
+	}
+
 	unsigned ApplicationSingleton::GetFPS() const
 	{
 		return fps;
 	}
 
+	const FrameClock& ApplicationSingleton::GetFrameClock() const
+	{
+		return frameClock;
+	}
+
+	FrameStats& ApplicationSingleton::GetFrameStats()
+	{
+		return frameStats;
+	}
+
+	const FrameStats& ApplicationSingleton::GetFrameStats() const
+	{
+		return frameStats;
+	}
+
+	void ApplicationSingleton::SetFrameStatsFile(std::string filePath)
+	{
+		frameStatsFile = std::move(filePath);
+	}
+
 	void ApplicationSingleton::SetFPSCap(unsigned _fps)
 	{
 		if (_fps == 0)
@@ -553,6 +915,16 @@ namespace gem
 		return updatesPerSecond;
 	}
 
+	void ApplicationSingleton::SetIdleMode(IdleMode mode)
+	{
+		idleMode = mode;
+	}
+
+	IdleMode ApplicationSingleton::GetIdleMode() const
+	{
+		return idleMode;
+	}
+
 	void ApplicationSingleton::SkipToPresentTime()
 	{
 		skipToPresent = true;
@@ -565,6 +937,7 @@ namespace gem
 
 	bool ApplicationSingleton::SetFullscreen(bool state)
 	{
+#ifdef _WIN32
 		if (hwnd != NULL)
 		{
 			if (state == fullscreen)
@@ -592,6 +965,7 @@ namespace gem
 				return false;
 			}
 		}
+#endif
 
 		fullscreen = state;
 		return true;
@@ -599,6 +973,7 @@ namespace gem
 
 	bool ApplicationSingleton::SetBordered(bool state)
 	{
+#ifdef _WIN32
 		if (hwnd != NULL)
 		{
 			if (state == bordered)
@@ -619,6 +994,7 @@ namespace gem
 				return false;
 			}
 		}
+#endif
 
 		bordered = state;
 		return true;
@@ -626,6 +1002,7 @@ namespace gem
 
 	bool ApplicationSingleton::SetResizable(bool state)
 	{
+#ifdef _WIN32
 		if (hwnd != NULL)
 		{
 			if (state == resizable)
@@ -646,6 +1023,7 @@ namespace gem
 				return false;
 			}
 		}
+#endif
 
 		resizable = state;
 		return true;
@@ -658,6 +1036,7 @@ namespace gem
 
 		bool wasFullscreen = fullscreen;
 
+#ifdef _WIN32
 		if (hwnd != NULL)
 		{
 			if (width == screenViewport.width && height == screenViewport.height)
@@ -676,11 +1055,12 @@ namespace gem
 				return false;
 			}
 		}
+#endif
 
 		screenViewport.width = width;
 		screenViewport.height = height;
 
-		if (hwnd != NULL)
+		if (HasWindow())
 		{
 			if (wasFullscreen && !SetFullscreen(true))
 			{
@@ -695,21 +1075,18 @@ namespace gem
 		: glMajorVersion(3)
 		, glMinorVersion(3)
 		, screenViewport(0, 0, 800, 600)
-		, hwnd(NULL)
-		, apInstance(NULL)
-		, renderContext(NULL)
-		, deviceContext(NULL)
 	{
 	}
 
 	ApplicationSingleton::~ApplicationSingleton()
 	{
-		if (hwnd != NULL)
+		if (HasWindow())
 		{
 			DestroyGameWindow();
 		}
 	}
 
+#ifdef _WIN32
 	LRESULT CALLBACK ApplicationSingleton::WndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 	{
 		switch (uMsg)
@@ -726,7 +1103,7 @@ namespace gem
 				Application.screenViewport.height = height;
 				Application.screenViewport.bind();
 
-				EventQueue.Push(std::make_unique<Resize>(Application.screenViewport.width, Application.screenViewport.height));
+				EventQueue.Emplace<Resize>(Application.screenViewport.width, Application.screenViewport.height);
 			}
 			return 0;
 		}
@@ -849,6 +1226,7 @@ namespace gem
 
 		return DefWindowProc(hWnd, uMsg, wParam, lParam);
 	}
+#endif
 
 	Resize::Resize(unsigned _width, unsigned _height)
 		: width(_width)
@@ -1,14 +1,34 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
 #include "gemcutter/Application/Event.h"
+#include "gemcutter/Application/FrameStats.h"
+#include "gemcutter/Application/Timer.h"
 #include "gemcutter/Rendering/Viewport.h"
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <string>
 #include <string_view>
-#include <Windows.h>
+
+#ifdef _WIN32
+	#include <Windows.h>
+#endif
 
 namespace gem
 {
+	// How the game-loop passes the time while no update is due.
+	enum class IdleMode
+	{
+		// Polls the clock. Wakes up the most precisely, but keeps a core fully busy.
+		Spin,
+		// Sleeps until shortly before the next update, then spins for the rest. The default.
+		SleepAndSpin,
+		// Leaves waking up to the OS. Uses the least CPU time, but might wake up late by up to the OS's timer resolution.
+		// The game loops raise the resolution to 1ms while they run. See SleepResolutionScope.
+		Sleep
+	};
+
 	// Provides an interface to the operating system and the game window.
 	// The class also responsible for scheduling and executing the game-loop.
 	extern class ApplicationSingleton Application;
@@ -24,12 +44,30 @@ namespace gem
 		// Starts the main game-loop.
 		void GameLoop(const std::function<void()>& update, const std::function<void()>& draw);
 
+		// Starts the main game-loop, overlapping the simulation with rendering.
+		// update() runs on a worker thread, while draw() renders a snapshot of the previous update on the main thread.
+		// snapshot() is called on the main thread between the two, when neither is running. It should copy whatever
+		// draw() needs out of the game-state. draw() must only read from the snapshot, and update() must not use the
+		// graphics context directly. Jobs with JobAffinity::MainThread can be used for that instead.
+		// The frames drawn are one update behind the simulation.
+		void PipelinedGameLoop(const std::function<void()>& update, const std::function<void()>& snapshot, const std::function<void()>& draw);
+
+		// Starts the main game-loop without a window or a graphics context, such as for a dedicated server or a benchmark.
+		// update() is scheduled at the same fixed step rate, and the thread sleeps while no update is due.
+		// Like the rest of the engine, this currently only builds for Windows.
+		void WindowlessGameLoop(const std::function<void()>& update);
+
 		// Updates systems provided by the engine.
 		// - Dispatches the event queue.
 		// - Updates all Engine-Side components.
 		// - Steps the Sound System.
+		// In the windowless game-loop, the components and systems which need a graphics context or an audio device are skipped.
+		// This all runs on the main thread. When called from a worker, it waits for the main thread to do the work.
 		void UpdateEngine();
 
+		// Returns true while the windowless game-loop is running.
+		bool IsWindowless() const;
+
 		// Marks the program to close at the start of the next game-loop.
 		void Exit();
 
@@ -50,9 +88,24 @@ namespace gem
 		// This value is constant between frames. It can only change if SetUpdatesPerSecond() is called.
 		float GetDeltaTime() const;
 
+		// Returns how far real time has moved past the most recent update, as a fraction of one update step.
+		// Ranges from 0 to 1. draw() can use this to interpolate between the two most recent game-states.
+		float GetInterpolation() const;
+
 		// The current framerate. Updated once per second.
 		unsigned GetFPS() const;
 
+		// The time at which the game-loop started its current pass. update() and draw() in the same pass see the same time.
+		const FrameClock& GetFrameClock() const;
+
+		// Timings of each frame rendered by the game-loop. In the windowless game-loop, each batch of updates is a frame.
+		// In the pipelined game-loop, the update time overlaps with the render time.
+		FrameStats& GetFrameStats();
+		const FrameStats& GetFrameStats() const;
+
+		// Sets a file to save the frame statistics to when the game-loop exits. Empty by default, which disables saving.
+		void SetFrameStatsFile(std::string filePath);
+
 		// Sets the maximum allowed framerate. 0 sets fps as uncapped.
 		void SetFPSCap(unsigned fps);
 		unsigned GetFPSCap() const;
@@ -60,6 +113,11 @@ namespace gem
 		void SetUpdatesPerSecond(unsigned ups);
 		unsigned GetUpdatesPerSecond() const;
 
+		// Frames are only drawn after an update, so the game-loop is idle until the next update is due.
+		// How late the game-loop wakes up is recorded by the frame statistics.
+		void SetIdleMode(IdleMode mode);
+		IdleMode GetIdleMode() const;
+
 		// If the game's update rate has fallen behind the target updates per second,
 		// this will skip the fast-forwarding effect caused by the update loop catching up to real time.
 		// The lost time is ignored. This should be called at the start of a real-time gameplay segment 
@@ -78,16 +136,47 @@ namespace gem
 		// Processes events from the OS.
 		void DrainEventQueue();
 
+		bool HasWindow() const;
+
+		// Presents the frame which was just drawn to the game window.
+		void PresentFrame();
+
+		// Runs update() until the simulation has caught up to 'currentTime'. Returns the number of updates.
+		unsigned StepSimulation(const std::function<void()>& update, std::int64_t currentTime, std::int64_t& lastUpdate);
+
+		void RecordFPS(std::int64_t currentTime, std::int64_t& lastFpsCapture, unsigned& fpsCounter);
+
+		// Adds a frame, which ends now, to the frame statistics.
+		void RecordFrame(std::int64_t updateTicks, std::int64_t renderTicks, std::int64_t& lastFrameEnd);
+
+		void SaveFrameStats() const;
+
+		// Waits for the given tick according to the idle mode.
+		void WaitUntil(std::int64_t tick);
+
+		// Returns the elapsed time as a fraction of one update step, clamped to [0, 1].
+		float GetStepFraction(std::int64_t elapsed) const;
+
+		// Does the work of UpdateEngine(). Must be called from the main thread.
+		void UpdateEngineOnMainThread();
+
+		void UpdateRenderingComponents();
+
+#ifdef _WIN32
 		static LRESULT CALLBACK WndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+#endif
 
-		bool appIsRunning = true;
+		// Written from update(), which might be running on a worker thread.
+		std::atomic<bool> appIsRunning = true;
 
 		// The target amount of time between updates.
-		__int64 updateStep = 0;
+		std::int64_t updateStep = 0;
 		// The target amount of time between renders.
-		__int64 renderStep = 0;
+		std::int64_t renderStep = 0;
+
+		std::atomic<bool> skipToPresent = false;
 
-		bool skipToPresent = false;
+		bool windowless = false;
 
 		bool fullscreen = false;
 		bool bordered = true;
@@ -97,20 +186,33 @@ namespace gem
 		unsigned glMinorVersion;
 		unsigned updatesPerSecond = 60;
 		unsigned FPSCap = 0;
+		IdleMode idleMode = IdleMode::SleepAndSpin;
 		Viewport screenViewport;
 
 		// The number of frames rendered during the last second.
 		unsigned fps = 0;
 
-		HWND hwnd;
-		HINSTANCE apInstance;
-		HGLRC renderContext;
-		HDC deviceContext;
+		FrameStats frameStats;
+		std::string frameStatsFile;
+
+		float interpolation = 0.0f;
+
+		FrameClock frameClock;
+
+#ifdef _WIN32
+		HWND hwnd = NULL;
+		HINSTANCE apInstance = NULL;
+		HGLRC renderContext = NULL;
+		HDC deviceContext = NULL;
+#endif
 	};
 
 	// An event distributed by the engine when the game window is resized.
+	// Only the final size is distributed if the window is resized multiple times in one frame.
 	struct Resize : public Event<Resize>
 	{
+		static constexpr QueuePolicy queuePolicy = QueuePolicy::Latest;
+
 		Resize(unsigned width, unsigned height);
 
 		// Returns the new aspect ratio of the window, calculated as Width / Height.
@@ -0,0 +1,307 @@
+// Copyright (c) 2022 Emilian Cioca
+#include "BinaryLog.h"
+#include "gemcutter/Utilities/String.h"
+
+#include <atomic>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <unordered_map>
+
+namespace
+{
+	std::atomic<std::uint32_t> nextSiteId = 0;
+
+	// Reads values out of a record's arguments, failing once there aren't enough bytes left.
+	class RecordReader
+	{
+	public:
+		RecordReader(const std::byte* args, unsigned size)
+			: current(args), end(args + size)
+		{
+		}
+
+		template<typename T>
+		bool Read(T& value)
+		{
+			if (static_cast<std::size_t>(end - current) < sizeof(T))
+			{
+				return false;
+			}
+
+			std::memcpy(&value, current, sizeof(T));
+			current += sizeof(T);
+			return true;
+		}
+
+		bool ReadString(std::string& str)
+		{
+			std::uint8_t length = 0;
+			if (!Read(length) || end - current < length)
+			{
+				return false;
+			}
+
+			str.assign(reinterpret_cast<const char*>(current), length);
+			current += length;
+			return true;
+		}
+
+	private:
+		const std::byte* current;
+		const std::byte* end;
+	};
+
+	template<typename T>
+	bool FormatInteger(std::string& result, std::string spec, char conversion, RecordReader& reader)
+	{
+		T value = 0;
+		if (!reader.Read(value))
+		{
+			return false;
+		}
+
+		spec += conversion;
+		if (conversion == 'c')
+		{
+			result += gem::FormatString(spec.c_str(), static_cast<int>(value));
+		}
+		else if constexpr (std::is_signed_v<T>)
+		{
+			spec.insert(spec.size() - 1, "ll");
+			result += gem::FormatString(spec.c_str(), static_cast<long long>(value));
+		}
+		else
+		{
+			spec.insert(spec.size() - 1, "ll");
+			result += gem::FormatString(spec.c_str(), static_cast<unsigned long long>(value));
+		}
+
+		return true;
+	}
+
+	// Formats a single argument with its specifier. The specifier's length modifier is replaced
+	// to match how the argument was stored.
+	bool FormatArg(std::string& result, std::string spec, char conversion, char type, RecordReader& reader)
+	{
+		switch (type)
+		{
+		case 'c': return FormatInteger<char>(result, std::move(spec), conversion, reader);
+		case 'i': return FormatInteger<std::int32_t>(result, std::move(spec), conversion, reader);
+		case 'u': return FormatInteger<std::uint32_t>(result, std::move(spec), conversion, reader);
+		case 'l': return FormatInteger<std::int64_t>(result, std::move(spec), conversion, reader);
+		case 'U': return FormatInteger<std::uint64_t>(result, std::move(spec), conversion, reader);
+		case 'f':
+		{
+			double value = 0.0;
+			if (!reader.Read(value)) return false;
+			spec += conversion;
+			result += gem::FormatString(spec.c_str(), value);
+			return true;
+		}
+		case 'p':
+		{
+			std::uint64_t value = 0;
+			if (!reader.Read(value)) return false;
+			spec += conversion;
+			result += gem::FormatString(spec.c_str(), reinterpret_cast<void*>(static_cast<std::uintptr_t>(value)));
+			return true;
+		}
+		case 's':
+		{
+			std::string value;
+			if (!reader.ReadString(value)) return false;
+			spec += conversion;
+			result += gem::FormatString(spec.c_str(), value.c_str());
+			return true;
+		}
+		default:
+			return false;
+		}
+	}
+
+	template<typename T>
+	bool ReadBinary(std::istream& input, T& value)
+	{
+		return static_cast<bool>(input.read(reinterpret_cast<char*>(&value), sizeof(value)));
+	}
+
+	bool ReadBinary(std::istream& input, std::string& str, std::size_t length)
+	{
+		str.resize(length);
+		return static_cast<bool>(input.read(str.data(), length));
+	}
+}
+
+namespace gem
+{
+	LogSite::LogSite(LogChannel _channel, LogLevel _level, const char* _format, const char* _argTypes)
+		: channel(_channel)
+		, level(_level)
+		, format(_format)
+		, argTypes(_argTypes)
+		, id(nextSiteId++)
+	{
+	}
+
+	std::string FormatLogRecord(const char* format, const char* argTypes, const std::byte* args, unsigned size)
+	{
+		RecordReader reader(args, size);
+		std::string result;
+
+		while (*format != '\0')
+		{
+			const char* percent = std::strchr(format, '%');
+			if (!percent)
+			{
+				result += format;
+				break;
+			}
+
+			result.append(format, percent);
+			format = percent + 1;
+
+			if (*format == '%')
+			{
+				result += '%';
+				++format;
+				continue;
+			}
+
+			std::string spec = "%";
+			for (; detail::IsFormatModifier(*format); ++format)
+			{
+				// Length modifiers are dropped, since the argument's stored type decides them.
+				if (std::strchr("hlLzjt", *format) == nullptr)
+				{
+					spec += *format;
+				}
+			}
+
+			const char conversion = *format;
+			const char type = *argTypes;
+			if (type == '\0' ||
+				!detail::IsFormatCompatible(conversion, type) ||
+				!FormatArg(result, std::move(spec), conversion, type, reader))
+			{
+				result += "<invalid record>";
+				break;
+			}
+
+			++format;
+			++argTypes;
+		}
+
+		return result;
+	}
+
+	bool DecodeBinaryLog(std::istream& input, std::ostream& output)
+	{
+		char signature[sizeof(BINARY_LOG_SIGNATURE)];
+		if (!input.read(signature, sizeof(signature)) ||
+			std::memcmp(signature, BINARY_LOG_SIGNATURE, sizeof(signature)) != 0)
+		{
+			Error("Binary Log: The input is not a binary log, or is from an incompatible version.");
+			return false;
+		}
+
+		auto writeLine = [&output](LogLevel level, LogChannel channel, const std::string& text) {
+			output << GetLogHeader(level);
+			if (channel != LogChannel::General)
+			{
+				output << '[' << GetLogChannelName(channel) << "] ";
+			}
+			output << text << '\n';
+		};
+
+		struct Site
+		{
+			LogLevel level;
+			LogChannel channel;
+			std::string format;
+			std::string argTypes;
+		};
+		std::unordered_map<std::uint32_t, Site> sites;
+
+		BinaryLogEntry entry;
+		while (ReadBinary(input, entry))
+		{
+			switch (entry)
+			{
+			case BinaryLogEntry::Site:
+			{
+				std::uint32_t id = 0;
+				Site site;
+				std::uint16_t formatLength = 0;
+				std::uint8_t numArgs = 0;
+				if (!ReadBinary(input, id) ||
+					!ReadBinary(input, site.level) ||
+					!ReadBinary(input, site.channel) ||
+					!ReadBinary(input, formatLength) ||
+					!ReadBinary(input, site.format, formatLength) ||
+					!ReadBinary(input, numArgs) ||
+					!ReadBinary(input, site.argTypes, numArgs))
+				{
+					Error("Binary Log: The log ends in the middle of an entry.");
+					return false;
+				}
+
+				sites[id] = std::move(site);
+				break;
+			}
+
+			case BinaryLogEntry::Record:
+			{
+				std::uint32_t id = 0;
+				std::uint8_t size = 0;
+				std::byte args[LOG_RECORD_SIZE];
+				if (!ReadBinary(input, id) ||
+					!ReadBinary(input, size) ||
+					size > LOG_RECORD_SIZE ||
+					!input.read(reinterpret_cast<char*>(args), size))
+				{
+					Error("Binary Log: The log ends in the middle of an entry.");
+					return false;
+				}
+
+				auto itr = sites.find(id);
+				if (itr == sites.end())
+				{
+					Error("Binary Log: A record refers to an unknown site (%u).", id);
+					return false;
+				}
+
+				const Site& site = itr->second;
+				writeLine(site.level, site.channel, FormatLogRecord(site.format.c_str(), site.argTypes.c_str(), args, size));
+				break;
+			}
+
+			case BinaryLogEntry::Text:
+			{
+				LogLevel level;
+				LogChannel channel;
+				std::uint32_t length = 0;
+				std::string text;
+				if (!ReadBinary(input, level) ||
+					!ReadBinary(input, channel) ||
+					!ReadBinary(input, length) ||
+					!ReadBinary(input, text, length))
+				{
+					Error("Binary Log: The log ends in the middle of an entry.");
+					return false;
+				}
+
+				writeLine(level, channel, text);
+				break;
+			}
+
+			default:
+				Error("Binary Log: Unknown entry type (%u).", static_cast<unsigned>(entry));
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
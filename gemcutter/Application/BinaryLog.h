@@ -0,0 +1,98 @@
+// Copyright (c) 2022 Emilian Cioca
+#pragma once
+#include "gemcutter/Application/Logging.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+/*
+ Deferred logging, for messages logged often enough that formatting them would be costly.
+
+ GEM_DEBUG(), GEM_LOG(), GEM_WARNING() and GEM_ERROR() only copy their arguments into a compact binary record.
+ The background writer formats the message later, and only if the console or "Log_Output.txt" needs it.
+ GEM_LOG_CHANNEL() logs to a specific channel and level. Messages below the channel's level are skipped
+ before their arguments are even copied, and those below GEM_MIN_LOG_LEVEL are compiled out entirely.
+ The format must be a string literal, and its specifiers are checked against the arguments at compile-time.
+ Width and precision must be written into the format, since '*' is not supported.
+
+ Arguments can be integers, floating-point numbers, enums, characters, pointers, and strings.
+ All arguments must fit in LOG_RECORD_SIZE bytes. Strings are copied, and are truncated if needed to fit.
+
+ The records can also be saved without formatting them, to "Log_Output.bin", with OpenBinaryLog().
+ Messages logged with Log(), Warning(), and Error() are saved there too. The file is decoded to text
+ with DecodeBinaryLog() or the log_decoder tool.
+*/
+
+namespace gem
+{
+	// The most bytes that the arguments of a single deferred message can take up.
+	constexpr unsigned LOG_RECORD_SIZE = 64;
+
+	// A deferred log statement. Created once, the first time the statement runs.
+	struct LogSite
+	{
+		LogSite(LogChannel channel, LogLevel level, const char* format, const char* argTypes);
+
+		const LogChannel channel;
+		const LogLevel level;
+		const char* const format;
+		// A character for each argument, describing how it is stored in a record.
+		const char* const argTypes;
+		// Identifies the statement in a binary log.
+		const std::uint32_t id;
+	};
+
+	// A binary log starts with this signature, followed by a series of entries.
+	// Each entry starts with a BinaryLogEntry, and all values are stored in the machine's byte order.
+	constexpr char BINARY_LOG_SIGNATURE[8] = { 'G', 'E', 'M', 'L', 'O', 'G', '\0', '\2' };
+
+	enum class BinaryLogEntry : std::uint8_t
+	{
+		// u32 site id, u8 level, u8 channel, u16 format length, format, u8 argument count, argument types.
+		// Written before the first record of each site.
+		Site,
+		// u32 site id, u8 size, arguments.
+		Record,
+		// u8 level, u8 channel, u32 length, text.
+		Text
+	};
+
+	void OpenBinaryLog();
+	void CloseBinaryLog();
+
+	// Converts a binary log to text, in the same layout as "Log_Output.txt".
+	bool DecodeBinaryLog(std::istream& input, std::ostream& output);
+
+	// Formats the arguments of a record, as they were stored by LogDeferred().
+	std::string FormatLogRecord(const char* format, const char* argTypes, const std::byte* args, unsigned size);
+
+	// Stores the arguments of the message and queues it for the background writer.
+	// Called by the GEM_LOG() macros.
+	template<typename... Args>
+	void LogDeferred(const LogSite& site, const Args&... args);
+
+	// Queues the stored arguments of a message for the background writer.
+	void PushLogRecord(const LogSite& site, const std::byte* args, unsigned size);
+}
+
+#define GEM_LOG_CHANNEL(channel, level, format, ...) \
+	do {                                                                                                      \
+		using GemLogArgs_ = decltype(gem::detail::DeduceLogArgs(__VA_ARGS__));                                 \
+		static_assert(gem::detail::CheckLogFormat(format, GemLogArgs_::types),                                  \
+			"The format's specifiers don't match the arguments.");                                              \
+		if constexpr ((level) >= gem::MIN_LOG_LEVEL) {                                                          \
+			if (gem::IsLogEnabled((channel), (level))) {                                                        \
+				static const gem::LogSite gemLogSite_((channel), (level), (format), GemLogArgs_::types);       \
+				gem::LogDeferred(gemLogSite_, ##__VA_ARGS__);                                                   \
+			}                                                                                                   \
+		}                                                                                                       \
+	} while (false)
+
+#define GEM_DEBUG(format, ...) GEM_LOG_CHANNEL(gem::LogChannel::General, gem::LogLevel::Debug, format, ##__VA_ARGS__)
+#define GEM_LOG(format, ...) GEM_LOG_CHANNEL(gem::LogChannel::General, gem::LogLevel::Info, format, ##__VA_ARGS__)
+#define GEM_WARNING(format, ...) GEM_LOG_CHANNEL(gem::LogChannel::General, gem::LogLevel::Warning, format, ##__VA_ARGS__)
+#define GEM_ERROR(format, ...) GEM_LOG_CHANNEL(gem::LogChannel::General, gem::LogLevel::Error, format, ##__VA_ARGS__)
+
+#include "BinaryLog.inl"
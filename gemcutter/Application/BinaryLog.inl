@@ -0,0 +1,200 @@
+// Copyright (c) 2022 Emilian Cioca
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace gem
+{
+	namespace detail
+	{
+		// How an argument is stored in a record:
+		// 'c' char, 'i' int32, 'u' uint32, 'l' int64, 'U' uint64, 'f' double, 'p' pointer as uint64,
+		// 's' string as a u8 length followed by its characters.
+		template<typename T>
+		constexpr char LogArgType()
+		{
+			if constexpr (std::is_enum_v<T>)
+			{
+				return LogArgType<std::underlying_type_t<T>>();
+			}
+			else if constexpr (std::is_same_v<T, char>)
+			{
+				return 'c';
+			}
+			else if constexpr (std::is_integral_v<T>)
+			{
+				if constexpr (std::is_signed_v<T>)
+				{
+					return sizeof(T) <= 4 ? 'i' : 'l';
+				}
+				else
+				{
+					return sizeof(T) <= 4 ? 'u' : 'U';
+				}
+			}
+			else if constexpr (std::is_floating_point_v<T>)
+			{
+				return 'f';
+			}
+			else if constexpr (
+				std::is_same_v<T, const char*> || std::is_same_v<T, char*> ||
+				std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>)
+			{
+				return 's';
+			}
+			else if constexpr (std::is_pointer_v<T>)
+			{
+				return 'p';
+			}
+			else
+			{
+				static_assert(sizeof(T) == 0, "This type can't be logged with a deferred format.");
+				return '\0';
+			}
+		}
+
+		// The bytes taken up by an argument. Strings take at least their length.
+		constexpr unsigned LogArgSize(char type)
+		{
+			switch (type)
+			{
+			case 'c': case 's': return 1;
+			case 'i': case 'u': return 4;
+			default: return 8;
+			}
+		}
+
+		template<typename... Args>
+		struct LogArgs
+		{
+			static constexpr char types[] = { LogArgType<std::decay_t<Args>>()..., '\0' };
+			static constexpr unsigned size = (LogArgSize(LogArgType<std::decay_t<Args>>()) + ... + 0);
+		};
+
+		// Only used to name the argument types in an unevaluated context.
+		template<typename... Args>
+		LogArgs<Args...> DeduceLogArgs(const Args&...);
+
+		constexpr bool IsFormatModifier(char c)
+		{
+			return std::string_view("-+ #0123456789.hlLzjt").find(c) != std::string_view::npos;
+		}
+
+		constexpr bool IsFormatCompatible(char conversion, char type)
+		{
+			switch (conversion)
+			{
+			case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+				return type == 'i' || type == 'u' || type == 'l' || type == 'U' || type == 'c';
+			case 'c':
+				return type == 'c' || type == 'i' || type == 'u';
+			case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+				return type == 'f';
+			case 's':
+				return type == 's';
+			case 'p':
+				return type == 'p';
+			default:
+				return false;
+			}
+		}
+
+		// Returns true if each specifier in the format has an argument of a matching type.
+		constexpr bool CheckLogFormat(const char* format, const char* types)
+		{
+			while (*format != '\0')
+			{
+				if (*format++ != '%')
+				{
+					continue;
+				}
+
+				if (*format == '%')
+				{
+					++format;
+					continue;
+				}
+
+				while (IsFormatModifier(*format))
+				{
+					++format;
+				}
+
+				if (*types == '\0' || !IsFormatCompatible(*format, *types))
+				{
+					return false;
+				}
+
+				++format;
+				++types;
+			}
+
+			return *types == '\0';
+		}
+
+		// 'reserved' is the space needed by the arguments stored after this one.
+		template<typename T>
+		void StoreLogArg(std::byte* buffer, unsigned& size, unsigned reserved, const T& arg)
+		{
+			using Type = std::decay_t<T>;
+			constexpr char type = LogArgType<Type>();
+
+			if constexpr (type == 's')
+			{
+				std::string_view str;
+				if constexpr (std::is_pointer_v<Type>)
+				{
+					str = arg ? arg : "(null)";
+				}
+				else
+				{
+					str = arg;
+				}
+
+				// Strings are truncated to the space left in the record, after the remaining arguments.
+				const unsigned length = static_cast<unsigned>(std::min<std::size_t>({ str.size(), LOG_RECORD_SIZE - size - reserved - 1, 255 }));
+				buffer[size++] = static_cast<std::byte>(length);
+				std::memcpy(buffer + size, str.data(), length);
+				size += length;
+			}
+			else
+			{
+				auto store = [&](auto value) {
+					std::memcpy(buffer + size, &value, sizeof(value));
+					size += sizeof(value);
+				};
+
+				if constexpr (type == 'c') store(arg);
+				else if constexpr (type == 'i') store(static_cast<std::int32_t>(arg));
+				else if constexpr (type == 'u') store(static_cast<std::uint32_t>(arg));
+				else if constexpr (type == 'l') store(static_cast<std::int64_t>(arg));
+				else if constexpr (type == 'U') store(static_cast<std::uint64_t>(arg));
+				else if constexpr (type == 'f') store(static_cast<double>(arg));
+				else if constexpr (type == 'p') store(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(arg)));
+			}
+		}
+
+		inline void StoreLogArgs(std::byte*, unsigned&) {}
+
+		// Stores each argument in order. The size of the arguments following each one is known at compile time.
+		template<typename T, typename... Rest>
+		void StoreLogArgs(std::byte* buffer, unsigned& size, const T& arg, const Rest&... rest)
+		{
+			StoreLogArg(buffer, size, LogArgs<Rest...>::size, arg);
+			StoreLogArgs(buffer, size, rest...);
+		}
+	}
+
+	template<typename... Args>
+	void LogDeferred(const LogSite& site, const Args&... args)
+	{
+		static_assert(detail::LogArgs<Args...>::size <= LOG_RECORD_SIZE, "The arguments don't fit in a log record.");
+
+		std::byte buffer[LOG_RECORD_SIZE];
+		unsigned size = 0;
+		detail::StoreLogArgs(buffer, size, args...);
+
+		PushLogRecord(site, buffer, size);
+	}
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2022 Emilian Cioca
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace gem
+{
+	// Keeps frequently written atomics on separate cache lines, so cores don't invalidate each other's copies.
+	constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+	// A fixed-capacity, lock-free FIFO queue for exactly one producer thread and one consumer thread.
+	// Pushing and popping never allocate or block, they simply fail when the queue is full or empty.
+	template<typename T, unsigned Capacity>
+	class SpscRingBuffer
+	{
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+		static_assert(std::is_nothrow_move_constructible_v<T>, "T must be nothrow move-constructible.");
+	public:
+		SpscRingBuffer() = default;
+		SpscRingBuffer(const SpscRingBuffer&) = delete;
+		~SpscRingBuffer();
+
+		SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+		// Producer only. Returns false if the queue is full.
+		template<typename... Args>
+		bool TryPush(Args&&... args);
+
+		// Consumer only. Returns false if the queue is empty.
+		bool TryPop(T& out);
+
+		// The result is only a snapshot, since the other thread might be changing the queue.
+		bool IsEmpty() const;
+
+		static constexpr unsigned GetCapacity() { return Capacity; }
+
+	private:
+		T* Slot(std::size_t index);
+
+		// Owned by the consumer.
+		alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head = 0;
+		// The consumer's last look at 'tail'. Lets it skip reading the producer's cache line until the queue seems empty.
+		std::size_t cachedTail = 0;
+
+		// Owned by the producer.
+		alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail = 0;
+		// The producer's last look at 'head'. Lets it skip reading the consumer's cache line until the queue seems full.
+		std::size_t cachedHead = 0;
+
+		alignas(CACHE_LINE_SIZE) alignas(T) std::byte storage[Capacity * sizeof(T)];
+	};
+
+	// A fixed-capacity, lock-free FIFO queue for any number of producer and consumer threads.
+	// Each slot carries a sequence number which tells the threads whether it is ready to be written
+	// or read, so a push or pop costs a single compare-and-swap when uncontended.
+	template<typename T, unsigned Capacity>
+	class MpmcBoundedQueue
+	{
+		static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two, greater than one.");
+		static_assert(std::is_nothrow_move_constructible_v<T>, "T must be nothrow move-constructible.");
+	public:
+		MpmcBoundedQueue();
+		MpmcBoundedQueue(const MpmcBoundedQueue&) = delete;
+		~MpmcBoundedQueue();
+
+		MpmcBoundedQueue& operator=(const MpmcBoundedQueue&) = delete;
+
+		// Returns false if the queue is full.
+		template<typename... Args>
+		bool TryPush(Args&&... args);
+
+		// Returns false if the queue is empty.
+		bool TryPop(T& out);
+
+		static constexpr unsigned GetCapacity() { return Capacity; }
+
+	private:
+		struct Cell
+		{
+			std::atomic<std::size_t> sequence;
+			alignas(T) std::byte storage[sizeof(T)];
+		};
+
+		alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> enqueuePos = 0;
+		alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> dequeuePos = 0;
+		alignas(CACHE_LINE_SIZE) Cell cells[Capacity];
+	};
+}
+
+#include "ConcurrentQueue.inl"
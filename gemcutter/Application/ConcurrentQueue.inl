@@ -0,0 +1,166 @@
+// Copyright (c) 2022 Emilian Cioca
+#include <utility>
+
+namespace gem
+{
+	template<typename T, unsigned Capacity>
+	SpscRingBuffer<T, Capacity>::~SpscRingBuffer()
+	{
+		const std::size_t end = tail.load(std::memory_order_relaxed);
+		for (std::size_t i = head.load(std::memory_order_relaxed); i != end; ++i)
+		{
+			std::destroy_at(Slot(i));
+		}
+	}
+
+	template<typename T, unsigned Capacity>
+	template<typename... Args>
+	bool SpscRingBuffer<T, Capacity>::TryPush(Args&&... args)
+	{
+		const std::size_t currentTail = tail.load(std::memory_order_relaxed);
+		if (currentTail - cachedHead == Capacity)
+		{
+			cachedHead = head.load(std::memory_order_acquire);
+			if (currentTail - cachedHead == Capacity)
+			{
+				return false;
+			}
+		}
+
+		new (Slot(currentTail)) T(std::forward<Args>(args)...);
+		tail.store(currentTail + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	template<typename T, unsigned Capacity>
+	bool SpscRingBuffer<T, Capacity>::TryPop(T& out)
+	{
+		const std::size_t currentHead = head.load(std::memory_order_relaxed);
+		if (currentHead == cachedTail)
+		{
+			cachedTail = tail.load(std::memory_order_acquire);
+			if (currentHead == cachedTail)
+			{
+				return false;
+			}
+		}
+
+		T* item = Slot(currentHead);
+		out = std::move(*item);
+		std::destroy_at(item);
+		head.store(currentHead + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	template<typename T, unsigned Capacity>
+	bool SpscRingBuffer<T, Capacity>::IsEmpty() const
+	{
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+
+	template<typename T, unsigned Capacity>
+	T* SpscRingBuffer<T, Capacity>::Slot(std::size_t index)
+	{
+		return std::launder(reinterpret_cast<T*>(storage + (index & (Capacity - 1)) * sizeof(T)));
+	}
+
+	template<typename T, unsigned Capacity>
+	MpmcBoundedQueue<T, Capacity>::MpmcBoundedQueue()
+	{
+		for (std::size_t i = 0; i < Capacity; ++i)
+		{
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	template<typename T, unsigned Capacity>
+	MpmcBoundedQueue<T, Capacity>::~MpmcBoundedQueue()
+	{
+		const std::size_t end = enqueuePos.load(std::memory_order_relaxed);
+		for (std::size_t pos = dequeuePos.load(std::memory_order_relaxed); pos != end; ++pos)
+		{
+			std::destroy_at(std::launder(reinterpret_cast<T*>(cells[pos & (Capacity - 1)].storage)));
+		}
+	}
+
+	template<typename T, unsigned Capacity>
+	template<typename... Args>
+	bool MpmcBoundedQueue<T, Capacity>::TryPush(Args&&... args)
+	{
+		Cell* cell;
+		std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+		while (true)
+		{
+			cell = &cells[pos & (Capacity - 1)];
+			const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+			if (diff == 0)
+			{
+				// The cell is free for this position. Claim it.
+				if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (diff < 0)
+			{
+				// The cell still holds the item from the previous lap, so the queue is full.
+				return false;
+			}
+			else
+			{
+				// Another producer claimed this position first.
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		new (cell->storage) T(std::forward<Args>(args)...);
+		cell->sequence.store(pos + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	template<typename T, unsigned Capacity>
+	bool MpmcBoundedQueue<T, Capacity>::TryPop(T& out)
+	{
+		Cell* cell;
+		std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+		while (true)
+		{
+			cell = &cells[pos & (Capacity - 1)];
+			const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+
+			if (diff == 0)
+			{
+				// The cell has been written for this position. Claim it.
+				if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (diff < 0)
+			{
+				// The cell hasn't been written yet, so the queue is empty.
+				return false;
+			}
+			else
+			{
+				// Another consumer claimed this position first.
+				pos = dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		T* item = std::launder(reinterpret_cast<T*>(cell->storage));
+		out = std::move(*item);
+		std::destroy_at(item);
+
+		// Mark the cell as free for the producers' next lap.
+		cell->sequence.store(pos + Capacity, std::memory_order_release);
+
+		return true;
+	}
+}
@@ -1,23 +1,106 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Event.h"
-
-#ifdef _DEBUG
 #include "gemcutter/Application/Logging.h"
-#endif
+#include "gemcutter/Application/Profiler.h"
 
 namespace gem
 {
 	EventQueueSingleton EventQueue;
 
+	namespace detail
+	{
+		EventBufferBase::EventBufferBase(int _priority)
+			: priority(_priority)
+		{
+		}
+	}
+
+	EventBatch::EventBatch(EventBatch&& other)
+		: newest(other.newest)
+		, oldest(other.oldest)
+	{
+		other.newest = nullptr;
+		other.oldest = nullptr;
+	}
+
+	EventBatch::~EventBatch()
+	{
+		Clear();
+	}
+
+	EventBatch& EventBatch::operator=(EventBatch&& other)
+	{
+		Clear();
+
+		newest = other.newest;
+		oldest = other.oldest;
+		other.newest = nullptr;
+		other.oldest = nullptr;
+
+		return *this;
+	}
+
+	void EventBatch::Push(std::unique_ptr<EventBase> e)
+	{
+		ASSERT(e, "Cannot push a null event.");
+
+		EventBase* ptr = e.release();
+		ptr->nextQueued = newest;
+		newest = ptr;
+
+		if (oldest == nullptr)
+		{
+			oldest = ptr;
+		}
+	}
+
+	void EventBatch::Clear()
+	{
+		while (newest != nullptr)
+		{
+			std::unique_ptr<EventBase> e(newest);
+			newest = newest->nextQueued;
+		}
+
+		oldest = nullptr;
+	}
+
+	bool EventBatch::IsEmpty() const
+	{
+		return newest == nullptr;
+	}
+
+	EventQueueSingleton::~EventQueueSingleton()
+	{
+		EventBase* e = pending.exchange(nullptr, std::memory_order_acquire);
+		while (e != nullptr)
+		{
+			std::unique_ptr<EventBase> ptr(e);
+			e = e->nextQueued;
+		}
+	}
+
 	void EventQueueSingleton::Push(std::unique_ptr<EventBase> e)
 	{
-#ifdef _DEBUG
-		ASSERT(!inDispatch,
-			"It is dangerous to add a new event to the queue while currently inside a global Dispatch().\n"
-			"Consider using Dispatch(const EventBase&) instead.");
-#endif
+		ASSERT(e, "Cannot push a null event.");
+
+		EventBase* ptr = e.release();
+		ptr->nextQueued = pending.load(std::memory_order_relaxed);
+		while (!pending.compare_exchange_weak(ptr->nextQueued, ptr, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	void EventQueueSingleton::Push(EventBatch& batch)
+	{
+		if (batch.IsEmpty())
+		{
+			return;
+		}
 
-		eventQueue.push(std::move(e));
+		batch.oldest->nextQueued = pending.load(std::memory_order_relaxed);
+		while (!pending.compare_exchange_weak(batch.oldest->nextQueued, batch.newest, std::memory_order_release, std::memory_order_relaxed));
+
+		batch.newest = nullptr;
+		batch.oldest = nullptr;
 	}
 
 	void EventQueueSingleton::Dispatch(const EventBase& e) const
@@ -27,20 +110,85 @@ namespace gem
 
 	void EventQueueSingleton::Dispatch()
 	{
-#ifdef _DEBUG
-		// Events should not be posted during this call.
-		inDispatch = true;
-#endif
+		GEM_PROFILE_SCOPE("EventQueue::Dispatch");
+
+		// Take ownership of everything posted so far. Anything posted from now on waits for the next call.
+		EventBase* e = pending.exchange(nullptr, std::memory_order_acquire);
+		detail::EventBufferBase* buffer = activeBuffers.exchange(nullptr, std::memory_order_acquire);
 
-		while (!eventQueue.empty())
+		// The emplaced events are raised in batches, one type at a time.
+		detail::EventBufferBase* oldestBuffer = nullptr;
+		while (buffer != nullptr)
 		{
-			eventQueue.front()->Raise();
-			eventQueue.pop();
+			detail::EventBufferBase* next = buffer->nextActive;
+			buffer->nextActive = oldestBuffer;
+			oldestBuffer = buffer;
+			buffer = next;
 		}
 
-#ifdef _DEBUG
-		// Events can be posted again.
-		inDispatch = false;
-#endif
+		// Stable insertion sort by priority. There is only ever a handful of active event types.
+		detail::EventBufferBase* sorted = nullptr;
+		while (oldestBuffer != nullptr)
+		{
+			detail::EventBufferBase* current = oldestBuffer;
+			oldestBuffer = oldestBuffer->nextActive;
+
+			detail::EventBufferBase** link = &sorted;
+			while (*link != nullptr && (*link)->priority >= current->priority)
+			{
+				link = &(*link)->nextActive;
+			}
+
+			current->nextActive = *link;
+			*link = current;
+		}
+
+		// Every buffer's events are taken before any event is raised, so that events emplaced by listeners wait for the next call.
+		// A buffer can be activated again as soon as its events are taken, which reuses its link, so the order is kept separately.
+		// The list is borrowed rather than used in place, in case a listener calls Dispatch() again.
+		std::vector<detail::EventBufferBase*> buffers;
+		buffers.swap(raisingBuffers);
+		buffers.clear();
+		while (sorted != nullptr)
+		{
+			buffers.push_back(sorted);
+			sorted = sorted->nextActive;
+		}
+
+		for (detail::EventBufferBase* current : buffers)
+		{
+			current->TakePending();
+		}
+
+		// The events were linked newest-first, so we reverse the list to raise them in order.
+		EventBase* oldest = nullptr;
+		while (e != nullptr)
+		{
+			EventBase* next = e->nextQueued;
+			e->nextQueued = oldest;
+			oldest = e;
+			e = next;
+		}
+
+		while (oldest != nullptr)
+		{
+			std::unique_ptr<EventBase> ptr(oldest);
+			oldest = oldest->nextQueued;
+
+			ptr->Raise();
+		}
+
+		for (detail::EventBufferBase* current : buffers)
+		{
+			current->RaiseAll();
+		}
+
+		raisingBuffers.swap(buffers);
+	}
+
+	void EventQueueSingleton::Activate(detail::EventBufferBase& buffer)
+	{
+		buffer.nextActive = activeBuffers.load(std::memory_order_relaxed);
+		while (!activeBuffers.compare_exchange_weak(buffer.nextActive, &buffer, std::memory_order_release, std::memory_order_relaxed));
 	}
 }
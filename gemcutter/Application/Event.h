@@ -1,15 +1,85 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
+#include "gemcutter/Application/Lock.h"
+#include "gemcutter/Application/Logging.h"
+
+#include <atomic>
 #include <functional>
 #include <memory>
-#include <queue>
+#include <mutex>
 #include <vector>
 
 namespace gem
 {
+	class EventQueueSingleton;
+	template<class derived> class Event;
+
+	// Controls how multiple events of the same type are kept by EventQueue.Emplace() within one frame.
+	enum class QueuePolicy
+	{
+		// Every event is raised.
+		All,
+		// Only the most recent event is raised.
+		Latest,
+		// Events are combined into a single one by the event's static Accumulate() function:
+		//	static derived Accumulate(const derived& previous, const derived& next);
+		Accumulate
+	};
+
+	namespace detail
+	{
+		// Storage for queued events of a single type. See EventQueueSingleton::Emplace().
+		class EventBufferBase
+		{
+			friend class gem::EventQueueSingleton;
+		public:
+			EventBufferBase(int priority);
+			virtual ~EventBufferBase() = default;
+
+		protected:
+			// Takes all events queued before the call. Events queued from now on are kept for the next dispatch.
+			virtual void TakePending() = 0;
+			// Raises the events taken by TakePending(), then destroys them.
+			virtual void RaiseAll() = 0;
+
+			// Guards the list of pending events, and the 'isActive' flag. Only ever held for a few instructions.
+			SpinLock lock;
+			// Whether or not the buffer is linked into the EventQueue's list of buffers to raise.
+			bool isActive = false;
+
+		private:
+			// Buffers with a higher priority are raised first.
+			const int priority;
+			// Links the buffer to the next one in the EventQueue while it is active.
+			EventBufferBase* nextActive = nullptr;
+		};
+
+		// Events are stored by value. The storage is kept from frame to frame, so once
+		// it has grown to fit the busiest frame, queuing an event no longer allocates.
+		template<class EventObj>
+		class EventBuffer final : public EventBufferBase
+		{
+		public:
+			EventBuffer();
+
+			// Constructs a new event in place. Returns true if the buffer has just become active.
+			template<typename... Args>
+			bool Emplace(Args&&... params);
+
+		private:
+			void TakePending() override;
+			void RaiseAll() override;
+
+			std::vector<EventObj> pending;
+			// Swapped with 'pending' while raising, so events can still be queued from listeners.
+			std::vector<EventObj> raising;
+		};
+	}
+
 	// The base class for event objects.
 	class EventBase
 	{
+		friend class EventBatch;
 		friend class EventQueueSingleton;
 	public:
 		virtual ~EventBase() = default;
@@ -19,6 +89,9 @@ namespace gem
 	private:
 		// Notifies all listeners of the derived class event by invoking their callback functions.
 		virtual void Raise() const = 0;
+
+		// Links the event to the next one while it is waiting in a queue.
+		EventBase* nextQueued = nullptr;
 	};
 
 	// Invokes a callback function when an instance of the respective event is dispatched.
@@ -35,32 +108,54 @@ namespace gem
 		// Subscribes to the event.
 		Listener();
 		Listener(std::function<EventFunc> callback);
+		Listener(const Listener&) = delete;
 
 		// Unsubscribes from the event.
 		~Listener();
 
+		Listener& operator=(const Listener&) = delete;
 		Listener& operator=(std::function<EventFunc> callback);
 
 	private:
 		std::function<EventFunc> func;
+
+		// The index of this listener in the event's list of listeners.
+		unsigned slot = 0;
 	};
 
 	// You can inherit from this class to create your own custom events.
 	// The template parameter must be the derived class. For example:
 	//	class PlayerDeath : public Event<PlayerDeath> {};
+	//
+	// The way EventQueue.Emplace() queues the event can be tuned by redeclaring
+	// any of the static policy members below in the derived class. For example:
+	//	struct CursorMoved : public Event<CursorMoved> {
+	//		static constexpr QueuePolicy queuePolicy = QueuePolicy::Latest;
+	//		static constexpr bool dropWithoutListeners = true;
+	//	};
 	template<class derived>
 	class Event : public EventBase
 	{
 		friend Listener<derived>;
+		friend detail::EventBuffer<derived>;
+		friend class EventQueueSingleton;
 	public:
 		virtual ~Event() = default;
 
+		// How multiple events of this type are kept within one frame.
+		static constexpr QueuePolicy queuePolicy = QueuePolicy::All;
+		// Event types with a higher priority are raised first.
+		static constexpr int queuePriority = 0;
+		// If true, events are discarded immediately if there are no listeners when they are queued.
+		static constexpr bool dropWithoutListeners = false;
+
 		// Returns true if at least one listener responds to this event.
 		bool HasListeners() const final override;
 		static bool HasListenersStatic();
 
 		// Returns a vector of all objects currently listening for this type of event.
-		static const auto& GetListenersStatic() { return listeners; }
+		// If called from a listener while the event is being raised, the vector might contain null entries.
+		static const std::vector<Listener<derived>*>& GetListenersStatic();
 
 	private:
 		void Raise() const final override;
@@ -68,36 +163,103 @@ namespace gem
 		// Subscribes a listener to be notified from this type of event.
 		static void Subscribe(Listener<derived>& listener);
 		// Stops a listener from being notified callbacks from this type of event.
+		// This is O(1), and it is safe to do so while the event is being raised.
 		static void Unsubscribe(Listener<derived>& listener);
 
-		// All Listeners of the derived class event.
+		// Removes the null entries left behind by unsubscribed listeners.
+		// Must not be called while the event is being raised.
+		static void Compact();
+
+		// All Listeners of the derived class event, in the order they subscribed.
+		// Unsubscribed listeners leave a null entry behind until the list is compacted.
 		static std::vector<Listener<derived>*> listeners;
+		// The number of null entries in 'listeners'.
+		static unsigned numTombstones;
+		// The number of nested calls to Raise() currently executing.
+		static unsigned raiseDepth;
+		// The number of subscribed listeners, which can be safely read by any thread.
+		static std::atomic<unsigned> numListeners;
+
+		// Events of the derived class queued with EventQueue.Emplace().
+		static detail::EventBuffer<derived> buffer;
+	};
+
+	// A list of events staged by a single thread. It is not thread-safe on its own, but the whole
+	// batch can be handed to the EventQueue at once, making it cheap to post many events from a worker.
+	class EventBatch
+	{
+		friend class EventQueueSingleton;
+	public:
+		EventBatch() = default;
+		EventBatch(const EventBatch&) = delete;
+		EventBatch(EventBatch&&);
+		~EventBatch();
+
+		EventBatch& operator=(const EventBatch&) = delete;
+		EventBatch& operator=(EventBatch&&);
+
+		// Adds an event to the end of the batch.
+		void Push(std::unique_ptr<EventBase> e);
+
+		// Deletes all events in the batch without raising them.
+		void Clear();
+
+		bool IsEmpty() const;
+
+	private:
+		// Events are linked from newest to oldest so the whole batch can be spliced onto the queue.
+		EventBase* newest = nullptr;
+		EventBase* oldest = nullptr;
 	};
 
 	// This singleton class handles queuing and distribution of events.
+	// Events can be posted from any thread, but listeners are only ever notified
+	// on the thread which calls Dispatch(), which should be the main thread.
 	extern class EventQueueSingleton EventQueue;
 	class EventQueueSingleton
 	{
 	public:
-		// Add a new event to the queue.
+		EventQueueSingleton() = default;
+		EventQueueSingleton(const EventQueueSingleton&) = delete;
+		~EventQueueSingleton();
+
+		EventQueueSingleton& operator=(const EventQueueSingleton&) = delete;
+
+		// Add a new event to the queue. Safe to call from any thread.
 		// The event will be distributed to all listeners of its type when Dispatch() is called.
 		void Push(std::unique_ptr<EventBase> e);
 
+		// Moves all events from the batch to the end of the queue at once. Safe to call from any thread.
+		// Events from the same batch are raised in the order they were added to it.
+		void Push(EventBatch& batch);
+
+		// Constructs a new event directly in the queue. Safe to call from any thread.
+		// This avoids the per-event heap allocation of Push(), and is best suited to high-frequency events.
+		// Emplaced events are kept by type and all events of one type are raised together in the order
+		// they were emplaced. Types are raised after any events from Push(), by descending queuePriority,
+		// then in the order they first appear. See the policy members of Event<> to coalesce or drop events.
+		template<class EventObj, typename... Args>
+		void Emplace(Args&&... params);
+
 		// Instantly distributes an event across listeners. It is not added to the queue.
 		void Dispatch(const EventBase& e) const;
 
 		// Sequences through the queue of events and distributes them to all the listeners.
-		// There will be no events in the queue when this function returns.
-		// It is illegal, and unsafe, to post new events while this function is executing.
+		// Events posted while this function is executing, either by a listener or by another thread,
+		// are kept for the next call. This means an event raised in response to another is always
+		// delayed to the next frame, and a listener re-posting its own event cannot stall the dispatch.
 		void Dispatch();
 
 	private:
-		std::queue<std::unique_ptr<EventBase>> eventQueue;
+		// Adds a buffer to the list of buffers which have events to be raised.
+		void Activate(detail::EventBufferBase& buffer);
 
-#ifdef _DEBUG
-		// Stops events from being queued during a call to Dispatch().
-		bool inDispatch = false;
-#endif
+		// Events which have not been dispatched yet, linked from newest to oldest.
+		std::atomic<EventBase*> pending = nullptr;
+		// Buffers of emplaced events which have not been dispatched yet, linked from newest to oldest.
+		std::atomic<detail::EventBufferBase*> activeBuffers = nullptr;
+		// Storage for the list of buffers raised by Dispatch(). Kept from frame to frame to avoid allocating.
+		std::vector<detail::EventBufferBase*> raisingBuffers;
 	};
 }
 
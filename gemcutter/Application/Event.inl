@@ -2,6 +2,73 @@
 namespace gem
 {
 	template<class derived> std::vector<Listener<derived>*> Event<derived>::listeners;
+	template<class derived> unsigned Event<derived>::numTombstones = 0;
+	template<class derived> unsigned Event<derived>::raiseDepth = 0;
+	template<class derived> std::atomic<unsigned> Event<derived>::numListeners = 0;
+	template<class derived> detail::EventBuffer<derived> Event<derived>::buffer;
+
+	namespace detail
+	{
+		template<class EventObj>
+		EventBuffer<EventObj>::EventBuffer()
+			: EventBufferBase(EventObj::queuePriority)
+		{
+		}
+
+		template<class EventObj>
+		template<typename... Args>
+		bool EventBuffer<EventObj>::Emplace(Args&&... params)
+		{
+			constexpr QueuePolicy policy = EventObj::queuePolicy;
+
+			std::lock_guard guard(lock);
+
+			if (policy == QueuePolicy::All || pending.empty())
+			{
+				pending.emplace_back(std::forward<Args>(params)...);
+			}
+			else if constexpr (policy == QueuePolicy::Latest)
+			{
+				EventObj& latest = pending.back();
+				std::destroy_at(&latest);
+				std::construct_at(&latest, std::forward<Args>(params)...);
+			}
+			else if constexpr (policy == QueuePolicy::Accumulate)
+			{
+				EventObj& previous = pending.back();
+				EventObj combined = EventObj::Accumulate(previous, EventObj(std::forward<Args>(params)...));
+				std::destroy_at(&previous);
+				std::construct_at(&previous, std::move(combined));
+			}
+
+			const bool wasActive = isActive;
+			isActive = true;
+
+			return !wasActive;
+		}
+
+		template<class EventObj>
+		void EventBuffer<EventObj>::TakePending()
+		{
+			std::lock_guard guard(lock);
+
+			// Anything emplaced from now on will re-activate the buffer for the next dispatch.
+			pending.swap(raising);
+			isActive = false;
+		}
+
+		template<class EventObj>
+		void EventBuffer<EventObj>::RaiseAll()
+		{
+			for (const EventObj& e : raising)
+			{
+				e.Raise();
+			}
+
+			// The capacity is kept for future frames.
+			raising.clear();
+		}
+	}
 
 	template<class EventObj>
 	Listener<EventObj>::Listener()
@@ -38,30 +105,104 @@ namespace gem
 	template<class derived>
 	bool Event<derived>::HasListenersStatic()
 	{
-		return !listeners.empty();
+		return numListeners.load(std::memory_order_relaxed) != 0;
+	}
+
+	template<class derived>
+	const std::vector<Listener<derived>*>& Event<derived>::GetListenersStatic()
+	{
+		if (numTombstones > 0 && raiseDepth == 0)
+		{
+			Compact();
+		}
+
+		return listeners;
 	}
 
 	template<class derived>
 	void Event<derived>::Raise() const
 	{
+		// Listeners which unsubscribed since the last time the event was raised are cleaned up in one pass.
+		if (numTombstones > 0 && raiseDepth == 0)
+		{
+			Compact();
+		}
+
+		raiseDepth++;
+
+		// Listeners can be added or removed by the callbacks, so we can't use iterators here.
 		for (unsigned i = 0; i < listeners.size(); ++i)
 		{
-			if (listeners[i]->func)
+			Listener<derived>* listener = listeners[i];
+			if (listener && listener->func)
 			{
-				listeners[i]->func(*static_cast<const derived*>(this));
+				listener->func(*static_cast<const derived*>(this));
 			}
 		}
+
+		raiseDepth--;
 	}
 
 	template<class derived>
 	void Event<derived>::Subscribe(Listener<derived>& listener)
 	{
+		// Don't let the list grow unbounded if listeners come and go without the event being raised.
+		if (numTombstones > listeners.size() / 2 && raiseDepth == 0)
+		{
+			Compact();
+		}
+
+		listener.slot = listeners.size();
 		listeners.push_back(&listener);
+		numListeners.fetch_add(1, std::memory_order_relaxed);
 	}
 
 	template<class derived>
 	void Event<derived>::Unsubscribe(Listener<derived>& listener)
 	{
-		listeners.erase(std::find(listeners.begin(), listeners.end(), &listener));
+		ASSERT(listeners[listener.slot] == &listener, "Listener is not subscribed to the event.");
+
+		listeners[listener.slot] = nullptr;
+		numTombstones++;
+		numListeners.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	template<class derived>
+	void Event<derived>::Compact()
+	{
+		ASSERT(raiseDepth == 0, "Cannot compact listeners while the event is being raised.");
+
+		unsigned count = 0;
+		for (Listener<derived>* listener : listeners)
+		{
+			if (listener)
+			{
+				listener->slot = count;
+				listeners[count++] = listener;
+			}
+		}
+
+		listeners.resize(count);
+		numTombstones = 0;
+	}
+
+	template<class EventObj, typename... Args>
+	void EventQueueSingleton::Emplace(Args&&... params)
+	{
+		static_assert(std::is_base_of_v<Event<EventObj>, EventObj>, "Template argument must inherit from Event.");
+
+		if constexpr (EventObj::dropWithoutListeners)
+		{
+			if (!EventObj::HasListenersStatic())
+			{
+				return;
+			}
+		}
+
+		auto& buffer = Event<EventObj>::buffer;
+		if (buffer.Emplace(std::forward<Args>(params)...))
+		{
+			Activate(buffer);
+		}
 	}
 }
@@ -1,12 +1,22 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "FileSystem.h"
 #include "gemcutter/Application/Logging.h"
+#include "gemcutter/Utilities/ScopeGuard.h"
 
+#include <charconv>
 #include <dirent/dirent.h>
 #include <direct.h>
-#include <sstream>
 #include <stack>
 
+#ifdef _WIN32
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
 #define SUCCESS 0
 
 // Resolve name conflict with our functions.
@@ -16,6 +26,11 @@
 namespace
 {
 	std::stack<std::string> currentDirectoryStack;
+
+	bool IsWhitespace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
 }
 
 namespace gem
@@ -270,13 +285,170 @@ namespace gem
 			return false;
 		}
 
-		std::ostringstream contents;
-		contents << inStream.rdbuf();
-		output = contents.str();
+		inStream.seekg(0, std::ifstream::end);
+		const std::streamoff size = inStream.tellg();
+		inStream.seekg(0, std::ifstream::beg);
+		if (size < 0)
+		{
+			return false;
+		}
+
+		// Read straight into the output, without an intermediate copy.
+		output.resize(static_cast<std::size_t>(size));
+		inStream.read(output.data(), size);
+
+		// Line endings might have been converted while reading, shortening the text.
+		output.resize(static_cast<std::size_t>(inStream.gcount()));
 
 		return true;
 	}
 
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+		: data(other.data)
+		, size(other.size)
+		, isOpen(other.isOpen)
+	{
+		other.data = nullptr;
+		other.size = 0;
+		other.isOpen = false;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+
+			data = other.data;
+			size = other.size;
+			isOpen = other.isOpen;
+
+			other.data = nullptr;
+			other.size = 0;
+			other.isOpen = false;
+		}
+
+		return *this;
+	}
+
+	bool MappedFile::Open(std::string_view filePath)
+	{
+		ASSERT(!isOpen, "MappedFile: Already associated with a file.");
+
+		// The mapped view keeps the file alive, so the handles can be closed as soon as it is created.
+#ifdef _WIN32
+		HANDLE fileHandle = CreateFileA(filePath.data(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		defer{ CloseHandle(fileHandle); };
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize) ||
+			static_cast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX)
+		{
+			Error("MappedFile: ( %s )\nThe file is too large to be mapped.", filePath.data());
+			return false;
+		}
+
+		if (fileSize.QuadPart > 0)
+		{
+			HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mappingHandle == NULL)
+			{
+				Error("MappedFile: ( %s )\nCould not map the file.", filePath.data());
+				return false;
+			}
+			defer{ CloseHandle(mappingHandle); };
+
+			void* view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+			if (view == nullptr)
+			{
+				Error("MappedFile: ( %s )\nCould not map the file.", filePath.data());
+				return false;
+			}
+
+			data = static_cast<const char*>(view);
+			size = static_cast<std::size_t>(fileSize.QuadPart);
+		}
+#else
+		const int fileDescriptor = open(filePath.data(), O_RDONLY);
+		if (fileDescriptor == -1)
+		{
+			return false;
+		}
+		defer{ close(fileDescriptor); };
+
+		struct stat fileStats;
+		if (fstat(fileDescriptor, &fileStats) != 0)
+		{
+			return false;
+		}
+
+		if (fileStats.st_size > 0)
+		{
+			void* view = mmap(nullptr, static_cast<std::size_t>(fileStats.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+			if (view == MAP_FAILED)
+			{
+				Error("MappedFile: ( %s )\nCould not map the file.", filePath.data());
+				return false;
+			}
+
+			// Files are usually parsed from start to end, so the OS can read ahead.
+			madvise(view, static_cast<std::size_t>(fileStats.st_size), MADV_SEQUENTIAL);
+
+			data = static_cast<const char*>(view);
+			size = static_cast<std::size_t>(fileStats.st_size);
+		}
+#endif
+
+		isOpen = true;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (data)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(data);
+#else
+			munmap(const_cast<char*>(data), size);
+#endif
+		}
+
+		data = nullptr;
+		size = 0;
+		isOpen = false;
+	}
+
+	bool MappedFile::IsOpen() const
+	{
+		return isOpen;
+	}
+
+	std::string_view MappedFile::GetView() const
+	{
+		return std::string_view(data, size);
+	}
+
+	const char* MappedFile::GetData() const
+	{
+		return data;
+	}
+
+	std::size_t MappedFile::GetSize() const
+	{
+		return size;
+	}
+
 	FileReader::~FileReader()
 	{
 		Close();
@@ -284,14 +456,39 @@ namespace gem
 
 	bool FileReader::operator!() const
 	{
-		return !file.is_open() && buffer.empty();
+		return mode == Mode::Closed;
 	}
 
 	bool FileReader::OpenAsBuffer(std::string_view filePath)
 	{
 		ASSERT(!(*this), "FileReader: Already associated with a file.");
 
-		return LoadFileAsString(filePath, buffer);
+		if (!LoadFileAsString(filePath, buffer))
+		{
+			return false;
+		}
+
+		contents = buffer;
+		length = static_cast<unsigned>(buffer.size());
+		mode = Mode::Buffer;
+
+		return true;
+	}
+
+	bool FileReader::OpenAsMapped(std::string_view filePath)
+	{
+		ASSERT(!(*this), "FileReader: Already associated with a file.");
+
+		if (!mapping.Open(filePath))
+		{
+			return false;
+		}
+
+		contents = mapping.GetView();
+		length = static_cast<unsigned>(contents.size());
+		mode = Mode::Mapped;
+
+		return true;
 	}
 
 	bool FileReader::OpenAsStream(std::string_view filePath)
@@ -309,15 +506,21 @@ namespace gem
 		length = static_cast<unsigned>(file.tellg());
 		file.seekg(0, std::ifstream::beg);
 
+		mode = Mode::Stream;
+
 		return true;
 	}
 
 	void FileReader::Close()
 	{
 		buffer.clear();
+		mapping.Close();
+		contents = {};
 		currentPos = 0;
+		length = 0;
+		mode = Mode::Closed;
 
-		if (file.good())
+		if (file.is_open())
 		{
 			file.close();
 		}
@@ -325,130 +528,178 @@ namespace gem
 
 	std::string FileReader::GetContents()
 	{
-		if (buffer.empty())
+		if (!IsBuffered())
 		{
-			// Buffer mode
 			return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
 		}
-		else
-		{
-			// Stream mode
-			if (currentPos >= buffer.size())
-			{
-				return std::string();
-			}
 
-			return buffer.substr(currentPos);
+		if (currentPos >= contents.size())
+		{
+			return std::string();
 		}
+
+		std::string result(contents.substr(currentPos));
+		currentPos = contents.size();
+
+		return result;
 	}
 
 	std::string FileReader::GetLine()
 	{
-		std::string result;
-		if (buffer.empty())
+		if (!IsBuffered())
 		{
+			std::string result;
 			std::getline(file, result);
-		}
-		else
-		{
-			if (currentPos < buffer.size())
-			{
-				result = buffer.substr(currentPos, buffer.find('\n', currentPos) - currentPos);
-				currentPos += result.size() + 1; //+ 1 for '\n'
-			}
+			return result;
 		}
 
-		return result;
+		return std::string(GetLineView());
 	}
 
 	std::string FileReader::GetWord()
 	{
-		std::string result;
-		if (buffer.empty())
+		if (!IsBuffered())
 		{
+			std::string result;
 			file >> result;
-		}
-		else
-		{
-			if (currentPos < buffer.size())
-			{
-				result = buffer.substr(currentPos, buffer.find_first_of(" \n", currentPos) - currentPos);
-				currentPos += result.size();
-			}
+			return result;
 		}
 
-		return result;
+		return std::string(GetWordView());
 	}
 
 	float FileReader::GetFloat()
 	{
-		if (buffer.empty())
+		if (!IsBuffered())
 		{
 			float result;
 			file >> result;
 			return result;
 		}
-		else
-		{
-			if (currentPos >= buffer.size())
-			{
-				return 0.0f;
-			}
 
-			return std::stof(&buffer[currentPos], &currentPos);
-		}
+		return ParseNumber<float>();
 	}
 
 	int FileReader::GetInt()
 	{
-		if (buffer.empty())
+		if (!IsBuffered())
 		{
 			int result;
 			file >> result;
 			return result;
 		}
-		else
-		{
-			if (currentPos >= buffer.size())
-			{
-				return 0;
-			}
 
-			return std::stoi(&buffer[currentPos], &currentPos);
-		}
+		return ParseNumber<int>();
 	}
 
 	char FileReader::GetChar()
 	{
-		if (buffer.empty())
+		if (!IsBuffered())
 		{
 			return static_cast<char>(file.get());
 		}
-		else
+
+		if (currentPos >= contents.size())
 		{
-			if (currentPos >= buffer.size())
-			{
-				return 0;
-			}
+			return 0;
+		}
 
-			return buffer[currentPos++];
+		return contents[currentPos++];
+	}
+
+	std::string_view FileReader::GetLineView()
+	{
+		ASSERT(IsBuffered(), "FileReader: Views can only be taken from buffers and mapped files.");
+
+		if (currentPos >= contents.size())
+		{
+			return {};
+		}
+
+		std::size_t end = contents.find('\n', currentPos);
+		if (end == std::string_view::npos)
+		{
+			end = contents.size();
+		}
+
+		std::string_view result = contents.substr(currentPos, end - currentPos);
+		currentPos = end + 1;
+
+		// Mapped files are not translated from Windows' line endings.
+		if (!result.empty() && result.back() == '\r')
+		{
+			result.remove_suffix(1);
 		}
+
+		return result;
 	}
 
-	bool FileReader::IsEOF() const
+	std::string_view FileReader::GetWordView()
 	{
-		if (buffer.empty())
+		ASSERT(IsBuffered(), "FileReader: Views can only be taken from buffers and mapped files.");
+
+		SkipWhitespace();
+
+		const std::size_t start = currentPos;
+		while (currentPos < contents.size() && !IsWhitespace(contents[currentPos]))
 		{
-			return file.eof();
+			++currentPos;
 		}
-		else
+
+		return contents.substr(start, currentPos - start);
+	}
+
+	bool FileReader::IsEOF() const
+	{
+		if (!IsBuffered())
 		{
-			return currentPos >= buffer.size();
+			return file.eof();
 		}
+
+		return currentPos >= contents.size();
 	}
 
 	int FileReader::GetSize() const
 	{
 		return length;
 	}
+
+	bool FileReader::IsBuffered() const
+	{
+		return mode == Mode::Buffer || mode == Mode::Mapped;
+	}
+
+	void FileReader::SkipWhitespace()
+	{
+		while (currentPos < contents.size() && IsWhitespace(contents[currentPos]))
+		{
+			++currentPos;
+		}
+	}
+
+	template<typename T>
+	T FileReader::ParseNumber()
+	{
+		const std::size_t start = currentPos;
+		SkipWhitespace();
+
+		// Like the stream operators, an explicit '+' sign is accepted.
+		if (currentPos < contents.size() && contents[currentPos] == '+')
+		{
+			++currentPos;
+		}
+
+		T result = 0;
+		const char* end = contents.data() + contents.size();
+		auto [ptr, error] = std::from_chars(contents.data() + currentPos, end, result);
+		if (error != std::errc())
+		{
+			// Nothing was read, so the next line is still intact.
+			currentPos = start;
+			return 0;
+		}
+
+		currentPos = ptr - contents.data();
+		return result;
+	}
 }
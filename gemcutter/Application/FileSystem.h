@@ -1,5 +1,6 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
+#include <cstddef>
 #include <fstream>
 #include <string>
 #include <string_view>
@@ -71,6 +72,35 @@ namespace gem
 	// Loads all the contents of a file into the provided string.
 	bool LoadFileAsString(std::string_view file, std::string& output);
 
+	// A read-only view of a file, mapped into memory by the OS.
+	// The file is not copied. Its pages are read from the disk as they are first accessed.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile(MappedFile&&) noexcept;
+		~MappedFile();
+
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&&) noexcept;
+
+		bool Open(std::string_view filePath);
+		void Close();
+
+		bool IsOpen() const;
+
+		// The view remains valid until the file is closed. Empty files have no data.
+		std::string_view GetView() const;
+		const char* GetData() const;
+		std::size_t GetSize() const;
+
+	private:
+		const char* data = nullptr;
+		std::size_t size = 0;
+		bool isOpen = false;
+	};
+
 	// Streams input from a file or loads a file as a buffer.
 	class FileReader
 	{
@@ -82,24 +112,31 @@ namespace gem
 
 		// Opens the file and loads it into RAM.
 		bool OpenAsBuffer(std::string_view filePath);
+		// Opens the file by mapping it into memory. Like a buffer, but without copying the file.
+		bool OpenAsMapped(std::string_view filePath);
 		// Opens the file for reading on command.
 		bool OpenAsStream(std::string_view filePath);
 		// Closes the file or releases memory from RAM.
 		void Close();
 
-		// Returns the contents from the current position to the end of the file.
+		// Returns the contents from the current position to the end of the file, and moves to the end.
 		std::string GetContents();
 		// Returns one line of text.
 		std::string GetLine();
 		// Returns the next spaced word.
 		std::string GetWord();
-		// Gets the next word as a float.
+		// Gets the next word as a float. Returns 0 if it isn't a number, without moving past it.
 		float GetFloat();
-		// Gets the next word as an int.
+		// Gets the next word as an int. Returns 0 if it isn't a number, without moving past it.
 		int GetInt();
 		// Gets the next character.
 		char GetChar();
 
+		// Like GetLine() and GetWord(), but without copying the text out of the file.
+		// Only for buffers and mapped files. The views remain valid until the file is closed.
+		std::string_view GetLineView();
+		std::string_view GetWordView();
+
 		// Returns true if the current position in the file is at the end.
 		bool IsEOF() const;
 
@@ -107,10 +144,29 @@ namespace gem
 		int GetSize() const;
 
 	private:
+		enum class Mode
+		{
+			Closed,
+			Buffer,
+			Mapped,
+			Stream
+		};
+
+		bool IsBuffered() const;
+		// Moves past any spaces, tabs, and line breaks.
+		void SkipWhitespace();
+		// Parses the next word of a buffer as a number. The position is left untouched if it fails.
+		template<typename T>
+		T ParseNumber();
+
 		std::ifstream file;
 		std::string buffer;
+		MappedFile mapping;
+		// The contents of the buffer or the mapped file.
+		std::string_view contents;
+		Mode mode = Mode::Closed;
 
-		unsigned currentPos = 0;
+		std::size_t currentPos = 0;
 		unsigned length = 0;
 	};
 }
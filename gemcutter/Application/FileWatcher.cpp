@@ -0,0 +1,282 @@
+// Copyright (c) 2022 Emilian Cioca
+#include "FileWatcher.h"
+#include "gemcutter/Application/FileSystem.h"
+#include "gemcutter/Application/Logging.h"
+#include "gemcutter/Application/Timer.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+	#include <Windows.h>
+#elif defined(__linux__)
+	#include <sys/inotify.h>
+	#include <unistd.h>
+	#include <unordered_map>
+#endif
+
+namespace gem
+{
+#ifdef _WIN32
+	struct FileWatcher::Watch
+	{
+		~Watch()
+		{
+			if (isPending)
+			{
+				// Wait for the cancelled request, since it still refers to the buffer.
+				DWORD numBytes = 0;
+				CancelIoEx(directoryHandle, &overlapped);
+				GetOverlappedResult(directoryHandle, &overlapped, &numBytes, TRUE);
+			}
+
+			if (overlapped.hEvent != NULL)
+			{
+				CloseHandle(overlapped.hEvent);
+			}
+
+			if (directoryHandle != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(directoryHandle);
+			}
+		}
+
+		bool Request()
+		{
+			isPending = ReadDirectoryChangesW(directoryHandle, buffer, sizeof(buffer), TRUE,
+				FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, nullptr, &overlapped, nullptr) != FALSE;
+
+			return isPending;
+		}
+
+		HANDLE directoryHandle = INVALID_HANDLE_VALUE;
+		OVERLAPPED overlapped = {};
+		bool isPending = false;
+
+		alignas(DWORD) char buffer[16 * 1024];
+	};
+#elif defined(__linux__)
+	struct FileWatcher::Watch
+	{
+		~Watch()
+		{
+			if (inotifyHandle != -1)
+			{
+				close(inotifyHandle);
+			}
+		}
+
+		// inotify is not recursive, so every subdirectory needs its own watch.
+		void AddDirectory(std::string path)
+		{
+			if (!path.ends_with('/'))
+			{
+				path.push_back('/');
+			}
+
+			const int handle = inotify_add_watch(inotifyHandle, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+			if (handle == -1)
+			{
+				Warning("FileWatcher: ( %s )\nUnable to watch directory.", path.c_str());
+				return;
+			}
+
+			DirectoryData data;
+			if (ParseDirectory(data, path))
+			{
+				for (const std::string& folder : data.folders)
+				{
+					AddDirectory(path + folder);
+				}
+			}
+
+			directories[handle] = std::move(path);
+		}
+
+		int inotifyHandle = -1;
+		// The directory of each watch, with a trailing '/'.
+		std::unordered_map<int, std::string> directories;
+	};
+#else
+	struct FileWatcher::Watch {};
+#endif
+
+	FileWatcher::FileWatcher() = default;
+
+	FileWatcher::~FileWatcher()
+	{
+		Stop();
+	}
+
+	bool FileWatcher::Start(std::string_view _directory)
+	{
+		ASSERT(!watch, "FileWatcher: Already watching a directory.");
+
+		auto data = std::make_unique<Watch>();
+		directory = _directory;
+
+#ifdef _WIN32
+		data->directoryHandle = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY,
+			FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+			OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+		if (data->directoryHandle == INVALID_HANDLE_VALUE)
+		{
+			Error("FileWatcher: ( %s )\nUnable to open directory.", directory.c_str());
+			return false;
+		}
+
+		data->overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+		if (data->overlapped.hEvent == NULL || !data->Request())
+		{
+			Error("FileWatcher: ( %s )\nUnable to watch directory.", directory.c_str());
+			return false;
+		}
+#elif defined(__linux__)
+		data->inotifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (data->inotifyHandle == -1)
+		{
+			Error("FileWatcher: ( %s )\nUnable to watch directory.", directory.c_str());
+			return false;
+		}
+
+		if (!DirectoryExists(directory))
+		{
+			Error("FileWatcher: ( %s )\nUnable to open directory.", directory.c_str());
+			return false;
+		}
+
+		data->AddDirectory(directory);
+#else
+		Error("FileWatcher: ( %s )\nWatching directories is not supported on this platform.", directory.c_str());
+		return false;
+#endif
+
+		if (!directory.empty() && directory.back() != '/' && directory.back() != '\\')
+		{
+			directory.push_back('/');
+		}
+
+		watch = std::move(data);
+		return true;
+	}
+
+	void FileWatcher::Stop()
+	{
+		watch.reset();
+		pending.clear();
+		directory.clear();
+	}
+
+	bool FileWatcher::IsWatching() const
+	{
+		return watch != nullptr;
+	}
+
+	void FileWatcher::PollChanges(std::vector<std::string>& outFiles)
+	{
+		ASSERT(watch, "FileWatcher: Not watching a directory.");
+
+		const std::int64_t currentTick = Timer::GetCurrentTick();
+
+#ifdef _WIN32
+		DWORD numBytes = 0;
+		while (watch->isPending && GetOverlappedResult(watch->directoryHandle, &watch->overlapped, &numBytes, FALSE))
+		{
+			// Zero bytes means there were too many changes to fit in the buffer. They are lost.
+			const char* itr = numBytes > 0 ? watch->buffer : nullptr;
+			while (itr)
+			{
+				auto& info = *reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(itr);
+				if (info.Action == FILE_ACTION_ADDED ||
+					info.Action == FILE_ACTION_MODIFIED ||
+					info.Action == FILE_ACTION_RENAMED_NEW_NAME)
+				{
+					const int nameLength = static_cast<int>(info.FileNameLength / sizeof(WCHAR));
+					const int size = WideCharToMultiByte(CP_UTF8, 0, info.FileName, nameLength, nullptr, 0, nullptr, nullptr);
+
+					std::string filePath = directory;
+					filePath.resize(directory.size() + size);
+					WideCharToMultiByte(CP_UTF8, 0, info.FileName, nameLength, filePath.data() + directory.size(), size, nullptr, nullptr);
+					std::replace(filePath.begin(), filePath.end(), '\\', '/');
+
+					AddPendingChange(std::move(filePath), currentTick);
+				}
+
+				itr = info.NextEntryOffset != 0 ? itr + info.NextEntryOffset : nullptr;
+			}
+
+			if (!watch->Request())
+			{
+				Error("FileWatcher: ( %s )\nUnable to watch directory.", directory.c_str());
+				break;
+			}
+		}
+#elif defined(__linux__)
+		alignas(inotify_event) char buffer[4096];
+		ssize_t numBytes = 0;
+		while ((numBytes = read(watch->inotifyHandle, buffer, sizeof(buffer))) > 0)
+		{
+			for (const char* itr = buffer; itr < buffer + numBytes;)
+			{
+				auto& event = *reinterpret_cast<const inotify_event*>(itr);
+				itr += sizeof(inotify_event) + event.len;
+
+				if (event.mask & IN_IGNORED)
+				{
+					watch->directories.erase(event.wd);
+					continue;
+				}
+
+				auto directoryItr = watch->directories.find(event.wd);
+				if (directoryItr == watch->directories.end() || event.len == 0)
+				{
+					continue;
+				}
+
+				std::string filePath = directoryItr->second + event.name;
+				if (event.mask & IN_ISDIR)
+				{
+					// New directories are watched too. Files created in them before this point are missed.
+					if (event.mask & (IN_CREATE | IN_MOVED_TO))
+					{
+						watch->AddDirectory(std::move(filePath));
+					}
+				}
+				else if (event.mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+				{
+					AddPendingChange(std::move(filePath), currentTick);
+				}
+			}
+		}
+#endif
+
+		// Report the files which have settled.
+		const std::int64_t settleTicks = static_cast<std::int64_t>(SETTLE_TIME_MS * Timer::GetTicksPerMS());
+		auto settled = std::stable_partition(pending.begin(), pending.end(), [&](const PendingChange& change) {
+			return currentTick - change.lastChange < settleTicks;
+		});
+
+		for (auto itr = settled; itr != pending.end(); ++itr)
+		{
+			outFiles.push_back(std::move(itr->filePath));
+		}
+
+		pending.erase(settled, pending.end());
+	}
+
+	void FileWatcher::AddPendingChange(std::string filePath, std::int64_t tick)
+	{
+		// A file is often written several times by a single save.
+		auto itr = std::find_if(pending.begin(), pending.end(), [&](const PendingChange& change) {
+			return change.filePath == filePath;
+		});
+
+		if (itr != pending.end())
+		{
+			itr->lastChange = tick;
+		}
+		else
+		{
+			pending.push_back({ std::move(filePath), tick });
+		}
+	}
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2022 Emilian Cioca
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gem
+{
+	// Reports the files which are written to within a directory, including its subdirectories.
+	// Changes are collected by the OS (ReadDirectoryChangesW on Windows, inotify on Linux),
+	// so checking for them is cheap and never scans the directory.
+	class FileWatcher
+	{
+	public:
+		FileWatcher();
+		FileWatcher(const FileWatcher&) = delete;
+		~FileWatcher();
+
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		bool Start(std::string_view directory);
+		void Stop();
+
+		bool IsWatching() const;
+
+		// Appends the files which have changed since they were last reported, without blocking.
+		// A file is only reported once it has stopped changing for SETTLE_TIME_MS, since the OS can report
+		// a change as soon as a file is truncated, before the new contents have been written.
+		// The paths begin with the watched directory and use '/' as a separator. Each file is reported once per call.
+		void PollChanges(std::vector<std::string>& outFiles);
+
+		static constexpr double SETTLE_TIME_MS = 100.0;
+
+	private:
+		// Records a change reported by the OS, restarting the file's settle time.
+		void AddPendingChange(std::string filePath, std::int64_t tick);
+
+		// The platform-specific handles.
+		struct Watch;
+		std::unique_ptr<Watch> watch;
+
+		struct PendingChange
+		{
+			std::string filePath;
+			std::int64_t lastChange;
+		};
+
+		// Files which have changed, but might still be being written.
+		std::vector<PendingChange> pending;
+		std::string directory;
+	};
+}
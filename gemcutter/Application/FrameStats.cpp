@@ -0,0 +1,238 @@
+// Copyright (c) 2022 Emilian Cioca
+#include "FrameStats.h"
+#include "gemcutter/Application/Logging.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+	// The nearest-rank percentile of sorted frame times.
+	float Percentile(const float* sorted, unsigned count, float percent)
+	{
+		if (count == 0)
+		{
+			return 0.0f;
+		}
+
+		const unsigned rank = static_cast<unsigned>(std::ceil(percent / 100.0f * count));
+		return sorted[std::clamp(rank, 1u, count) - 1];
+	}
+
+	// Sorts the values in order to summarize them.
+	gem::FrameTimeSummary Summarize(float* values, unsigned count)
+	{
+		if (count == 0)
+		{
+			return {};
+		}
+
+		float sum = 0.0f;
+		for (unsigned i = 0; i < count; ++i)
+		{
+			sum += values[i];
+		}
+
+		std::sort(values, values + count);
+
+		gem::FrameTimeSummary summary;
+		summary.p50 = Percentile(values, count, 50.0f);
+		summary.p95 = Percentile(values, count, 95.0f);
+		summary.p99 = Percentile(values, count, 99.0f);
+		summary.max = values[count - 1];
+		summary.average = sum / count;
+
+		return summary;
+	}
+}
+
+namespace gem
+{
+	void FrameStats::AddFrame(const FrameTiming& frame)
+	{
+		history[next] = frame;
+		next = (next + 1) % HISTORY_SIZE;
+
+		const unsigned bucket = static_cast<unsigned>(std::max(frame.totalMS, 0.0f));
+		histogram[std::min(bucket, HISTOGRAM_SIZE - 1)]++;
+
+		if (frame.totalMS > hitchThreshold)
+		{
+			numHitches++;
+		}
+
+		numFrames++;
+	}
+
+	void FrameStats::Reset()
+	{
+		history.fill({});
+		histogram.fill(0);
+		wakeLatency.fill(0.0f);
+		next = 0;
+		nextWake = 0;
+		numFrames = 0;
+		numHitches = 0;
+		numWakes = 0;
+	}
+
+	void FrameStats::SetHitchThreshold(float ms)
+	{
+		ASSERT(ms > 0.0f, "'ms' must be greater than 0.");
+
+		hitchThreshold = ms;
+	}
+
+	float FrameStats::GetHitchThreshold() const
+	{
+		return hitchThreshold;
+	}
+
+	unsigned FrameStats::GetNumFrames() const
+	{
+		return numFrames;
+	}
+
+	unsigned FrameStats::GetNumHitches() const
+	{
+		return numHitches;
+	}
+
+	const FrameTiming& FrameStats::GetLastFrame() const
+	{
+		return history[(next + HISTORY_SIZE - 1) % HISTORY_SIZE];
+	}
+
+	float FrameStats::GetPercentile(float percent) const
+	{
+		ASSERT(percent >= 0.0f && percent <= 100.0f, "'percent' must be in the range [0, 100].");
+
+		std::array<float, HISTORY_SIZE> times;
+		const unsigned count = GetHistorySize();
+		for (unsigned i = 0; i < count; ++i)
+		{
+			times[i] = history[i].totalMS;
+		}
+
+		std::sort(times.begin(), times.begin() + count);
+		return Percentile(times.data(), count, percent);
+	}
+
+	FrameTimeSummary FrameStats::GetSummary() const
+	{
+		std::array<float, HISTORY_SIZE> times;
+		const unsigned count = GetHistorySize();
+		for (unsigned i = 0; i < count; ++i)
+		{
+			times[i] = history[i].totalMS;
+		}
+
+		return Summarize(times.data(), count);
+	}
+
+	FrameTiming FrameStats::GetAverage() const
+	{
+		const unsigned count = GetHistorySize();
+		if (count == 0)
+		{
+			return {};
+		}
+
+		FrameTiming average;
+		for (unsigned i = 0; i < count; ++i)
+		{
+			average.updateMS += history[i].updateMS;
+			average.renderMS += history[i].renderMS;
+			average.idleMS += history[i].idleMS;
+			average.totalMS += history[i].totalMS;
+		}
+
+		average.updateMS /= count;
+		average.renderMS /= count;
+		average.idleMS /= count;
+		average.totalMS /= count;
+
+		return average;
+	}
+
+	const std::array<unsigned, FrameStats::HISTOGRAM_SIZE>& FrameStats::GetHistogram() const
+	{
+		return histogram;
+	}
+
+	void FrameStats::AddWakeLatency(float ms)
+	{
+		wakeLatency[nextWake] = ms;
+		nextWake = (nextWake + 1) % HISTORY_SIZE;
+		numWakes++;
+	}
+
+	FrameTimeSummary FrameStats::GetWakeLatency() const
+	{
+		std::array<float, HISTORY_SIZE> latencies = wakeLatency;
+		return Summarize(latencies.data(), std::min(numWakes, HISTORY_SIZE));
+	}
+
+	bool FrameStats::Save(std::string_view file) const
+	{
+		std::ofstream output(file.data());
+		if (!output)
+		{
+			Error("FrameStats: Could not open \"%s\" for writing.", file.data());
+			return false;
+		}
+
+		const FrameTimeSummary summary = GetSummary();
+		const FrameTiming average = GetAverage();
+
+		output << "Frames: " << numFrames << '\n';
+		output << "Hitches (over " << hitchThreshold << "ms): " << numHitches << '\n';
+		output << '\n';
+		output << "Last " << GetHistorySize() << " frames (ms):\n";
+		output << "p50: " << summary.p50 << '\n';
+		output << "p95: " << summary.p95 << '\n';
+		output << "p99: " << summary.p99 << '\n';
+		output << "max: " << summary.max << '\n';
+		output << "average update: " << average.updateMS << '\n';
+		output << "average render: " << average.renderMS << '\n';
+		output << "average idle: " << average.idleMS << '\n';
+		output << "average total: " << average.totalMS << '\n';
+		output << '\n';
+
+		if (numWakes > 0)
+		{
+			const FrameTimeSummary wakeUp = GetWakeLatency();
+			output << "Wake-up latency (ms):\n";
+			output << "p50: " << wakeUp.p50 << '\n';
+			output << "p99: " << wakeUp.p99 << '\n';
+			output << "max: " << wakeUp.max << '\n';
+			output << '\n';
+		}
+
+		output << "Histogram (ms):\n";
+		for (unsigned i = 0; i < HISTOGRAM_SIZE; ++i)
+		{
+			if (histogram[i] == 0)
+			{
+				continue;
+			}
+
+			if (i == HISTOGRAM_SIZE - 1)
+			{
+				output << i << "+: " << histogram[i] << '\n';
+			}
+			else
+			{
+				output << i << '-' << i + 1 << ": " << histogram[i] << '\n';
+			}
+		}
+
+		return static_cast<bool>(output);
+	}
+
+	unsigned FrameStats::GetHistorySize() const
+	{
+		return std::min(numFrames, HISTORY_SIZE);
+	}
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2022 Emilian Cioca
+#pragma once
+#include <array>
+#include <string_view>
+
+namespace gem
+{
+	// How the time of a single frame was spent, in milliseconds.
+	struct FrameTiming
+	{
+		float updateMS = 0.0f;
+		float renderMS = 0.0f;
+		// Time spent waiting for the next update or frame to be due.
+		float idleMS = 0.0f;
+		// The time since the end of the previous frame.
+		float totalMS = 0.0f;
+	};
+
+	// Statistics of timings in the recent history, in milliseconds.
+	struct FrameTimeSummary
+	{
+		float p50 = 0.0f;
+		float p95 = 0.0f;
+		float p99 = 0.0f;
+		float max = 0.0f;
+		float average = 0.0f;
+	};
+
+	// Records frame timings to reveal hitches and uneven frame pacing, which an averaged framerate hides.
+	// Percentiles are computed over a rolling window of recent frames, while the hitch count and the
+	// histogram cover every frame since the last Reset().
+	class FrameStats
+	{
+	public:
+		// The number of recent frames covered by the percentiles.
+		static constexpr unsigned HISTORY_SIZE = 600;
+		// The histogram has a bucket for each millisecond. The last bucket also counts all longer frames.
+		static constexpr unsigned HISTOGRAM_SIZE = 64;
+
+		void AddFrame(const FrameTiming& frame);
+		void Reset();
+
+		// Frames which take longer than this many milliseconds are counted as hitches. Default is 33.3ms.
+		void SetHitchThreshold(float ms);
+		float GetHitchThreshold() const;
+
+		// The number of frames recorded since the last Reset().
+		unsigned GetNumFrames() const;
+		unsigned GetNumHitches() const;
+
+		const FrameTiming& GetLastFrame() const;
+
+		// Returns the frame time, in milliseconds, which the given percent of recent frames didn't exceed.
+		float GetPercentile(float percent) const;
+		FrameTimeSummary GetSummary() const;
+
+		// Returns the average of each timing over the recent frames.
+		FrameTiming GetAverage() const;
+
+		const std::array<unsigned, HISTOGRAM_SIZE>& GetHistogram() const;
+
+		// Records how late the game-loop woke up, after waiting for the next update to be due.
+		void AddWakeLatency(float ms);
+		// Returns statistics of how late the game-loop woke up recently. A measure of the OS's scheduling jitter.
+		FrameTimeSummary GetWakeLatency() const;
+
+		// Writes the statistics to a human readable text file.
+		bool Save(std::string_view file) const;
+
+	private:
+		unsigned GetHistorySize() const;
+
+		std::array<FrameTiming, HISTORY_SIZE> history;
+		// Where the next frame will be written to in the history.
+		unsigned next = 0;
+
+		std::array<unsigned, HISTOGRAM_SIZE> histogram = {};
+
+		std::array<float, HISTORY_SIZE> wakeLatency = {};
+		unsigned nextWake = 0;
+		unsigned numWakes = 0;
+
+		unsigned numFrames = 0;
+		unsigned numHitches = 0;
+		float hitchThreshold = 1000.0f / 30.0f;
+	};
+}
@@ -4,6 +4,10 @@
 #include "gemcutter/Application/Event.h"
 #include "gemcutter/Entity/Entity.h"
 #include "gemcutter/Entity/Hierarchy.h"
+#include "gemcutter/Entity/HierarchyTraversal.h"
+
+#include <algorithm>
+#include <vector>
 
 namespace gem
 {
@@ -16,11 +20,28 @@ namespace gem
 		HierarchicalListener(Entity& _owner)
 			: Component<HierarchicalListener<EventObj>>(_owner)
 		{
+			MarkChanged();
+		}
+
+		~HierarchicalListener()
+		{
+			MarkChanged();
 		}
 
 		// Your function should return 'true' if the event is handled. This will
 		// consume it and stop it from propagating further down the hierarchy.
 		Delegate<bool(const EventObj&)> callback;
+
+	private:
+		// Lets the HierarchicalDispatchers above us know that their listener lists are out of date.
+		void MarkChanged()
+		{
+			Entity& ent = this->owner;
+			if (auto* hierarchy = ent.Try<Hierarchy>())
+			{
+				hierarchy->MarkSubtreeChanged();
+			}
+		}
 	};
 
 	// Propagates an event through a hierarchy of Entities.
@@ -32,46 +53,101 @@ namespace gem
 		HierarchicalDispatcher(Entity& _owner)
 			: Component<HierarchicalDispatcher<EventObj>>(_owner)
 		{
-			this->owner.Require<Hierarchy>();
+			_owner.Require<Hierarchy>();
 
 			listener = [this](auto& e) {
 				if (this->IsEnabled())
 				{
-					Distribute(this->owner, e);
+					Distribute(e);
 				}
 			};
 		}
 
 	private:
+		using ListenerList = std::vector<HierarchicalListener<EventObj>*>;
+
 		// Propagates the event through the hierarchy while notifying HierarchicalListeners.
 		// Once a listener has handled the event, propagation stops.
-		static bool Distribute(Entity& ent, const EventObj& e)
+		void Distribute(const EventObj& e)
 		{
-			auto& children = ent.Get<Hierarchy>().GetChildren();
+			Entity& root = this->owner;
+			const Hierarchy& hierarchy = root.Get<Hierarchy>();
 
-			// Manual loop to avoid iterator invalidation from callback side-effects.
-			for (unsigned i = 0; i < children.size(); ++i)
+			// A callback might raise the event again. The nested dispatch must not modify the list
+			// which the outer one is still reading, so it gathers a temporary list if it needs one.
+			ListenerList changedListeners;
+			const ListenerList* list = &listeners;
+			if (cachedVersion != hierarchy.GetSubtreeVersion())
 			{
-				if (auto* comp = children[i]->Try<HierarchicalListener<EventObj>>())
+				if (dispatchDepth == 0)
 				{
-					if (comp->callback(e).value_or(false))
-					{
-						return true;
-					}
+					GatherListeners(listeners);
+					cachedVersion = hierarchy.GetSubtreeVersion();
+				}
+				else
+				{
+					GatherListeners(changedListeners);
+					list = &changedListeners;
 				}
 			}
 
-			for (unsigned i = 0; i < children.size(); ++i)
+			dispatchDepth++;
+
+			ListenerList notified;
+			unsigned version = hierarchy.GetSubtreeVersion();
+			unsigned i = 0;
+			while (i < list->size())
 			{
-				if (Distribute(*children[i], e))
+				if (version != hierarchy.GetSubtreeVersion())
 				{
-					return true;
+					// A callback has restructured the subtree or changed its listeners, so the list might hold
+					// dangling pointers. Gather a new one and continue with the listeners not yet notified.
+					notified.insert(notified.end(), list->begin(), list->begin() + i);
+					GatherListeners(changedListeners);
+					list = &changedListeners;
+					version = hierarchy.GetSubtreeVersion();
+					i = 0;
+					continue;
+				}
+
+				auto* comp = (*list)[i++];
+				if (!notified.empty() && std::find(notified.begin(), notified.end(), comp) != notified.end())
+				{
+					continue;
+				}
+
+				if (comp->callback(e).value_or(false))
+				{
+					break;
 				}
 			}
 
-			return false;
+			dispatchDepth--;
+		}
+
+		// Collects the listeners in the order they are notified in. Each Entity, visited in pre-order,
+		// contributes its direct children before the walk descends any further.
+		void GatherListeners(ListenerList& result)
+		{
+			result.clear();
+
+			for (Entity& ent : traversal.Walk(this->owner, TraversalOrder::PreOrder))
+			{
+				for (auto& child : ent.Get<Hierarchy>().GetChildren())
+				{
+					if (auto* comp = child->Try<HierarchicalListener<EventObj>>())
+					{
+						result.push_back(comp);
+					}
+				}
+			}
 		}
 
+		// The listening descendants, valid as long as the subtree version matches 'cachedVersion'.
+		ListenerList listeners;
+		unsigned cachedVersion = ~0u;
+		unsigned dispatchDepth = 0;
+		HierarchyTraversal traversal;
 		Listener<EventObj> listener;
 	};
 }
@@ -0,0 +1,108 @@
+// Copyright (c) 2022 Emilian Cioca
+#include "InlineDelegate.h"
+
+namespace gem
+{
+	namespace detail
+	{
+		InlineBindingBase::InlineBindingBase(InlineBindingBase&& other) noexcept
+			: expired(other.expired)
+			, handle(other.handle)
+		{
+			if (handle)
+			{
+				handle->binding = this;
+				other.handle = nullptr;
+			}
+		}
+
+		InlineBindingBase::~InlineBindingBase()
+		{
+			Disconnect();
+		}
+
+		InlineBindingBase& InlineBindingBase::operator=(InlineBindingBase&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Disconnect();
+
+				expired = other.expired;
+				handle = other.handle;
+
+				if (handle)
+				{
+					handle->binding = this;
+					other.handle = nullptr;
+				}
+			}
+
+			return *this;
+		}
+
+		InlineDelegateHandle InlineBindingBase::Connect()
+		{
+			ASSERT(handle == nullptr, "Binding is already connected to a handle.");
+
+			return { *this };
+		}
+
+		void InlineBindingBase::Disconnect()
+		{
+			if (handle)
+			{
+				handle->binding = nullptr;
+				handle = nullptr;
+			}
+		}
+	}
+
+	InlineDelegateHandle::InlineDelegateHandle(detail::InlineBindingBase& _binding)
+		: binding(&_binding)
+	{
+		binding->handle = this;
+	}
+
+	InlineDelegateHandle::InlineDelegateHandle(InlineDelegateHandle&& other) noexcept
+		: binding(other.binding)
+	{
+		if (binding)
+		{
+			binding->handle = this;
+			other.binding = nullptr;
+		}
+	}
+
+	InlineDelegateHandle::~InlineDelegateHandle()
+	{
+		Expire();
+	}
+
+	InlineDelegateHandle& InlineDelegateHandle::operator=(InlineDelegateHandle&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Expire();
+
+			binding = other.binding;
+			if (binding)
+			{
+				binding->handle = this;
+				other.binding = nullptr;
+			}
+		}
+
+		return *this;
+	}
+
+	void InlineDelegateHandle::Expire()
+	{
+		if (binding)
+		{
+			// The functor is destroyed later by its owner, since it might be executing right now.
+			binding->expired = true;
+			binding->handle = nullptr;
+			binding = nullptr;
+		}
+	}
+}
@@ -0,0 +1,166 @@
+// Copyright (c) 2022 Emilian Cioca
+#pragma once
+#include "gemcutter/Application/Logging.h"
+
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace gem
+{
+	class InlineDelegateHandle;
+	template<typename T, unsigned Capacity = 32> class InplaceFunction    { static_assert(std::is_function_v<T>, "Must be given a function signature."); };
+	template<typename T, unsigned Capacity = 32> class InlineDelegate     { static_assert(std::is_function_v<T>, "Must be given a function signature."); };
+	template<typename T, unsigned Capacity = 32> class InlineDispatcher   { static_assert(std::is_function_v<T>, "Must be given a function signature."); };
+
+	// A std::function alternative which stores the functor inside the object itself.
+	// It never allocates. Functors larger than 'Capacity' bytes are rejected at compile time.
+	template<typename Return, typename... Args, unsigned Capacity>
+	class InplaceFunction<Return(Args...), Capacity>
+	{
+	public:
+		InplaceFunction() = default;
+		InplaceFunction(std::nullptr_t) {}
+		InplaceFunction(const InplaceFunction&) = delete;
+		InplaceFunction(InplaceFunction&&) noexcept;
+		~InplaceFunction();
+
+		template<typename Functor> requires (!std::is_same_v<std::remove_cvref_t<Functor>, InplaceFunction>)
+		InplaceFunction(Functor&& functor);
+
+		InplaceFunction& operator=(const InplaceFunction&) = delete;
+		InplaceFunction& operator=(InplaceFunction&&) noexcept;
+		InplaceFunction& operator=(std::nullptr_t);
+
+		Return operator()(Args... args);
+
+		explicit operator bool() const;
+
+	private:
+		using Invoker = Return(*)(void* storage, Args&&... args);
+		// Move-constructs the functor from 'source' into 'destination', then destroys 'source'.
+		// If 'destination' is null, 'source' is only destroyed.
+		using Manager = void(*)(void* destination, void* source);
+
+		alignas(std::max_align_t) std::byte storage[Capacity];
+		Invoker invoker = nullptr;
+		Manager manager = nullptr;
+	};
+
+	namespace detail
+	{
+		// The part of an inline binding which is linked to its InlineDelegateHandle.
+		// The binding and the handle point directly to each other and patch the pointer
+		// whenever either one is moved or destroyed, so no shared state has to be allocated.
+		class InlineBindingBase
+		{
+			friend InlineDelegateHandle;
+		public:
+			InlineBindingBase() = default;
+			InlineBindingBase(const InlineBindingBase&) = delete;
+			InlineBindingBase(InlineBindingBase&&) noexcept;
+			~InlineBindingBase();
+
+			InlineBindingBase& operator=(const InlineBindingBase&) = delete;
+			InlineBindingBase& operator=(InlineBindingBase&&) noexcept;
+
+			// Links the binding to a new handle.
+			InlineDelegateHandle Connect();
+			// Cuts the link to the handle, if there is one. The handle is left expired.
+			void Disconnect();
+
+			// Set once the handle has been expired. The functor should not be invoked anymore.
+			bool expired = false;
+
+		private:
+			InlineDelegateHandle* handle = nullptr;
+		};
+
+		template<typename Signature, unsigned Capacity>
+		struct InlineBinding : public InlineBindingBase
+		{
+			InplaceFunction<Signature, Capacity> func;
+		};
+	}
+
+	// Enables control over when an inline delegate binding is expired.
+	class [[nodiscard]] InlineDelegateHandle
+	{
+		friend detail::InlineBindingBase;
+
+		InlineDelegateHandle(detail::InlineBindingBase& binding);
+	public:
+		InlineDelegateHandle() = default;
+		InlineDelegateHandle(const InlineDelegateHandle&) = delete;
+		InlineDelegateHandle(InlineDelegateHandle&&) noexcept;
+		~InlineDelegateHandle();
+
+		InlineDelegateHandle& operator=(const InlineDelegateHandle&) = delete;
+		InlineDelegateHandle& operator=(InlineDelegateHandle&&) noexcept;
+
+		// Disconnects the associated delegate binding.
+		void Expire();
+
+	private:
+		detail::InlineBindingBase* binding = nullptr;
+	};
+
+	// A Delegate which stores its functor inline and tracks the lifetime of its binding intrusively.
+	// Invoking it does not touch any reference counts, and binding a functor never allocates.
+	// Unlike Delegate<>, lifetimes can only be controlled with a handle.
+	template<typename Return, typename... Args, unsigned Capacity>
+	class InlineDelegate<Return(Args...), Capacity>
+	{
+	public:
+		constexpr static bool HasReturnValue = !std::is_void_v<Return>;
+
+		// Binds the lifetime of the functor to the returned handle.
+		template<typename Functor>
+		InlineDelegateHandle Bind(Functor&& functor);
+
+		void Clear();
+
+		// Checks if a functor is bound and has not been expired.
+		operator bool() const;
+
+		// An empty optional<> is returned if a return type exists, but the functor could not be invoked.
+		template<typename... Params>
+		auto operator()(Params&&... params) -> std::conditional_t<HasReturnValue, std::optional<Return>, void>;
+
+	private:
+		detail::InlineBinding<Return(Args...), Capacity> binding;
+	};
+
+	// An InlineDelegate which supports multiple bound functors.
+	template<typename Return, typename... Args, unsigned Capacity>
+	class InlineDispatcher<Return(Args...), Capacity>
+	{
+	public:
+		// Binds the lifetime of the functor to the returned handle.
+		// Functors added while dispatching will be invoked starting from the next dispatch.
+		template<typename Functor>
+		InlineDelegateHandle Add(Functor&& functor);
+
+		// Checks if at least one functor is bound and has not been expired.
+		bool HasBindings() const;
+		void Clear();
+
+		template<typename... Params>
+		void Dispatch(Params&&... params);
+
+	private:
+		using Binding = detail::InlineBinding<Return(Args...), Capacity>;
+
+		// Erases expired bindings and moves in the bindings added while dispatching.
+		void Flush();
+
+		std::vector<Binding> bindings;
+		// Bindings added during a dispatch. They are kept aside since adding them directly
+		// could reallocate the vector while one of its functors is executing.
+		std::vector<Binding> addedBindings;
+		unsigned dispatchDepth = 0;
+	};
+}
+
+#include "InlineDelegate.inl"
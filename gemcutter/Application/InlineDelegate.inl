@@ -0,0 +1,232 @@
+// Copyright (c) 2022 Emilian Cioca
+#include <algorithm>
+#include <new>
+#include <utility>
+
+namespace gem
+{
+	template<typename Return, typename... Args, unsigned Capacity>
+	InplaceFunction<Return(Args...), Capacity>::InplaceFunction(InplaceFunction&& other) noexcept
+		: invoker(other.invoker)
+		, manager(other.manager)
+	{
+		if (manager)
+		{
+			manager(storage, other.storage);
+			other.invoker = nullptr;
+			other.manager = nullptr;
+		}
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	InplaceFunction<Return(Args...), Capacity>::~InplaceFunction()
+	{
+		*this = nullptr;
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	template<typename Functor> requires (!std::is_same_v<std::remove_cvref_t<Functor>, InplaceFunction<Return(Args...), Capacity>>)
+	InplaceFunction<Return(Args...), Capacity>::InplaceFunction(Functor&& functor)
+	{
+		using Type = std::decay_t<Functor>;
+		static_assert(sizeof(Type) <= Capacity, "Functor is too large to be stored inline. Increase the Capacity or capture less state.");
+		static_assert(alignof(Type) <= alignof(std::max_align_t), "Functor is over-aligned.");
+		static_assert(std::is_nothrow_move_constructible_v<Type>, "Functor must be nothrow move-constructible.");
+		static_assert(std::is_invocable_r_v<Return, Type&, Args...>, "Functor does not match the function signature.");
+
+		new (storage) Type(std::forward<Functor>(functor));
+
+		invoker = [](void* ptr, Args&&... args) -> Return {
+			return (*static_cast<Type*>(ptr))(std::forward<Args>(args)...);
+		};
+
+		manager = [](void* destination, void* source) {
+			Type& sourceFunctor = *static_cast<Type*>(source);
+			if (destination)
+			{
+				new (destination) Type(std::move(sourceFunctor));
+			}
+
+			sourceFunctor.~Type();
+		};
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	InplaceFunction<Return(Args...), Capacity>& InplaceFunction<Return(Args...), Capacity>::operator=(InplaceFunction&& other) noexcept
+	{
+		if (this != &other)
+		{
+			*this = nullptr;
+
+			if (other.manager)
+			{
+				other.manager(storage, other.storage);
+				invoker = other.invoker;
+				manager = other.manager;
+				other.invoker = nullptr;
+				other.manager = nullptr;
+			}
+		}
+
+		return *this;
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	InplaceFunction<Return(Args...), Capacity>& InplaceFunction<Return(Args...), Capacity>::operator=(std::nullptr_t)
+	{
+		if (manager)
+		{
+			manager(nullptr, storage);
+			invoker = nullptr;
+			manager = nullptr;
+		}
+
+		return *this;
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	Return InplaceFunction<Return(Args...), Capacity>::operator()(Args... args)
+	{
+		ASSERT(invoker, "InplaceFunction is empty.");
+
+		return invoker(storage, std::forward<Args>(args)...);
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	InplaceFunction<Return(Args...), Capacity>::operator bool() const
+	{
+		return invoker != nullptr;
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	template<typename Functor>
+	InlineDelegateHandle InlineDelegate<Return(Args...), Capacity>::Bind(Functor&& functor)
+	{
+		binding.Disconnect();
+		binding.func = std::forward<Functor>(functor);
+		binding.expired = false;
+
+		return binding.Connect();
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	void InlineDelegate<Return(Args...), Capacity>::Clear()
+	{
+		binding.Disconnect();
+		binding.func = nullptr;
+		binding.expired = false;
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	InlineDelegate<Return(Args...), Capacity>::operator bool() const
+	{
+		return !binding.expired && binding.func;
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	template<typename... Params>
+	auto InlineDelegate<Return(Args...), Capacity>::operator()(Params&&... params) -> std::conditional_t<HasReturnValue, std::optional<Return>, void>
+	{
+		if constexpr (HasReturnValue)
+		{
+			std::optional<Return> result;
+			if (*this)
+			{
+				result = binding.func(std::forward<Params>(params)...);
+			}
+
+			return result;
+		}
+		else
+		{
+			if (*this)
+			{
+				binding.func(std::forward<Params>(params)...);
+			}
+		}
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	template<typename Functor>
+	InlineDelegateHandle InlineDispatcher<Return(Args...), Capacity>::Add(Functor&& functor)
+	{
+		auto& list = dispatchDepth > 0 ? addedBindings : bindings;
+
+		Binding& binding = list.emplace_back();
+		binding.func = std::forward<Functor>(functor);
+
+		return binding.Connect();
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	bool InlineDispatcher<Return(Args...), Capacity>::HasBindings() const
+	{
+		auto isBound = [](const Binding& binding) { return !binding.expired; };
+
+		return std::any_of(bindings.begin(), bindings.end(), isBound) ||
+			std::any_of(addedBindings.begin(), addedBindings.end(), isBound);
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	void InlineDispatcher<Return(Args...), Capacity>::Clear()
+	{
+		if (dispatchDepth > 0)
+		{
+			// The functors can't be destroyed while one of them might be executing.
+			for (Binding& binding : bindings)
+			{
+				binding.Disconnect();
+				binding.expired = true;
+			}
+
+			addedBindings.clear();
+		}
+		else
+		{
+			bindings.clear();
+		}
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	template<typename... Params>
+	void InlineDispatcher<Return(Args...), Capacity>::Dispatch(Params&&... params)
+	{
+		dispatchDepth++;
+
+		const unsigned size = bindings.size();
+		for (unsigned i = 0; i < size; ++i)
+		{
+			Binding& binding = bindings[i];
+			if (!binding.expired)
+			{
+				binding.func(std::forward<Params>(params)...);
+			}
+		}
+
+		dispatchDepth--;
+
+		if (dispatchDepth == 0)
+		{
+			Flush();
+		}
+	}
+
+	template<typename Return, typename... Args, unsigned Capacity>
+	void InlineDispatcher<Return(Args...), Capacity>::Flush()
+	{
+		std::erase_if(bindings, [](const Binding& binding) { return binding.expired; });
+
+		if (!addedBindings.empty())
+		{
+			for (Binding& binding : addedBindings)
+			{
+				if (!binding.expired)
+				{
+					bindings.push_back(std::move(binding));
+				}
+			}
+
+			addedBindings.clear();
+		}
+	}
+}
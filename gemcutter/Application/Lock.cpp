@@ -0,0 +1,171 @@
+// Copyright (c) 2022 Emilian Cioca
+#include "Lock.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#include <immintrin.h>
+	#define GEM_CPU_PAUSE() _mm_pause()
+#else
+	#include <thread>
+	#define GEM_CPU_PAUSE() std::this_thread::yield()
+#endif
+
+namespace
+{
+	// How many times to check the lock before parking the thread.
+	// Covers a typical short critical section, without burning much time on a long one.
+	constexpr unsigned SPIN_COUNT = 128;
+}
+
+namespace gem
+{
+	void SpinLock::lock()
+	{
+		std::uint32_t expected = Unlocked;
+		if (state.compare_exchange_strong(expected, Locked, std::memory_order_acquire, std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		// Only read the lock while spinning, to avoid bouncing the cache line between the waiting cores.
+		for (unsigned i = 0; i < SPIN_COUNT; ++i)
+		{
+			CpuRelax();
+
+			if (state.load(std::memory_order_relaxed) == Unlocked)
+			{
+				expected = Unlocked;
+				if (state.compare_exchange_weak(expected, Locked, std::memory_order_acquire, std::memory_order_relaxed))
+				{
+					return;
+				}
+			}
+		}
+
+		// Announce that we are waiting, so the owner knows to wake us when it unlocks.
+		while (state.exchange(Contended, std::memory_order_acquire) != Unlocked)
+		{
+			state.wait(Contended, std::memory_order_relaxed);
+		}
+	}
+
+	bool SpinLock::try_lock()
+	{
+		std::uint32_t expected = Unlocked;
+		return state.compare_exchange_strong(expected, Locked, std::memory_order_acquire, std::memory_order_relaxed);
+	}
+
+	void SpinLock::unlock()
+	{
+		if (state.exchange(Unlocked, std::memory_order_release) == Contended)
+		{
+			state.notify_one();
+		}
+	}
+
+	void ReadWriteLock::lock()
+	{
+		unsigned spins = 0;
+		std::uint32_t current = state.load(std::memory_order_relaxed);
+		while (true)
+		{
+			// Acquire once there are no readers and no writer. Keep any pending flag set by other writers.
+			if ((current & (WriterBit | ReaderMask)) == 0)
+			{
+				if (state.compare_exchange_weak(current, WriterBit | (current & PendingBit), std::memory_order_acquire, std::memory_order_relaxed))
+				{
+					return;
+				}
+
+				continue;
+			}
+
+			// Hold back new readers until we get our turn.
+			if ((current & PendingBit) == 0)
+			{
+				if (!state.compare_exchange_weak(current, current | PendingBit, std::memory_order_relaxed))
+				{
+					continue;
+				}
+
+				current |= PendingBit;
+			}
+
+			if (spins++ < SPIN_COUNT)
+			{
+				CpuRelax();
+			}
+			else
+			{
+				state.wait(current, std::memory_order_relaxed);
+			}
+
+			current = state.load(std::memory_order_relaxed);
+		}
+	}
+
+	bool ReadWriteLock::try_lock()
+	{
+		std::uint32_t current = state.load(std::memory_order_relaxed);
+		return (current & (WriterBit | ReaderMask)) == 0 &&
+			state.compare_exchange_strong(current, WriterBit | (current & PendingBit), std::memory_order_acquire, std::memory_order_relaxed);
+	}
+
+	void ReadWriteLock::unlock()
+	{
+		// Writers waiting behind this one will set the pending flag again.
+		state.store(0, std::memory_order_release);
+		state.notify_all();
+	}
+
+	void ReadWriteLock::lock_shared()
+	{
+		unsigned spins = 0;
+		std::uint32_t current = state.load(std::memory_order_relaxed);
+		while (true)
+		{
+			if ((current & (WriterBit | PendingBit)) == 0)
+			{
+				if (state.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed))
+				{
+					return;
+				}
+
+				continue;
+			}
+
+			if (spins++ < SPIN_COUNT)
+			{
+				CpuRelax();
+			}
+			else
+			{
+				state.wait(current, std::memory_order_relaxed);
+			}
+
+			current = state.load(std::memory_order_relaxed);
+		}
+	}
+
+	bool ReadWriteLock::try_lock_shared()
+	{
+		std::uint32_t current = state.load(std::memory_order_relaxed);
+		return (current & (WriterBit | PendingBit)) == 0 &&
+			state.compare_exchange_strong(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed);
+	}
+
+	void ReadWriteLock::unlock_shared()
+	{
+		const std::uint32_t previous = state.fetch_sub(1, std::memory_order_release);
+
+		// The last reader out lets a pending writer in.
+		if ((previous & ReaderMask) == 1 && (previous & PendingBit) != 0)
+		{
+			state.notify_all();
+		}
+	}
+
+	void CpuRelax()
+	{
+		GEM_CPU_PAUSE();
+	}
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2022 Emilian Cioca
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace gem
+{
+	// A mutex which stays in user-space when uncontended. A thread which finds it locked spins for a short
+	// while, expecting the owner to be done soon, and only then parks itself in the kernel until it is woken.
+	// Best suited for short critical sections. The member functions follow the standard naming, so the lock
+	// can be used with std::lock_guard and std::unique_lock.
+	class SpinLock
+	{
+	public:
+		SpinLock() = default;
+		SpinLock(const SpinLock&) = delete;
+		SpinLock& operator=(const SpinLock&) = delete;
+
+		void lock();
+		bool try_lock();
+		void unlock();
+
+	private:
+		enum State : std::uint32_t
+		{
+			Unlocked,
+			Locked,
+			// Locked, and at least one thread might be parked waiting for it.
+			Contended
+		};
+
+		std::atomic<std::uint32_t> state = Unlocked;
+	};
+
+	// A lock which can be held by many readers at once, or by a single writer.
+	// A waiting writer stops new readers from entering, so writers can't be starved by a stream of readers.
+	// Can be used with std::lock_guard, std::unique_lock, and std::shared_lock.
+	class ReadWriteLock
+	{
+	public:
+		ReadWriteLock() = default;
+		ReadWriteLock(const ReadWriteLock&) = delete;
+		ReadWriteLock& operator=(const ReadWriteLock&) = delete;
+
+		// Exclusive access, for writing.
+		void lock();
+		bool try_lock();
+		void unlock();
+
+		// Shared access, for reading.
+		void lock_shared();
+		bool try_lock_shared();
+		void unlock_shared();
+
+	private:
+		static constexpr std::uint32_t WriterBit  = 1u << 31;
+		static constexpr std::uint32_t PendingBit = 1u << 30;
+		static constexpr std::uint32_t ReaderMask = PendingBit - 1;
+
+		// The number of readers, along with the writer and pending writer flags.
+		std::atomic<std::uint32_t> state = 0;
+	};
+
+	// Hints to the processor that the thread is busy-waiting.
+	void CpuRelax();
+}
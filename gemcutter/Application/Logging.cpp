@@ -1,47 +1,486 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Logging.h"
+#include "gemcutter/Application/BinaryLog.h"
+#include "gemcutter/Application/ConcurrentQueue.h"
+#include "gemcutter/Application/Lock.h"
 #include "gemcutter/Utilities/String.h"
 
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
-#include <Windows.h>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+	#include <Windows.h>
+#endif
 
 namespace
 {
+	// The number of messages a thread can queue before the background writer catches up.
+	constexpr unsigned QUEUE_CAPACITY = 1024;
+	// How often the background writer wakes up to write the queued messages.
+	constexpr auto WRITE_INTERVAL = std::chrono::milliseconds(10);
+
+	// Guards the files, and the console. Held by whichever thread is writing messages out.
+	std::mutex outputLock;
 	std::ofstream logOutput;
+	std::ofstream binaryOutput;
+	// Whether each site has been described in the binary log yet, by id.
+	std::vector<bool> binarySites;
+#ifdef _WIN32
 	HANDLE stdOutputHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+#endif
+
+	// Set once the background writer has shut down, during the program's exit.
+	std::atomic<bool> writerShutDown = false;
 
-	void PushMessage(std::string_view header, std::string_view message)
+	constexpr gem::ConsoleColor LEVEL_COLORS[] = {
+		gem::ConsoleColor::DarkGray,
+		gem::ConsoleColor::Gray,
+		gem::ConsoleColor::Yellow,
+		gem::ConsoleColor::Red
+	};
+
+	struct LogMessage
 	{
-		if (logOutput.is_open())
+		// Orders the messages logged by different threads.
+		std::uint64_t sequence = 0;
+		gem::LogLevel level = gem::LogLevel::Info;
+		gem::LogChannel channel = gem::LogChannel::General;
+		// Must be a string literal.
+		const char* header = "";
+		gem::ConsoleColor color = gem::ConsoleColor::Gray;
+		std::string text;
+
+		// Set for deferred messages. The text is only formatted from the arguments if it is needed.
+		const gem::LogSite* site = nullptr;
+		unsigned argsSize = 0;
+		std::byte args[gem::LOG_RECORD_SIZE];
+	};
+
+	LogMessage MakeMessage(gem::LogChannel channel, gem::LogLevel level, std::string text)
+	{
+		LogMessage message;
+		message.level = level;
+		message.channel = channel;
+		message.header = gem::GetLogHeader(level);
+		message.color = LEVEL_COLORS[static_cast<unsigned>(level)];
+		message.text = std::move(text);
+
+		return message;
+	}
+
+	bool HasConsole()
+	{
+#ifdef _WIN32
+		return stdOutputHandle != INVALID_HANDLE_VALUE;
+#else
+		return true;
+#endif
+	}
+
+	template<typename T>
+	void WriteBinary(const T& value)
+	{
+		binaryOutput.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	void WriteBinaryEntry(const LogMessage& message)
+	{
+		using gem::BinaryLogEntry;
+
+		if (!message.site)
 		{
-			logOutput << header << message << std::endl;
+			WriteBinary(BinaryLogEntry::Text);
+			WriteBinary(message.level);
+			WriteBinary(message.channel);
+			WriteBinary(static_cast<std::uint32_t>(message.text.size()));
+			binaryOutput.write(message.text.data(), message.text.size());
+			return;
 		}
 
-		if (stdOutputHandle != INVALID_HANDLE_VALUE)
+		const gem::LogSite& site = *message.site;
+		if (site.id >= binarySites.size())
+		{
+			binarySites.resize(site.id + 1, false);
+		}
+
+		if (!binarySites[site.id])
 		{
-			std::cout << header << message << std::endl;
+			const std::string_view format = site.format;
+			const std::string_view argTypes = site.argTypes;
+
+			WriteBinary(BinaryLogEntry::Site);
+			WriteBinary(site.id);
+			WriteBinary(site.level);
+			WriteBinary(site.channel);
+			WriteBinary(static_cast<std::uint16_t>(format.size()));
+			binaryOutput.write(format.data(), format.size());
+			WriteBinary(static_cast<std::uint8_t>(argTypes.size()));
+			binaryOutput.write(argTypes.data(), argTypes.size());
+
+			binarySites[site.id] = true;
 		}
 
+		WriteBinary(BinaryLogEntry::Record);
+		WriteBinary(site.id);
+		WriteBinary(static_cast<std::uint8_t>(message.argsSize));
+		binaryOutput.write(reinterpret_cast<const char*>(message.args), message.argsSize);
+	}
+
+	// Writes a batch of messages to the files and the console.
+	void WriteMessages(std::vector<LogMessage>& messages)
+	{
+		std::lock_guard guard(outputLock);
+
+		const bool needsText = logOutput.is_open() || HasConsole();
+
+		gem::ConsoleColor consoleColor = gem::ConsoleColor::Gray;
+		for (LogMessage& message : messages)
+		{
+			if (binaryOutput.is_open())
+			{
+				WriteBinaryEntry(message);
+			}
+
+			if (!needsText)
+			{
+				continue;
+			}
+
+			if (message.site)
+			{
+				message.text = gem::FormatLogRecord(message.site->format, message.site->argTypes, message.args, message.argsSize);
+			}
+
+			if (message.channel != gem::LogChannel::General)
+			{
+				message.text.insert(0, gem::FormatString("[%s] ", gem::GetLogChannelName(message.channel)));
+			}
+
+			if (logOutput.is_open())
+			{
+				logOutput << message.header << message.text << '\n';
+			}
+
+			if (HasConsole())
+			{
+				if (message.color != consoleColor)
+				{
+					// The text already buffered must be written in the previous color.
+					std::cout.flush();
+					gem::SetConsoleColor(message.color);
+					consoleColor = message.color;
+				}
+
+				std::cout << message.header << message.text << '\n';
+			}
+
 #if defined(_MSC_VER) && defined(_DEBUG)
-		OutputDebugString(header.data());
-		OutputDebugString(message.data());
-		OutputDebugString("\n");
+			OutputDebugString(message.header);
+			OutputDebugString(message.text.c_str());
+			OutputDebugString("\n");
 #endif
+		}
+
+		// A single flush for the whole batch.
+		std::cout.flush();
+		if (consoleColor != gem::ConsoleColor::Gray)
+		{
+			gem::ResetConsoleColor();
+		}
+
+		if (logOutput.is_open())
+		{
+			logOutput.flush();
+		}
+
+		if (binaryOutput.is_open())
+		{
+			binaryOutput.flush();
+		}
 	}
 
-	void PushMessage(std::string_view header, std::string_view message, gem::ConsoleColor color)
+	// Queues messages from any thread, and writes them out from a background thread.
+	class AsyncLogger
 	{
-		gem::SetConsoleColor(color);
-		PushMessage(header, message);
-		gem::ResetConsoleColor();
+	public:
+		AsyncLogger()
+			: writer(&AsyncLogger::WriterLoop, this)
+		{
+		}
+
+		~AsyncLogger()
+		{
+			// Anything logged from now on is written immediately by the calling thread.
+			writerShutDown = true;
+
+			{
+				std::lock_guard guard(wakeLock);
+				isRunning = false;
+			}
+			wakeCondition.notify_one();
+
+			// The writer empties the queues before exiting.
+			writer.join();
+		}
+
+		void Push(LogMessage&& message)
+		{
+			ThreadQueue& queue = GetThreadQueue();
+			message.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+
+			if (!queue.messages.TryPush(std::move(message)))
+			{
+				numDropped.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		void Flush()
+		{
+			const std::uint64_t target = nextSequence.load();
+
+			std::unique_lock guard(wakeLock);
+			wakeRequested = true;
+			wakeCondition.notify_one();
+
+			// Dropped messages will never be written, so they count as done.
+			flushedCondition.wait(guard, [&]() {
+				return numWritten + numDropped.load() >= target || !isRunning;
+			});
+		}
+
+		unsigned GetNumDropped() const
+		{
+			return numDropped.load();
+		}
+
+	private:
+		struct ThreadQueue
+		{
+			gem::SpscRingBuffer<LogMessage, QUEUE_CAPACITY> messages;
+			// Cleared when the thread exits, so that the queue can be reused by a new thread.
+			std::atomic<bool> inUse = true;
+		};
+
+		// Hands the thread's queue back to the logger when the thread exits.
+		struct ThreadQueueHandle
+		{
+			~ThreadQueueHandle()
+			{
+				if (queue)
+				{
+					queue->inUse.store(false, std::memory_order_release);
+				}
+			}
+
+			ThreadQueue* queue = nullptr;
+		};
+
+		ThreadQueue& GetThreadQueue()
+		{
+			thread_local ThreadQueueHandle handle;
+			if (handle.queue)
+			{
+				return *handle.queue;
+			}
+
+			std::lock_guard guard(queuesLock);
+
+			for (auto& queue : queues)
+			{
+				if (!queue->inUse.load(std::memory_order_acquire))
+				{
+					queue->inUse = true;
+					handle.queue = queue.get();
+					return *handle.queue;
+				}
+			}
+
+			handle.queue = queues.emplace_back(std::make_unique<ThreadQueue>()).get();
+			return *handle.queue;
+		}
+
+		void WriterLoop()
+		{
+			std::vector<LogMessage> batch;
+			bool running = true;
+			while (running)
+			{
+				{
+					std::unique_lock guard(wakeLock);
+					wakeCondition.wait_for(guard, WRITE_INTERVAL, [this]() { return wakeRequested || !isRunning; });
+					wakeRequested = false;
+					running = isRunning;
+				}
+
+				WriteQueuedMessages(batch);
+			}
+
+			flushedCondition.notify_all();
+		}
+
+		void WriteQueuedMessages(std::vector<LogMessage>& batch)
+		{
+			{
+				std::lock_guard guard(queuesLock);
+
+				LogMessage message;
+				for (auto& queue : queues)
+				{
+					while (queue->messages.TryPop(message))
+					{
+						batch.push_back(std::move(message));
+					}
+				}
+			}
+
+			const unsigned numMessages = batch.size();
+			std::sort(batch.begin(), batch.end(), [](const LogMessage& a, const LogMessage& b) {
+				return a.sequence < b.sequence;
+			});
+
+			const unsigned dropped = numDropped.load();
+			if (dropped != numDroppedReported)
+			{
+				batch.push_back(MakeMessage(gem::LogChannel::General, gem::LogLevel::Warning,
+					gem::FormatString("%u log messages were dropped because they were logged faster than they could be written.", dropped - numDroppedReported)));
+
+				numDroppedReported = dropped;
+			}
+
+			if (!batch.empty())
+			{
+				WriteMessages(batch);
+				batch.clear();
+			}
+
+			{
+				std::lock_guard guard(wakeLock);
+				numWritten += numMessages;
+			}
+			flushedCondition.notify_all();
+		}
+
+		std::atomic<std::uint64_t> nextSequence = 0;
+		std::atomic<unsigned> numDropped = 0;
+
+		// Guards the list of queues, and the reading side of each queue.
+		gem::SpinLock queuesLock;
+		std::vector<std::unique_ptr<ThreadQueue>> queues;
+
+		// Guards the variables below, which control the writer.
+		std::mutex wakeLock;
+		std::condition_variable wakeCondition;
+		std::condition_variable flushedCondition;
+		bool wakeRequested = false;
+		bool isRunning = true;
+		std::uint64_t numWritten = 0;
+
+		// Only used by the writer.
+		unsigned numDroppedReported = 0;
+
+		// Declared last, so that it starts once everything else is ready.
+		std::thread writer;
+	};
+
+	AsyncLogger& GetLogger()
+	{
+		static AsyncLogger logger;
+		return logger;
+	}
+
+	void PushMessage(LogMessage&& message)
+	{
+		if (writerShutDown)
+		{
+			std::vector<LogMessage> batch;
+			batch.push_back(std::move(message));
+			WriteMessages(batch);
+			return;
+		}
+
+		GetLogger().Push(std::move(message));
+	}
+
+	void PushMessage(gem::LogChannel channel, gem::LogLevel level, std::string text)
+	{
+		PushMessage(MakeMessage(channel, level, std::move(text)));
+	}
+
+	void PushMessage(gem::LogLevel level, std::string text)
+	{
+		PushMessage(MakeMessage(gem::LogChannel::General, level, std::move(text)));
 	}
 }
 
 namespace gem
 {
+	namespace detail
+	{
+		// Starts at the lowest level, which leaves MIN_LOG_LEVEL as the effective threshold.
+		std::atomic<LogLevel> logLevels[static_cast<unsigned>(LogChannel::Count)] = {};
+	}
+
+	void SetLogLevel(LogChannel channel, LogLevel level)
+	{
+		ASSERT(channel < LogChannel::Count, "'channel' is not a valid channel.");
+
+		detail::logLevels[static_cast<unsigned>(channel)] = level;
+	}
+
+	void SetLogLevel(LogLevel level)
+	{
+		for (auto& channelLevel : detail::logLevels)
+		{
+			channelLevel = level;
+		}
+	}
+
+	LogLevel GetLogLevel(LogChannel channel)
+	{
+		ASSERT(channel < LogChannel::Count, "'channel' is not a valid channel.");
+
+		return std::max(detail::logLevels[static_cast<unsigned>(channel)].load(), MIN_LOG_LEVEL);
+	}
+
+	const char* GetLogHeader(LogLevel level)
+	{
+		switch (level)
+		{
+		case LogLevel::Debug: return "Debug:   ";
+		case LogLevel::Warning: return "WARNING: ";
+		case LogLevel::Error: return "ERROR:   ";
+		default: return "Log:     ";
+		}
+	}
+
+	const char* GetLogChannelName(LogChannel channel)
+	{
+		switch (channel)
+		{
+		case LogChannel::Application: return "Application";
+		case LogChannel::ECS: return "ECS";
+		case LogChannel::Input: return "Input";
+		case LogChannel::Network: return "Network";
+		case LogChannel::Render: return "Render";
+		case LogChannel::Resource: return "Resource";
+		case LogChannel::Sound: return "Sound";
+		default: return "General";
+		}
+	}
+
 	void OpenOutputLog()
 	{
+		std::lock_guard guard(outputLock);
 		if (!logOutput.is_open())
 		{
 			logOutput.open("Log_Output.txt", std::ofstream::app);
@@ -50,14 +489,72 @@ namespace gem
 
 	void CloseOutputLog()
 	{
+		FlushLog();
+
+		std::lock_guard guard(outputLock);
 		if (logOutput.is_open())
 		{
 			logOutput.close();
 		}
 	}
 
+	void OpenBinaryLog()
+	{
+		std::lock_guard guard(outputLock);
+		if (!binaryOutput.is_open())
+		{
+			binaryOutput.open("Log_Output.bin", std::ofstream::binary | std::ofstream::trunc);
+			binaryOutput.write(BINARY_LOG_SIGNATURE, sizeof(BINARY_LOG_SIGNATURE));
+			binarySites.clear();
+		}
+	}
+
+	void CloseBinaryLog()
+	{
+		FlushLog();
+
+		std::lock_guard guard(outputLock);
+		if (binaryOutput.is_open())
+		{
+			binaryOutput.close();
+		}
+	}
+
+	void PushLogRecord(const LogSite& site, const std::byte* args, unsigned size)
+	{
+		ASSERT(size <= LOG_RECORD_SIZE, "The arguments don't fit in a log record.");
+
+		LogMessage message;
+		message.level = site.level;
+		message.channel = site.channel;
+		message.header = GetLogHeader(site.level);
+		message.color = LEVEL_COLORS[static_cast<unsigned>(site.level)];
+		message.site = &site;
+		message.argsSize = size;
+		std::memcpy(message.args, args, size);
+
+		PushMessage(std::move(message));
+	}
+
+	void FlushLog()
+	{
+		if (!writerShutDown)
+		{
+			GetLogger().Flush();
+		}
+	}
+
+	unsigned GetNumDroppedLogMessages()
+	{
+		return writerShutDown ? 0 : GetLogger().GetNumDropped();
+	}
+
 	void CreateConsoleWindow()
 	{
+#ifdef _WIN32
+		FlushLog();
+
+		std::lock_guard guard(outputLock);
 		if (GetConsoleWindow() != NULL)
 		{
 			return;
@@ -68,10 +565,15 @@ namespace gem
 		freopen("CONOUT$", "w", stdout);
 		freopen("CONIN$", "r", stdin);
 		stdOutputHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+#endif
 	}
 
 	void DestroyConsoleWindow()
 	{
+#ifdef _WIN32
+		FlushLog();
+
+		std::lock_guard guard(outputLock);
 		if (GetConsoleWindow() == NULL)
 		{
 			return;
@@ -83,72 +585,154 @@ namespace gem
 
 		// There might still be an output stream so we try to obtain a new handle just in case.
 		stdOutputHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+#endif
 	}
 
 	void FocusConsoleWindow()
 	{
+#ifdef _WIN32
 		SetForegroundWindow(GetConsoleWindow());
+#endif
 	}
 
-	void SetConsoleColor(ConsoleColor color)
+	void SetConsoleColor([[maybe_unused]] ConsoleColor color)
 	{
+#ifdef _WIN32
 		if (stdOutputHandle != INVALID_HANDLE_VALUE)
 		{
 			SetConsoleTextAttribute(stdOutputHandle, static_cast<WORD>(color));
 		}
+#endif
 	}
 
 	void ResetConsoleColor()
 	{
+#ifdef _WIN32
 		if (stdOutputHandle != INVALID_HANDLE_VALUE)
 		{
 			SetConsoleTextAttribute(stdOutputHandle, static_cast<WORD>(ConsoleColor::Gray));
 		}
+#endif
 	}
 
 	void Log(const char* format, ...)
 	{
+		if (!IsLogEnabled(LogChannel::General, LogLevel::Info))
+		{
+			return;
+		}
+
 		va_list argptr;
 		va_start(argptr, format);
 		auto message = FormatString(format, argptr);
 		va_end(argptr);
 
-		PushMessage("Log:     ", message);
+		PushMessage(LogLevel::Info, std::move(message));
 	}
 
 	void Log(std::string_view message)
 	{
-		PushMessage("Log:     ", message);
+		if (!IsLogEnabled(LogChannel::General, LogLevel::Info))
+		{
+			return;
+		}
+
+		PushMessage(LogLevel::Info, std::string(message));
+	}
+
+	void Log(LogChannel channel, const char* format, ...)
+	{
+		if (!IsLogEnabled(channel, LogLevel::Info))
+		{
+			return;
+		}
+
+		va_list argptr;
+		va_start(argptr, format);
+		auto message = FormatString(format, argptr);
+		va_end(argptr);
+
+		PushMessage(channel, LogLevel::Info, std::move(message));
 	}
 
 	void Error(const char* format, ...)
 	{
+		if (!IsLogEnabled(LogChannel::General, LogLevel::Error))
+		{
+			return;
+		}
+
 		va_list argptr;
 		va_start(argptr, format);
 		auto message = FormatString(format, argptr);
 		va_end(argptr);
 
-		PushMessage("ERROR:   ", message, ConsoleColor::Red);
+		PushMessage(LogLevel::Error, std::move(message));
 	}
 
 	void Error(std::string_view message)
 	{
-		PushMessage("ERROR:   ", message, ConsoleColor::Red);
+		if (!IsLogEnabled(LogChannel::General, LogLevel::Error))
+		{
+			return;
+		}
+
+		PushMessage(LogLevel::Error, std::string(message));
+	}
+
+	void Error(LogChannel channel, const char* format, ...)
+	{
+		if (!IsLogEnabled(channel, LogLevel::Error))
+		{
+			return;
+		}
+
+		va_list argptr;
+		va_start(argptr, format);
+		auto message = FormatString(format, argptr);
+		va_end(argptr);
+
+		PushMessage(channel, LogLevel::Error, std::move(message));
 	}
 
 	void Warning(const char* format, ...)
 	{
+		if (!IsLogEnabled(LogChannel::General, LogLevel::Warning))
+		{
+			return;
+		}
+
 		va_list argptr;
 		va_start(argptr, format);
 		auto message = FormatString(format, argptr);
 		va_end(argptr);
 
-		PushMessage("WARNING: ", message, ConsoleColor::Yellow);
+		PushMessage(LogLevel::Warning, std::move(message));
 	}
 
 	void Warning(std::string_view message)
 	{
-		PushMessage("WARNING: ", message, ConsoleColor::Yellow);
+		if (!IsLogEnabled(LogChannel::General, LogLevel::Warning))
+		{
+			return;
+		}
+
+		PushMessage(LogLevel::Warning, std::string(message));
+	}
+
+	void Warning(LogChannel channel, const char* format, ...)
+	{
+		if (!IsLogEnabled(channel, LogLevel::Warning))
+		{
+			return;
+		}
+
+		va_list argptr;
+		va_start(argptr, format);
+		auto message = FormatString(format, argptr);
+		va_end(argptr);
+
+		PushMessage(channel, LogLevel::Warning, std::move(message));
 	}
 
 	void ErrorBox(const char* format, ...)
@@ -158,14 +742,16 @@ namespace gem
 		auto message = FormatString(format, argptr);
 		va_end(argptr);
 
-		PushMessage("ERROR:   ", message, ConsoleColor::Red);
-		MessageBox(HWND_DESKTOP, message.c_str(), "Error", MB_ICONERROR);
+		ErrorBox(message);
 	}
 
 	void ErrorBox(std::string_view message)
 	{
-		PushMessage("ERROR:   ", message, ConsoleColor::Red);
-		MessageBox(HWND_DESKTOP, message.data(), "Error", MB_ICONERROR);
+		PushMessage(LogLevel::Error, std::string(message));
+		FlushLog();
+#ifdef _WIN32
+		MessageBox(HWND_DESKTOP, std::string(message).c_str(), "Error", MB_ICONERROR);
+#endif
 	}
 
 	void WarningBox(const char* format, ...)
@@ -175,14 +761,16 @@ namespace gem
 		auto message = FormatString(format, argptr);
 		va_end(argptr);
 
-		PushMessage("WARNING: ", message, ConsoleColor::Yellow);
-		MessageBox(HWND_DESKTOP, message.c_str(), "Warning", MB_ICONWARNING);
+		WarningBox(message);
 	}
 
 	void WarningBox(std::string_view message)
 	{
-		PushMessage("WARNING: ", message, ConsoleColor::Yellow);
-		MessageBox(HWND_DESKTOP, message.data(), "Warning", MB_ICONWARNING);
+		PushMessage(LogLevel::Warning, std::string(message));
+		FlushLog();
+#ifdef _WIN32
+		MessageBox(HWND_DESKTOP, std::string(message).c_str(), "Warning", MB_ICONWARNING);
+#endif
 	}
 
 	void Assert(const char* exp, const char* format, ...)
@@ -192,7 +780,11 @@ namespace gem
 		auto message = FormatString(format, argptr);
 		va_end(argptr);
 
-		auto header = FormatString("ASSERT:  ( %s )\n", exp);
-		PushMessage(header, message, ConsoleColor::Pink);
+		// The program is likely about to stop, so the message is written out before returning.
+		LogMessage assertMessage = MakeMessage(LogChannel::General, LogLevel::Error, FormatString("ASSERT:  ( %s )\n", exp) + message);
+		assertMessage.header = "";
+		assertMessage.color = ConsoleColor::Pink;
+		PushMessage(std::move(assertMessage));
+		FlushLog();
 	}
 }
@@ -1,5 +1,7 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <string_view>
 
 /*
@@ -9,6 +11,18 @@
  Console output can be toggled as well with CreateConsoleWindow() and DestroyConsoleWindow().
  DEBUG_* macros allow you to log only when in debug mode.
 
+ Messages belong to a channel, such as LogChannel::Render, and have a level. Each channel has a level
+ threshold which can be changed at runtime with SetLogLevel(). Messages below the threshold are discarded
+ before they are formatted. Messages without a channel belong to LogChannel::General.
+ Deferred messages below GEM_MIN_LOG_LEVEL are compiled out entirely (see BinaryLog.h). It can be defined
+ as the name of a level, such as "-DGEM_MIN_LOG_LEVEL=Warning", and defaults to Debug in debug builds and
+ Info otherwise. Channels start with GEM_MIN_LOG_LEVEL as their threshold.
+
+ Messages are written out by a background thread, so logging never waits on the file or the console.
+ Each thread queues its messages in its own lock-free buffer. If a thread logs faster than the messages
+ can be written, the buffer fills up and further messages are dropped and counted, rather than blocking.
+ Asserts and message boxes flush the log before returning, so that nothing is lost if the program stops.
+
  To force macros off, define GEM_DISABLE_DEBUG_MESSAGES.
 */
 
@@ -33,9 +47,68 @@ namespace gem
 		White
 	};
 
+	enum class LogLevel : std::uint8_t
+	{
+		Debug,
+		Info,
+		Warning,
+		Error
+	};
+
+	enum class LogChannel : std::uint8_t
+	{
+		General,
+		Application,
+		ECS,
+		Input,
+		Network,
+		Render,
+		Resource,
+		Sound,
+
+		Count
+	};
+
+#ifndef GEM_MIN_LOG_LEVEL
+	#ifdef _DEBUG
+		#define GEM_MIN_LOG_LEVEL Debug
+	#else
+		#define GEM_MIN_LOG_LEVEL Info
+	#endif
+#endif
+
+	constexpr LogLevel MIN_LOG_LEVEL = LogLevel::GEM_MIN_LOG_LEVEL;
+
+	namespace detail
+	{
+		extern std::atomic<LogLevel> logLevels[static_cast<unsigned>(LogChannel::Count)];
+	}
+
+	// Messages of the channel below the level will be discarded.
+	void SetLogLevel(LogChannel channel, LogLevel level);
+	// Sets the level of every channel.
+	void SetLogLevel(LogLevel level);
+	LogLevel GetLogLevel(LogChannel channel);
+
+	// Returns true if messages of the level are currently logged for the channel.
+	inline bool IsLogEnabled(LogChannel channel, LogLevel level)
+	{
+		return level >= MIN_LOG_LEVEL &&
+			level >= detail::logLevels[static_cast<unsigned>(channel)].load(std::memory_order_relaxed);
+	}
+
+	// The text written before each message of the level, such as "WARNING: ".
+	const char* GetLogHeader(LogLevel level);
+	const char* GetLogChannelName(LogChannel channel);
+
 	void OpenOutputLog();
 	void CloseOutputLog();
 
+	// Blocks until every message logged so far has been written out.
+	void FlushLog();
+	// Returns the number of messages which were dropped because their thread's buffer was full.
+	unsigned GetNumDroppedLogMessages();
+
 	void CreateConsoleWindow();
 	void DestroyConsoleWindow();
 	void FocusConsoleWindow();
@@ -44,10 +117,13 @@ namespace gem
 
 	void Log(const char* format, ...);
 	void Log(std::string_view message);
+	void Log(LogChannel channel, const char* format, ...);
 	void Error(const char* format, ...);
 	void Error(std::string_view message);
+	void Error(LogChannel channel, const char* format, ...);
 	void Warning(const char* format, ...);
 	void Warning(std::string_view message);
+	void Warning(LogChannel channel, const char* format, ...);
 	void ErrorBox(const char* format, ...);
 	void ErrorBox(std::string_view message);
 	void WarningBox(const char* format, ...);
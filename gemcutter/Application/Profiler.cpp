@@ -0,0 +1,189 @@
+// Copyright (c) 2022 Emilian Cioca
+#include "Profiler.h"
+#include "gemcutter/Application/Logging.h"
+#include "gemcutter/Application/Timer.h"
+
+#include <fstream>
+#include <mutex>
+
+namespace
+{
+	// Hands the thread's buffer back to the profiler when the thread exits.
+	struct ThreadBufferHandle
+	{
+		~ThreadBufferHandle()
+		{
+			if (inUse)
+			{
+				inUse->store(false, std::memory_order_release);
+			}
+		}
+
+		void* buffer = nullptr;
+		std::atomic<bool>* inUse = nullptr;
+	};
+
+	thread_local ThreadBufferHandle threadBuffer;
+
+	void WriteEscaped(std::ostream& output, const char* str)
+	{
+		for (; *str != '\0'; ++str)
+		{
+			if (*str == '"' || *str == '\\')
+			{
+				output << '\\';
+			}
+
+			output << *str;
+		}
+	}
+}
+
+namespace gem
+{
+	ProfilerSingleton Profiler;
+
+	void ProfilerSingleton::BeginCapture()
+	{
+		std::lock_guard guard(lock);
+
+		// Discard anything left over from before the capture.
+		ProfileSample sample;
+		for (auto& buffer : threadBuffers)
+		{
+			while (buffer->samples.TryPop(sample)) {}
+		}
+
+		capture.clear();
+		numDropped = 0;
+		captureStart = Timer::GetCurrentTick();
+		isCapturing = true;
+	}
+
+	void ProfilerSingleton::EndCapture()
+	{
+		isCapturing = false;
+		Collect();
+	}
+
+	bool ProfilerSingleton::IsCapturing() const
+	{
+		return isCapturing.load(std::memory_order_relaxed);
+	}
+
+	void ProfilerSingleton::Collect()
+	{
+		std::lock_guard guard(lock);
+
+		ProfileSample sample;
+		for (auto& buffer : threadBuffers)
+		{
+			while (buffer->samples.TryPop(sample))
+			{
+				capture.push_back(sample);
+			}
+		}
+	}
+
+	const std::vector<ProfileSample>& ProfilerSingleton::GetCapture() const
+	{
+		return capture;
+	}
+
+	unsigned ProfilerSingleton::GetNumDropped() const
+	{
+		return numDropped.load();
+	}
+
+	bool ProfilerSingleton::ExportChromeTrace(const std::string& filePath) const
+	{
+		std::ofstream output(filePath);
+		if (!output)
+		{
+			Error("Profiler: Could not open \"%s\" for writing.", filePath.c_str());
+			return false;
+		}
+
+		// Chrome expects timestamps in microseconds.
+		const double ticksPerMicrosecond = static_cast<double>(Timer::GetTicksPerSecond()) / 1000000.0;
+
+		output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		for (unsigned i = 0; i < capture.size(); ++i)
+		{
+			const ProfileSample& sample = capture[i];
+			if (i > 0)
+			{
+				output << ',';
+			}
+
+			output << "\n{\"name\":\"";
+			WriteEscaped(output, sample.name);
+			output << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << sample.threadId
+				<< ",\"ts\":" << (sample.start - captureStart) / ticksPerMicrosecond
+				<< ",\"dur\":" << (sample.end - sample.start) / ticksPerMicrosecond << '}';
+		}
+		output << "\n]}\n";
+
+		return static_cast<bool>(output);
+	}
+
+	void ProfilerSingleton::Record(const char* name, std::int64_t start, std::int64_t end)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+		if (!buffer.samples.TryPush(ProfileSample{ name, start, end, buffer.threadId }))
+		{
+			numDropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	ProfilerSingleton::ThreadBuffer& ProfilerSingleton::GetThreadBuffer()
+	{
+		if (threadBuffer.buffer)
+		{
+			return *static_cast<ThreadBuffer*>(threadBuffer.buffer);
+		}
+
+		std::lock_guard guard(lock);
+
+		// Threads come and go with the job system, so we reuse the buffers of threads which have exited.
+		ThreadBuffer* buffer = nullptr;
+		for (auto& existing : threadBuffers)
+		{
+			if (!existing->inUse.load(std::memory_order_acquire))
+			{
+				buffer = existing.get();
+				buffer->inUse = true;
+				break;
+			}
+		}
+
+		if (!buffer)
+		{
+			auto& newBuffer = threadBuffers.emplace_back(std::make_unique<ThreadBuffer>());
+			newBuffer->threadId = threadBuffers.size() - 1;
+			buffer = newBuffer.get();
+		}
+
+		threadBuffer.buffer = buffer;
+		threadBuffer.inUse = &buffer->inUse;
+
+		return *buffer;
+	}
+
+	ProfileScope::ProfileScope(const char* _name)
+		: name(_name)
+	{
+		if (Profiler.IsCapturing())
+		{
+			start = Timer::GetCurrentTick();
+		}
+	}
+
+	ProfileScope::~ProfileScope()
+	{
+		if (start != 0 && Profiler.IsCapturing())
+		{
+			Profiler.Record(name, start, Timer::GetCurrentTick());
+		}
+	}
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2022 Emilian Cioca
+#pragma once
+#include "gemcutter/Application/ConcurrentQueue.h"
+#include "gemcutter/Application/Lock.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ This file defines scoped markers for CPU profiling.
+
+ GEM_PROFILE_SCOPE("Name") measures the rest of the enclosing scope, on whichever thread runs it.
+ Markers are only recorded while a capture is active. Otherwise they cost a single flag check.
+ Markers nested within each other are shown nested in the exported trace.
+
+ Each thread records into its own lock-free ring buffer. Collect() moves the recorded markers into the
+ capture, and is called by the game-loop once per frame. A capture can be exported to the Chrome trace
+ format, which can be opened with chrome://tracing or https://ui.perfetto.dev.
+
+ To compile the markers out, define GEM_DISABLE_PROFILING.
+*/
+
+namespace gem
+{
+	// A single completed marker.
+	struct ProfileSample
+	{
+		// Must be a string literal, or otherwise outlive the capture.
+		const char* name = nullptr;
+		// Timer ticks.
+		std::int64_t start = 0;
+		std::int64_t end = 0;
+		// Identifies the thread which recorded the marker, in the order that threads first recorded one.
+		unsigned threadId = 0;
+	};
+
+	// Owns the per-thread buffers and the current capture.
+	extern class ProfilerSingleton Profiler;
+	class ProfilerSingleton
+	{
+		friend class ProfileScope;
+	public:
+		// The number of markers a thread can record between calls to Collect().
+		static constexpr unsigned BUFFER_CAPACITY = 4096;
+
+		// Discards the previous capture and starts recording.
+		void BeginCapture();
+		// Stops recording, and collects any markers which are still buffered.
+		void EndCapture();
+		bool IsCapturing() const;
+
+		// Moves the markers recorded by all threads into the capture.
+		void Collect();
+
+		// The collected markers. Should only be inspected once the capture has ended.
+		const std::vector<ProfileSample>& GetCapture() const;
+
+		// Returns the number of markers lost because a thread's buffer was full.
+		unsigned GetNumDropped() const;
+
+		// Writes the capture to a file in the Chrome trace event format.
+		bool ExportChromeTrace(const std::string& filePath) const;
+
+	private:
+		struct ThreadBuffer
+		{
+			SpscRingBuffer<ProfileSample, BUFFER_CAPACITY> samples;
+			unsigned threadId = 0;
+			// Cleared when the thread exits, so that the buffer can be reused by a new thread.
+			std::atomic<bool> inUse = true;
+		};
+
+		void Record(const char* name, std::int64_t start, std::int64_t end);
+		ThreadBuffer& GetThreadBuffer();
+
+		std::atomic<bool> isCapturing = false;
+		std::atomic<unsigned> numDropped = 0;
+
+		// Guards the list of buffers, and the reading side of each buffer.
+		SpinLock lock;
+		std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+
+		std::vector<ProfileSample> capture;
+		std::int64_t captureStart = 0;
+	};
+
+	// Records the time between its construction and destruction. Used through GEM_PROFILE_SCOPE().
+	class ProfileScope
+	{
+	public:
+		explicit ProfileScope(const char* name);
+		ProfileScope(const ProfileScope&) = delete;
+		~ProfileScope();
+
+		ProfileScope& operator=(const ProfileScope&) = delete;
+
+	private:
+		const char* name;
+		// Left as zero if the profiler wasn't capturing when the scope began.
+		std::int64_t start = 0;
+	};
+}
+
+#ifndef GEM_DISABLE_PROFILING
+	#define GEM_PROFILE_CONCAT_IMPL(a, b) a##b
+	#define GEM_PROFILE_CONCAT(a, b) GEM_PROFILE_CONCAT_IMPL(a, b)
+	#define GEM_PROFILE_SCOPE(name) gem::ProfileScope GEM_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+	#define GEM_PROFILE_SCOPE(name) do {} while (false)
+#endif
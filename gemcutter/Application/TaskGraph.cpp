@@ -0,0 +1,112 @@
+// Copyright (c) 2022 Emilian Cioca
+#include "TaskGraph.h"
+
+namespace gem
+{
+	TaskGraph::TaskId TaskGraph::Add(std::function<void()> func, JobAffinity affinity)
+	{
+		ASSERT(func, "'func' cannot be null.");
+
+		tasks.push_back({ std::move(func), affinity });
+
+		return tasks.size() - 1;
+	}
+
+	void TaskGraph::AddDependency(TaskId task, TaskId dependency)
+	{
+		ASSERT(task < tasks.size(), "Invalid 'task'.");
+		ASSERT(dependency < tasks.size(), "Invalid 'dependency'.");
+		ASSERT(task != dependency, "A task cannot depend on itself.");
+
+		tasks[dependency].dependents.push_back(task);
+		tasks[task].numDependencies++;
+	}
+
+	void TaskGraph::Run()
+	{
+		ASSERT(IsAcyclic(), "TaskGraph contains a dependency cycle.");
+
+		if (remainingSize < tasks.size())
+		{
+			remaining = std::make_unique<std::atomic<unsigned>[]>(tasks.size());
+			remainingSize = tasks.size();
+		}
+
+		for (unsigned i = 0; i < tasks.size(); ++i)
+		{
+			remaining[i].store(tasks[i].numDependencies, std::memory_order_relaxed);
+		}
+
+		// Dependents are scheduled by the last of their dependencies to finish. Since a task schedules
+		// its dependents before it is released from the counter, the counter can't reach zero early.
+		JobCounter counter;
+		for (unsigned i = 0; i < tasks.size(); ++i)
+		{
+			if (tasks[i].numDependencies == 0)
+			{
+				Schedule(i, counter);
+			}
+		}
+
+		JobSystem.Wait(counter);
+	}
+
+	void TaskGraph::Clear()
+	{
+		tasks.clear();
+	}
+
+	unsigned TaskGraph::GetNumTasks() const
+	{
+		return tasks.size();
+	}
+
+	bool TaskGraph::IsAcyclic() const
+	{
+		// Kahn's algorithm. Every task can be visited only if there are no cycles.
+		std::vector<unsigned> numDependencies(tasks.size());
+		std::vector<TaskId> ready;
+		for (unsigned i = 0; i < tasks.size(); ++i)
+		{
+			numDependencies[i] = tasks[i].numDependencies;
+			if (numDependencies[i] == 0)
+			{
+				ready.push_back(i);
+			}
+		}
+
+		unsigned numVisited = 0;
+		while (!ready.empty())
+		{
+			const TaskId id = ready.back();
+			ready.pop_back();
+			numVisited++;
+
+			for (TaskId dependent : tasks[id].dependents)
+			{
+				if (--numDependencies[dependent] == 0)
+				{
+					ready.push_back(dependent);
+				}
+			}
+		}
+
+		return numVisited == tasks.size();
+	}
+
+	void TaskGraph::Schedule(TaskId id, JobCounter& counter)
+	{
+		JobSystem.Run([this, id, &counter]() {
+			const Task& task = tasks[id];
+			task.func();
+
+			for (TaskId dependent : task.dependents)
+			{
+				if (remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					Schedule(dependent, counter);
+				}
+			}
+		}, &counter, tasks[id].affinity);
+	}
+}
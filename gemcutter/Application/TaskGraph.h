@@ -0,0 +1,64 @@
+// Copyright (c) 2022 Emilian Cioca
+#pragma once
+#include "gemcutter/Application/Threading.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace gem
+{
+	// A set of tasks with explicit dependencies, built once and then run as often as needed, such as every frame.
+	// Each task starts as soon as all of the tasks it depends on have finished, so independent branches
+	// of the graph run concurrently on the JobSystem.
+	//	TaskGraph frame;
+	//	auto transforms = frame.Add(UpdateTransforms);
+	//	auto culling    = frame.Add(Cull);
+	//	auto drawList   = frame.Add(BuildDrawList);
+	//	auto upload     = frame.Add(Upload, JobAffinity::MainThread);
+	//	frame.AddDependency(culling, transforms);
+	//	frame.AddDependency(drawList, culling);
+	//	frame.AddDependency(upload, drawList);
+	//	frame.Run();
+	class TaskGraph
+	{
+	public:
+		using TaskId = unsigned;
+
+		// Adds a task to the graph and returns its identifier.
+		TaskId Add(std::function<void()> func, JobAffinity affinity = JobAffinity::AnyThread);
+
+		// Prevents 'task' from starting until 'dependency' has finished.
+		void AddDependency(TaskId task, TaskId dependency);
+
+		// Runs every task once, and returns when they have all finished.
+		// Must be called from the main thread if any of the tasks have main thread affinity.
+		void Run();
+
+		// Removes all tasks.
+		void Clear();
+
+		unsigned GetNumTasks() const;
+
+		// Returns false if the dependencies form a cycle, in which case the graph can't be run.
+		bool IsAcyclic() const;
+
+	private:
+		struct Task
+		{
+			std::function<void()> func;
+			JobAffinity affinity;
+			// The tasks which depend on this one.
+			std::vector<TaskId> dependents;
+			unsigned numDependencies = 0;
+		};
+
+		void Schedule(TaskId id, JobCounter& counter);
+
+		std::vector<Task> tasks;
+		// The number of dependencies each task is still waiting on during a run.
+		std::unique_ptr<std::atomic<unsigned>[]> remaining;
+		unsigned remainingSize = 0;
+	};
+}
@@ -1,70 +1,431 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Threading.h"
 
+#include <algorithm>
+
+namespace
+{
+	// The number of times Wait() yields without finding a job before it goes to sleep.
+	constexpr unsigned NUM_WAIT_SPINS = 64;
+
+	// The index of the worker running on this thread, or -1 if this thread isn't part of the pool.
+	thread_local int workerIndex = -1;
+}
+
 namespace gem
 {
-	Mutex::~Mutex()
+	JobSystemSingleton JobSystem;
+
+	JobCounter::~JobCounter()
+	{
+		// The last job might still be releasing the lock after having brought the count to zero.
+		std::lock_guard guard(lock);
+		ASSERT(count.load() == 0, "JobCounter destroyed while jobs are still running.");
+	}
+
+	bool JobCounter::IsDone() const
+	{
+		return count.load(std::memory_order_acquire) == 0;
+	}
+
+	JobSystemSingleton::JobSystemSingleton()
+		: mainThreadId(std::this_thread::get_id())
+	{
+	}
+
+	JobSystemSingleton::~JobSystemSingleton()
+	{
+		if (IsRunning())
+		{
+			Stop();
+		}
+	}
+
+	void JobSystemSingleton::Start(unsigned numWorkers)
+	{
+		ASSERT(!IsRunning(), "JobSystem is already running.");
+
+		if (numWorkers == 0)
+		{
+			numWorkers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+		}
+
+		mainThreadId = std::this_thread::get_id();
+
+		queues.reserve(numWorkers);
+		for (unsigned i = 0; i < numWorkers; ++i)
+		{
+			queues.push_back(std::make_unique<WorkerQueue>());
+		}
+
+		isRunning = true;
+
+		workers.reserve(numWorkers);
+		for (unsigned i = 0; i < numWorkers; ++i)
+		{
+			workers.emplace_back(&JobSystemSingleton::WorkerLoop, this, i);
+		}
+	}
+
+	void JobSystemSingleton::Stop()
+	{
+		ASSERT(IsRunning(), "JobSystem is not running.");
+		ASSERT(IsMainThread(), "JobSystem must be stopped from the main thread.");
+
+		{
+			std::lock_guard guard(sleepLock);
+			isRunning = false;
+		}
+		wakeCondition.notify_all();
+
+		// The workers empty their queues before exiting.
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+
+		workers.clear();
+		queues.clear();
+
+		ProcessMainThreadJobs();
+	}
+
+	bool JobSystemSingleton::IsRunning() const
+	{
+		return isRunning.load();
+	}
+
+	unsigned JobSystemSingleton::GetNumWorkers() const
+	{
+		return workers.size();
+	}
+
+	bool JobSystemSingleton::IsMainThread() const
+	{
+		return std::this_thread::get_id() == mainThreadId;
+	}
+
+	void JobSystemSingleton::Run(JobFunction job, JobCounter* counter, JobAffinity affinity)
+	{
+		ASSERT(job, "'job' cannot be null.");
+
+		if (counter)
+		{
+			counter->count.fetch_add(1);
+		}
+
+		Schedule({ std::move(job), counter, affinity });
+	}
+
+	void JobSystemSingleton::RunAfter(JobCounter& dependency, JobFunction job, JobCounter* counter, JobAffinity affinity)
+	{
+		ASSERT(job, "'job' cannot be null.");
+		ASSERT(&dependency != counter, "A job cannot depend on its own counter.");
+
+		if (counter)
+		{
+			counter->count.fetch_add(1);
+		}
+
+		{
+			std::lock_guard guard(dependency.lock);
+			if (dependency.count.load() != 0)
+			{
+				dependency.dependents.push_back({ std::move(job), counter, affinity });
+				return;
+			}
+		}
+
+		Schedule({ std::move(job), counter, affinity });
+	}
+
+	void JobSystemSingleton::Wait(JobCounter& counter)
 	{
-		if (mutex != NULL)
+		detail::Job job;
+		unsigned numSpins = 0;
+		while (!counter.IsDone())
 		{
-			CloseHandle(mutex);
+			if (TryTakeJob(job))
+			{
+				Execute(job);
+				numSpins = 0;
+			}
+			else if (numSpins < NUM_WAIT_SPINS)
+			{
+				std::this_thread::yield();
+				++numSpins;
+			}
+			else
+			{
+				// Registering before checking again means that a job scheduled, or a counter released, after the check can't be missed.
+				numWaiting.fetch_add(1);
+				const unsigned epoch = waitEpoch.load();
+				if (TryTakeJob(job))
+				{
+					numWaiting.fetch_sub(1);
+					Execute(job);
+				}
+				else
+				{
+					if (counter.count.load() != 0)
+					{
+						waitEpoch.wait(epoch);
+					}
+
+					numWaiting.fetch_sub(1);
+				}
+
+				numSpins = 0;
+			}
 		}
 	}
 
-	bool Mutex::Init()
+	void JobSystemSingleton::ProcessMainThreadJobs()
 	{
-		mutex = CreateMutex(
-			NULL,  // Default security
-			FALSE, // Not initially owned
-			NULL); // Unnamed
+		ASSERT(IsMainThread(), "Main thread jobs must be processed from the main thread.");
+
+		detail::Job job;
+		while (TryTakeMainThreadJob(job))
+		{
+			Execute(job);
+		}
+	}
+
+	void JobSystemSingleton::Schedule(detail::Job job)
+	{
+		if (job.affinity == JobAffinity::MainThread)
+		{
+			if (IsMainThread() && !IsRunning())
+			{
+				Execute(job);
+			}
+			else
+			{
+				{
+					std::lock_guard guard(mainThreadLock);
+					mainThreadJobs.push_back(std::move(job));
+				}
+
+				WakeWaiters();
+			}
+
+			return;
+		}
+
+		if (!IsRunning())
+		{
+			Execute(job);
+			return;
+		}
+
+		// Jobs scheduled by a worker stay with that worker, since they likely share data with the job that created them.
+		const unsigned index = workerIndex >= 0 ? workerIndex : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+		{
+			WorkerQueue& queue = *queues[index];
+			std::lock_guard guard(queue.lock);
+			queue.jobs.push_back(std::move(job));
+		}
+
+		numQueued.fetch_add(1);
+		WakeWaiters();
 
-		return mutex != NULL;
+		// A sleeping worker registers itself before checking 'numQueued', so it can't miss this job.
+		if (numSleeping.load() > 0)
+		{
+			{
+				std::lock_guard guard(sleepLock);
+			}
+			wakeCondition.notify_one();
+		}
 	}
 
-	void Mutex::Lock()
+	void JobSystemSingleton::Execute(detail::Job& job)
 	{
-		WaitForSingleObject(mutex, INFINITE);
+		job.func();
+		job.func = nullptr;
+
+		if (job.counter)
+		{
+			Release(*job.counter);
+		}
 	}
 
-	void Mutex::Unlock()
+	void JobSystemSingleton::Release(JobCounter& counter)
 	{
-		ReleaseMutex(mutex);
+		// If this isn't the last job, the counter can't reach zero and be destroyed under us.
+		unsigned count = counter.count.load(std::memory_order_relaxed);
+		while (count > 1)
+		{
+			if (counter.count.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel))
+			{
+				return;
+			}
+		}
+
+		std::vector<detail::Job> ready;
+		{
+			std::lock_guard guard(counter.lock);
+			if (counter.count.fetch_sub(1) != 1)
+			{
+				return;
+			}
+
+			ready.swap(counter.dependents);
+		}
+
+		// The counter might already be destroyed by a thread returning from Wait(), so it isn't touched from here on.
+		WakeWaiters();
+
+		for (auto& job : ready)
+		{
+			Schedule(std::move(job));
+		}
 	}
 
-	Thread::~Thread()
+	void JobSystemSingleton::WakeWaiters()
 	{
-		if (threadHandle != NULL)
+		// Orders the new job, or the released counter, before the check. Wait() registers itself before checking for either.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (numWaiting.load() > 0)
 		{
-			CloseHandle(threadHandle);
+			waitEpoch.fetch_add(1);
+			waitEpoch.notify_all();
 		}
 	}
 
-	bool Thread::Start(unsigned (__stdcall *startFunc)(void* arg), void* argData)
+	bool JobSystemSingleton::TryTakeJob(detail::Job& job)
 	{
-		threadHandle = CreateThread(
-			NULL,                                                // Default security
-			NULL,                                                // Default stack size
-			reinterpret_cast<LPTHREAD_START_ROUTINE>(startFunc), // Start location
-			argData,                                             // Data argument
-			NULL,                                                // Default creation
-			&id);                                                // Thread ID
+		// The main thread takes care of its own jobs while it waits.
+		if (IsMainThread() && TryTakeMainThreadJob(job))
+		{
+			return true;
+		}
+
+		if (numQueued.load() == 0)
+		{
+			return false;
+		}
+
+		// Workers start with their own queue, taking the newest job.
+		const unsigned numQueues = queues.size();
+		if (workerIndex >= 0)
+		{
+			WorkerQueue& queue = *queues[workerIndex];
+			std::lock_guard guard(queue.lock);
+			if (!queue.jobs.empty())
+			{
+				job = std::move(queue.jobs.back());
+				queue.jobs.pop_back();
+				numQueued.fetch_sub(1);
+
+				return true;
+			}
+		}
+
+		// Steal the oldest job from another queue.
+		const unsigned start = workerIndex >= 0 ? workerIndex + 1 : 0;
+		for (unsigned i = 0; i < numQueues; ++i)
+		{
+			const unsigned index = (start + i) % numQueues;
+			if (index == static_cast<unsigned>(workerIndex))
+			{
+				continue;
+			}
+
+			WorkerQueue& queue = *queues[index];
+			std::lock_guard guard(queue.lock);
+			if (!queue.jobs.empty())
+			{
+				job = std::move(queue.jobs.front());
+				queue.jobs.pop_front();
+				numQueued.fetch_sub(1);
+
+				return true;
+			}
+		}
 
-		return threadHandle != NULL;
+		return false;
 	}
 
-	void Thread::Join()
+	bool JobSystemSingleton::TryTakeMainThreadJob(detail::Job& job)
 	{
-		WaitForSingleObject(threadHandle, INFINITE);
+		std::lock_guard guard(mainThreadLock);
+		if (mainThreadJobs.empty())
+		{
+			return false;
+		}
+
+		// Taken oldest-first, so that main thread jobs run in the order they were scheduled.
+		job = std::move(mainThreadJobs.front());
+		mainThreadJobs.pop_front();
+
+		return true;
 	}
 
-	bool Thread::GetReturnValue(unsigned* value)
+	void JobSystemSingleton::WorkerLoop(unsigned index)
 	{
-		bool result = GetExitCodeThread(threadHandle, reinterpret_cast<LPDWORD>(value)) != 0;
-		return result && reinterpret_cast<DWORD>(value) != STILL_ACTIVE;
+		workerIndex = index;
+
+		detail::Job job;
+		while (true)
+		{
+			if (TryTakeJob(job))
+			{
+				Execute(job);
+				continue;
+			}
+
+			std::unique_lock guard(sleepLock);
+			if (!isRunning && numQueued.load() == 0)
+			{
+				break;
+			}
+
+			numSleeping.fetch_add(1);
+			wakeCondition.wait(guard, [this] { return numQueued.load() > 0 || !isRunning; });
+			numSleeping.fetch_sub(1);
+		}
+
+		workerIndex = -1;
 	}
 
-	DWORD Thread::GetID() const
+	namespace detail
 	{
-		return id;
+		void ParallelForChunks(unsigned begin, unsigned end, unsigned grain, const std::function<void(unsigned, unsigned)>& chunkFunc)
+		{
+			ASSERT(grain > 0, "'grain' must be greater than zero.");
+
+			if (begin >= end)
+			{
+				return;
+			}
+
+			const unsigned numChunks = (end - begin) / grain + ((end - begin) % grain != 0);
+			const unsigned numHelpers = std::min(numChunks, JobSystem.GetNumWorkers() + 1) - 1;
+			if (numHelpers == 0)
+			{
+				chunkFunc(begin, end);
+				return;
+			}
+
+			// Rather than scheduling a job per chunk, a few jobs keep claiming chunks until there are none left.
+			std::atomic<unsigned> nextChunk = 0;
+			auto runChunks = [&]() {
+				for (unsigned chunk = nextChunk.fetch_add(1); chunk < numChunks; chunk = nextChunk.fetch_add(1))
+				{
+					const unsigned chunkBegin = begin + chunk * grain;
+					chunkFunc(chunkBegin, std::min(chunkBegin + grain, end));
+				}
+			};
+
+			JobCounter counter;
+			for (unsigned i = 0; i < numHelpers; ++i)
+			{
+				JobSystem.Run([&runChunks]() { runChunks(); }, &counter);
+			}
+
+			runChunks();
+			JobSystem.Wait(counter);
+		}
 	}
 }
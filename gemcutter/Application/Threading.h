@@ -1,49 +1,166 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
-#include <Windows.h>
+#include "gemcutter/Application/InlineDelegate.h"
+#include "gemcutter/Application/Lock.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace gem
 {
-	class Mutex
+	class JobCounter;
+
+	// The work done by a single job. Captures are stored inline, so scheduling a job doesn't allocate.
+	using JobFunction = InplaceFunction<void(), 48>;
+
+	enum class JobAffinity
 	{
-	public:
-		~Mutex();
+		// The job can run on any worker thread.
+		AnyThread,
+		// The job is run by the main thread, during JobSystem.ProcessMainThreadJobs() or JobSystem.Wait().
+		// Use this for work that touches systems which are not thread-safe, such as the graphics context.
+		MainThread
+	};
 
-		bool Init();
+	namespace detail
+	{
+		struct Job
+		{
+			JobFunction func;
+			// Notified once 'func' has finished. Optional.
+			JobCounter* counter = nullptr;
+			JobAffinity affinity = JobAffinity::AnyThread;
+		};
+	}
 
-		// Locks others out of the mutex.
-		void Lock();
+	// Counts the unfinished jobs of a group. Jobs can also be scheduled to start only once
+	// a counter reaches zero, which is how dependencies between jobs are expressed.
+	// A counter must outlive all of the jobs it is associated with.
+	class JobCounter
+	{
+		friend class JobSystemSingleton;
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		~JobCounter();
+
+		JobCounter& operator=(const JobCounter&) = delete;
 
-		// Releases the mutex for other threads to use.
-		void Unlock();
+		// Returns true once every job associated with the counter has finished.
+		bool IsDone() const;
 
 	private:
-		HANDLE mutex = 0;
+		std::atomic<unsigned> count = 0;
+
+		// Protects 'dependents' and the transition of 'count' to zero.
+		std::mutex lock;
+		// Jobs waiting for the counter to reach zero.
+		std::vector<detail::Job> dependents;
 	};
 
-	class Thread
+	// Runs jobs on a pool of worker threads.
+	// Each worker has its own queue of jobs. A job scheduled from a worker is added to that worker's
+	// queue, and taken newest-first while its data is still in the cache. Idle workers steal the oldest
+	// jobs from the other queues, and sleep once there is no work left anywhere.
+	// If the job system hasn't been started, jobs are run immediately on the thread scheduling them.
+	extern class JobSystemSingleton JobSystem;
+	class JobSystemSingleton
 	{
 	public:
-		Thread() = default;
-		Thread(const Thread&) = delete;
-		~Thread();
+		JobSystemSingleton();
+		JobSystemSingleton(const JobSystemSingleton&) = delete;
+		~JobSystemSingleton();
+
+		JobSystemSingleton& operator=(const JobSystemSingleton&) = delete;
+
+		// Creates the worker threads. By default, one worker is created for each core except for the one
+		// running the main thread. The thread calling Start() becomes the main thread.
+		void Start(unsigned numWorkers = 0);
+
+		// Finishes all remaining jobs and joins the worker threads.
+		// Other threads must not be scheduling jobs while this is called.
+		void Stop();
 
-		Thread& operator=(const Thread&) = delete;
+		bool IsRunning() const;
+		unsigned GetNumWorkers() const;
 
-		// Start the thread on the specified function. Returns false if thread didn't start.
-		bool Start(unsigned (__stdcall *startFunc)(void* arg), void* argData = NULL);
+		// Returns true if called from the main thread.
+		bool IsMainThread() const;
 
-		// Returns only once the internal thread has finished.
-		void Join();
+		// Schedules a job. If a counter is given, it will be incremented now and decremented once the job has finished.
+		void Run(JobFunction job, JobCounter* counter = nullptr, JobAffinity affinity = JobAffinity::AnyThread);
 
-		// Returns false if the function could not retrieve the return value of the thread.
-		bool GetReturnValue(unsigned* value);
+		// Schedules a job to start once 'dependency' has reached zero.
+		// If a counter is given, it will be incremented now and decremented once the job has finished.
+		void RunAfter(JobCounter& dependency, JobFunction job, JobCounter* counter = nullptr, JobAffinity affinity = JobAffinity::AnyThread);
 
-		// Returns the thread ID.
-		DWORD GetID() const;
+		// Returns once the counter has reached zero. The calling thread helps to run other jobs in the meantime.
+		// If there is nothing to help with, it spins briefly and then sleeps until a job is scheduled or a counter reaches zero.
+		void Wait(JobCounter& counter);
+
+		// Runs all the jobs which are waiting for the main thread. This is called once per frame by the Application.
+		void ProcessMainThreadJobs();
 
 	private:
-		HANDLE threadHandle = 0;
-		DWORD id = 0;
+		struct alignas(64) WorkerQueue
+		{
+			SpinLock lock;
+			std::deque<detail::Job> jobs;
+		};
+
+		void Schedule(detail::Job job);
+		void Execute(detail::Job& job);
+		// Marks one job of the counter as finished, and schedules its dependents if it was the last one.
+		void Release(JobCounter& counter);
+		// Wakes the threads sleeping in Wait(), if there are any. Called after a job is scheduled or a counter reaches zero.
+		void WakeWaiters();
+
+		// Takes a job from the queue of the calling worker, or steals one from another queue.
+		bool TryTakeJob(detail::Job& job);
+		// Takes one of the jobs waiting for the main thread.
+		bool TryTakeMainThreadJob(detail::Job& job);
+
+		void WorkerLoop(unsigned index);
+
+		std::vector<std::unique_ptr<WorkerQueue>> queues;
+		std::vector<std::thread> workers;
+		std::thread::id mainThreadId;
+		std::atomic<bool> isRunning = false;
+
+		// The number of jobs in the worker queues. Lets idle workers know when to wake up.
+		std::atomic<unsigned> numQueued = 0;
+		// Where the next job scheduled from outside of the pool is placed.
+		std::atomic<unsigned> nextQueue = 0;
+
+		std::mutex sleepLock;
+		std::condition_variable wakeCondition;
+		std::atomic<unsigned> numSleeping = 0;
+
+		// Threads sleeping in Wait() register themselves, then sleep until 'waitEpoch' changes.
+		std::atomic<unsigned> numWaiting = 0;
+		std::atomic<unsigned> waitEpoch = 0;
+
+		SpinLock mainThreadLock;
+		std::deque<detail::Job> mainThreadJobs;
 	};
+
+	// Calls 'func(i)' for every index in [begin, end), spreading the work across the JobSystem.
+	// The range is split into chunks of 'grain' indices, which are handed out to the threads as they
+	// become free. The calling thread takes part in the work, and returns once every index is done.
+	// Larger grains lower the scheduling overhead, smaller grains balance uneven work better.
+	template<typename Func>
+	void ParallelFor(unsigned begin, unsigned end, unsigned grain, Func&& func);
+
+	namespace detail
+	{
+		void ParallelForChunks(unsigned begin, unsigned end, unsigned grain, const std::function<void(unsigned, unsigned)>& chunkFunc);
+	}
 }
+
+#include "Threading.inl"
@@ -0,0 +1,15 @@
+// Copyright (c) 2022 Emilian Cioca
+namespace gem
+{
+	template<typename Func>
+	void ParallelFor(unsigned begin, unsigned end, unsigned grain, Func&& func)
+	{
+		// Each chunk loops over its own indices, so 'func' can be inlined into the loop.
+		detail::ParallelForChunks(begin, end, grain, [&func](unsigned chunkBegin, unsigned chunkEnd) {
+			for (unsigned i = chunkBegin; i < chunkEnd; ++i)
+			{
+				func(i);
+			}
+		});
+	}
+}
@@ -1,29 +1,67 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Timer.h"
-#include "gemcutter/Application/Logging.h"
+#include "gemcutter/Application/Lock.h"
 
-#include <Windows.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ratio>
+#include <thread>
+
+#ifdef _WIN32
+	#include <atomic>
+	#include <Windows.h>
+	#include <timeapi.h>
+#endif
 
 namespace
 {
-	__int64 GetTimerResolution()
+	using Clock = std::chrono::steady_clock;
+	static_assert(Clock::is_steady, "The timer's clock must be monotonic.");
+
+	// Ticks are always nanoseconds, whatever the precision of the underlying clock is.
+	constexpr std::int64_t ticksPerSecond = 1000000000;
+	constexpr std::int64_t ticksPerMS = ticksPerSecond / 1000;
+
+	// Casted ahead of time for a performance boost in GetElapsedMS() and GetElapsedSeconds().
+	constexpr double d_ticksPerSecond = static_cast<double>(ticksPerSecond);
+	constexpr double d_ticksPerMS = static_cast<double>(ticksPerMS);
+
+	// How long SleepUntil() asks the OS to sleep for at a time.
+	constexpr auto SLEEP_INTERVAL = std::chrono::milliseconds(1);
+
+	// Tracks how long a requested sleep really takes, which depends on the OS's scheduler and timer resolution.
+	// Recent sleeps are weighted the most, so the estimate adapts if the system's load changes.
+	class SleepEstimate
 	{
-		LARGE_INTEGER temp;
-		if (QueryPerformanceFrequency(&temp))
+	public:
+		void Add(double ticks)
 		{
-			return temp.QuadPart;
+			const double difference = ticks - mean;
+			mean += difference * WEIGHT;
+			variance = (1.0 - WEIGHT) * (variance + WEIGHT * difference * difference);
 		}
 
-		gem::Error("Timer: High performance timer is not supported by your CPU.");
-		return 0;
-	}
+		// A duration that most sleeps finish within.
+		std::int64_t Get() const
+		{
+			return static_cast<std::int64_t>(mean + 2.0 * std::sqrt(variance));
+		}
 
-	const __int64 ticksPerSecond = GetTimerResolution();
-	const __int64 ticksPerMS = ticksPerSecond / 1000;
+	private:
+		static constexpr double WEIGHT = 0.1;
 
-	// Casted ahead of time for a performance boost in GetElapsedMS() and GetElapsedSeconds().
-	const double d_ticksPerSecond = static_cast<double>(ticksPerSecond);
-	const double d_ticksPerMS = static_cast<double>(ticksPerMS);
+		// Starts off pessimistic, so that the first waits don't oversleep.
+		double mean = 2.0 * ticksPerMS;
+		double variance = 0.0;
+	};
+
+	thread_local SleepEstimate sleepEstimate;
+
+#ifdef _WIN32
+	// The number of live SleepResolutionScopes.
+	std::atomic<unsigned> numResolutionScopes = 0;
+#endif
 }
 
 namespace gem
@@ -35,25 +73,44 @@ namespace gem
 
 	bool Timer::IsSupported()
 	{
-		return ticksPerSecond > 0;
+		return std::ratio_less_equal_v<Clock::period, std::micro>;
 	}
 
-	__int64 Timer::GetTicksPerMS()
+	std::int64_t Timer::GetTicksPerMS()
 	{
 		return ticksPerMS;
 	}
 
-	__int64 Timer::GetTicksPerSecond()
+	std::int64_t Timer::GetTicksPerSecond()
 	{
 		return ticksPerSecond;
 	}
 
-	__int64 Timer::GetCurrentTick()
+	std::int64_t Timer::GetCurrentTick()
 	{
-		LARGE_INTEGER currentTime;
-		QueryPerformanceCounter(&currentTime);
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+	}
 
-		return currentTime.QuadPart;
+	void Timer::SleepUntil(std::int64_t tick)
+	{
+		std::int64_t now = GetCurrentTick();
+		if (tick - now > sleepEstimate.Get())
+		{
+			const SleepResolutionScope resolution;
+			do
+			{
+				std::this_thread::sleep_for(SLEEP_INTERVAL);
+
+				const std::int64_t wakeTime = GetCurrentTick();
+				sleepEstimate.Add(static_cast<double>(wakeTime - now));
+				now = wakeTime;
+			} while (tick - now > sleepEstimate.Get());
+		}
+
+		while (GetCurrentTick() < tick)
+		{
+			CpuRelax();
+		}
 	}
 
 	void Timer::Reset()
@@ -73,35 +130,98 @@ namespace gem
 
 	bool Timer::IsElapsedMS(double ms) const
 	{
-		return ms >= GetElapsedMS();
+		return GetElapsedMS() >= ms;
 	}
 
 	bool Timer::IsElapsedSeconds(double seconds) const
 	{
-		return seconds >= GetElapsedSeconds();
+		return GetElapsedSeconds() >= seconds;
 	}
 
 	void Timer::SubtractTimeMS(double ms)
 	{
 		// Moving the start time forward effectively removes time.
-		startTime += static_cast<__int64>(ms) / ticksPerMS;
+		startTime += static_cast<std::int64_t>(ms * d_ticksPerMS);
 	}
 
 	void Timer::SubtractTimeSeconds(double seconds)
 	{
 		// Moving the start time forward effectively removes time.
-		startTime += static_cast<__int64>(seconds) / ticksPerSecond;
+		startTime += static_cast<std::int64_t>(seconds * d_ticksPerSecond);
 	}
 
 	void Timer::AddTimeMS(double ms)
 	{
 		// Moving the start time back effective adds more time.
-		startTime -= static_cast<__int64>(ms) / ticksPerMS;
+		startTime -= static_cast<std::int64_t>(ms * d_ticksPerMS);
 	}
 
 	void Timer::AddTimeSeconds(double seconds)
 	{
 		// Moving the start time back effective adds more time.
-		startTime -= static_cast<__int64>(seconds) / ticksPerSecond;
+		startTime -= static_cast<std::int64_t>(seconds * d_ticksPerSecond);
+	}
+
+	// Other platforms already wake sleeping threads with a fine resolution.
+	SleepResolutionScope::SleepResolutionScope()
+	{
+#ifdef _WIN32
+		if (numResolutionScopes.fetch_add(1) == 0)
+		{
+			timeBeginPeriod(1);
+		}
+#endif
+	}
+
+	SleepResolutionScope::~SleepResolutionScope()
+	{
+#ifdef _WIN32
+		if (numResolutionScopes.fetch_sub(1) == 1)
+		{
+			timeEndPeriod(1);
+		}
+#endif
+	}
+
+	FrameClock::FrameClock()
+	{
+		Reset();
+	}
+
+	std::int64_t FrameClock::Tick()
+	{
+		const std::int64_t now = std::max(Timer::GetCurrentTick(), frameTick);
+
+		deltaTicks = now - frameTick;
+		frameTick = now;
+
+		return frameTick;
+	}
+
+	void FrameClock::Reset()
+	{
+		startTick = Timer::GetCurrentTick();
+		frameTick = startTick;
+		deltaTicks = 0;
+	}
+
+	std::int64_t FrameClock::GetFrameTick() const
+	{
+		return frameTick;
+	}
+
+	std::int64_t FrameClock::GetDeltaTicks() const
+	{
+		return deltaTicks;
+	}
+
+	double FrameClock::GetDeltaSeconds() const
+	{
+		return deltaTicks / d_ticksPerSecond;
+	}
+
+	double FrameClock::GetElapsedSeconds() const
+	{
+		return (frameTick - startTick) / d_ticksPerSecond;
 	}
 }
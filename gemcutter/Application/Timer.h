@@ -1,25 +1,33 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
+#include <cstdint>
 
 namespace gem
 {
+	// Measures time with the system's monotonic clock, at nanosecond resolution.
 	class Timer
 	{
 	public:
 		// Calls Reset(), immediately starting the internal clock.
 		Timer();
 
-		// Returns true if performance counters are available on the system architecture.
+		// Returns true if the system's clock has at least microsecond precision.
 		static bool IsSupported();
 
 		// Returns the resolution of the timer in ticks-per-millisecond.
-		static __int64 GetTicksPerMS();
+		static std::int64_t GetTicksPerMS();
 		// Returns the resolution of the timer in ticks-per-second.
-		static __int64 GetTicksPerSecond();
+		static std::int64_t GetTicksPerSecond();
 
 		// Returns the current global tick count. Can be subtracted from a previous call
 		// in order to calculate the amount of time that has passed.
-		static __int64 GetCurrentTick();
+		static std::int64_t GetCurrentTick();
+
+		// Blocks the thread until GetCurrentTick() reaches 'tick'.
+		// The thread sleeps for most of the wait, and only spins for the final stretch which the OS
+		// can't be trusted to wake up on time for. How long that is is learned from previous sleeps.
+		// The OS's timer resolution is raised while sleeping. See SleepResolutionScope.
+		static void SleepUntil(std::int64_t tick);
 
 		// Sets the reference time for any other functions called in the future.
 		void Reset();
@@ -45,6 +53,49 @@ namespace gem
 		void AddTimeSeconds(double seconds);
 
 	private:
-		__int64 startTime;
+		std::int64_t startTime;
+	};
+
+	// Raises the resolution of the OS's timer while it exists, so that short sleeps wake up on time.
+	// By default, Windows only wakes sleeping threads every 15.6ms. Scopes can be nested, and only the
+	// outermost one changes the resolution, so holding one around a loop avoids changing it on every sleep.
+	class SleepResolutionScope
+	{
+	public:
+		SleepResolutionScope();
+		SleepResolutionScope(const SleepResolutionScope&) = delete;
+		~SleepResolutionScope();
+
+		SleepResolutionScope& operator=(const SleepResolutionScope&) = delete;
+	};
+
+	// Samples the time once per pass of the game-loop, so that everything done in the same pass agrees on the time.
+	// The time reported never runs backwards, even if consecutive readings of the clock do.
+	class FrameClock
+	{
+	public:
+		// Calls Reset(), immediately starting the first frame.
+		FrameClock();
+
+		// Starts a new frame. Returns the tick at which it started.
+		std::int64_t Tick();
+
+		// Starts over from the current time.
+		void Reset();
+
+		// Returns the tick at which the current frame started.
+		std::int64_t GetFrameTick() const;
+
+		// Returns the time between the start of the previous frame and the current one.
+		std::int64_t GetDeltaTicks() const;
+		double GetDeltaSeconds() const;
+
+		// Returns the amount of time passed between the last Reset() and the start of the current frame.
+		double GetElapsedSeconds() const;
+
+	private:
+		std::int64_t startTick;
+		std::int64_t frameTick;
+		std::int64_t deltaTicks = 0;
 	};
 }
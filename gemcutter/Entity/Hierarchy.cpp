@@ -39,6 +39,8 @@ namespace gem
 		childHierarchy.parentHierarchy = this;
 		entity->RemoveTag<HierarchyRoot>();
 		children.push_back(std::move(entity));
+
+		MarkSubtreeChanged();
 	}
 
 	void Hierarchy::RemoveChild(Entity& entity)
@@ -54,6 +56,7 @@ namespace gem
 				entity.Tag<HierarchyRoot>();
 				children.erase(children.begin() + i);
 
+				MarkSubtreeChanged();
 				return;
 			}
 		}
@@ -67,6 +70,11 @@ namespace gem
 
 	void Hierarchy::ClearChildren()
 	{
+		if (children.empty())
+		{
+			return;
+		}
+
 		for (auto& child : children)
 		{
 			auto& childHierarchy = child->Get<Hierarchy>();
@@ -77,6 +85,8 @@ namespace gem
 		}
 
 		children.clear();
+
+		MarkSubtreeChanged();
 	}
 
 	void Hierarchy::DetachFromParent()
@@ -143,6 +153,19 @@ namespace gem
 		return children.empty();
 	}
 
+	unsigned Hierarchy::GetSubtreeVersion() const
+	{
+		return subtreeVersion;
+	}
+
+	void Hierarchy::MarkSubtreeChanged()
+	{
+		for (Hierarchy* node = this; node; node = node->parentHierarchy)
+		{
+			node->subtreeVersion++;
+		}
+	}
+
 	Entity::Ptr Hierarchy::CreateChild()
 	{
 		auto child = Entity::MakeNew();
@@ -59,6 +59,14 @@ namespace gem
 		// Returns true if this Entity doesn't have any children.
 		bool IsLeaf() const;
 
+		// Returns a number which changes whenever an Entity is attached or detached anywhere in the subtree,
+		// or when MarkSubtreeChanged() is called from within it. Allows other systems to cache information
+		// about the subtree and know when to refresh it.
+		unsigned GetSubtreeVersion() const;
+
+		// Changes the subtree version of this Entity and all of its ancestors.
+		void MarkSubtreeChanged();
+
 		// Creates and returns a new child Entity.
 		Entity::Ptr CreateChild();
 
@@ -72,5 +80,6 @@ namespace gem
 		Hierarchy* parentHierarchy = nullptr;
 		Entity::WeakPtr parent;
 		std::vector<Entity::Ptr> children;
+		unsigned subtreeVersion = 0;
 	};
 }
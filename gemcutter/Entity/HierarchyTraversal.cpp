@@ -0,0 +1,229 @@
+// Copyright (c) 2022 Emilian Cioca
+#include "HierarchyTraversal.h"
+#include "gemcutter/Application/Threading.h"
+#include "gemcutter/Entity/Hierarchy.h"
+
+namespace
+{
+	// Returns the number of children of the Entity, if it is part of a hierarchy.
+	unsigned GetNumChildren(const gem::Entity& ent)
+	{
+		if (auto* hierarchy = ent.Try<gem::Hierarchy>())
+		{
+			return hierarchy->GetNumChildren();
+		}
+
+		return 0;
+	}
+
+	gem::Entity* GetChild(const gem::Entity& ent, unsigned index)
+	{
+		return ent.Get<gem::Hierarchy>().GetChildren()[index].get();
+	}
+}
+
+namespace gem
+{
+	void HierarchyTraversal::Start(Entity& root, TraversalOrder _order)
+	{
+		Reset();
+
+		order = _order;
+		started = true;
+
+		if (order == TraversalOrder::BreadthFirst)
+		{
+			queue.push_back(&root);
+		}
+		else
+		{
+			stack.push_back({ &root, 0 });
+		}
+	}
+
+	Entity* HierarchyTraversal::Next()
+	{
+		switch (order)
+		{
+		case TraversalOrder::PreOrder:     current = NextPreOrder(); break;
+		case TraversalOrder::PostOrder:    current = NextPostOrder(); break;
+		case TraversalOrder::BreadthFirst: current = NextBreadthFirst(); break;
+		}
+
+		skipChildren = false;
+
+		return current;
+	}
+
+	void HierarchyTraversal::SkipChildren()
+	{
+		ASSERT(current, "There is no current Entity to skip the children of.");
+
+		skipChildren = true;
+	}
+
+	void HierarchyTraversal::Reset()
+	{
+		stack.clear();
+		queue.clear();
+		queueHead = 0;
+		current = nullptr;
+		started = false;
+		skipChildren = false;
+	}
+
+	bool HierarchyTraversal::IsFinished() const
+	{
+		return !started && current == nullptr;
+	}
+
+	HierarchyTraversal::Range<Entity> HierarchyTraversal::Walk(Entity& root, TraversalOrder _order)
+	{
+		Start(root, _order);
+		return { *this };
+	}
+
+	HierarchyTraversal::Range<const Entity> HierarchyTraversal::Walk(const Entity& root, TraversalOrder _order)
+	{
+		// The walk never modifies the Entities, and the range only hands out const references.
+		Start(const_cast<Entity&>(root), _order);
+		return { *this };
+	}
+
+	Entity* HierarchyTraversal::NextPreOrder()
+	{
+		if (stack.empty())
+		{
+			started = false;
+			return nullptr;
+		}
+
+		// The root is the first Entity of the walk.
+		if (current == nullptr)
+		{
+			return stack.back().entity;
+		}
+
+		// The current Entity is always on top of the stack.
+		if (skipChildren)
+		{
+			stack.pop_back();
+		}
+
+		while (!stack.empty())
+		{
+			Frame& frame = stack.back();
+			if (frame.nextChild < GetNumChildren(*frame.entity))
+			{
+				Entity* child = GetChild(*frame.entity, frame.nextChild++);
+				stack.push_back({ child, 0 });
+
+				return child;
+			}
+
+			stack.pop_back();
+		}
+
+		started = false;
+		return nullptr;
+	}
+
+	Entity* HierarchyTraversal::NextPostOrder()
+	{
+		if (stack.empty())
+		{
+			started = false;
+			return nullptr;
+		}
+
+		// The current Entity is always on top of the stack, and all of its children are done.
+		if (current != nullptr)
+		{
+			stack.pop_back();
+			if (stack.empty())
+			{
+				started = false;
+				return nullptr;
+			}
+		}
+
+		// Descend to the deepest Entity which still has unvisited children.
+		while (true)
+		{
+			Frame& frame = stack.back();
+			if (frame.nextChild >= GetNumChildren(*frame.entity))
+			{
+				return frame.entity;
+			}
+
+			Entity* child = GetChild(*frame.entity, frame.nextChild++);
+			stack.push_back({ child, 0 });
+		}
+	}
+
+	Entity* HierarchyTraversal::NextBreadthFirst()
+	{
+		if (queueHead >= queue.size())
+		{
+			started = false;
+			return nullptr;
+		}
+
+		// The root is the first Entity of the walk.
+		if (current == nullptr)
+		{
+			return queue[queueHead];
+		}
+
+		if (!skipChildren)
+		{
+			const unsigned numChildren = GetNumChildren(*current);
+			for (unsigned i = 0; i < numChildren; ++i)
+			{
+				queue.push_back(GetChild(*current, i));
+			}
+		}
+
+		if (++queueHead >= queue.size())
+		{
+			started = false;
+			return nullptr;
+		}
+
+		return queue[queueHead];
+	}
+
+	void ParallelVisit(Entity& root, const std::function<void(Entity&)>& func)
+	{
+		ASSERT(func, "'func' cannot be null.");
+
+		const unsigned numThreads = JobSystem.GetNumWorkers() + 1;
+
+		// Visit the top of the tree on this thread, breadth-first, until there are enough
+		// independent subtrees to keep all of the threads busy.
+		const unsigned targetSubtrees = numThreads * 4;
+		std::vector<Entity*> subtrees = { &root };
+		unsigned head = 0;
+
+		while (head < subtrees.size() && subtrees.size() - head < targetSubtrees)
+		{
+			Entity& ent = *subtrees[head++];
+			func(ent);
+
+			const unsigned numChildren = GetNumChildren(ent);
+			for (unsigned i = 0; i < numChildren; ++i)
+			{
+				subtrees.push_back(GetChild(ent, i));
+			}
+		}
+
+		// Each subtree is walked as a single unit of work.
+		ParallelFor(head, subtrees.size(), 1, [&](unsigned i) {
+			HierarchyTraversal traversal;
+			for (Entity& ent : traversal.Walk(*subtrees[i], TraversalOrder::PreOrder))
+			{
+				func(ent);
+			}
+		});
+	}
+}
@@ -0,0 +1,140 @@
+// Copyright (c) 2022 Emilian Cioca
+#pragma once
+#include "gemcutter/Entity/Entity.h"
+
+#include <functional>
+#include <iterator>
+#include <vector>
+
+namespace gem
+{
+	enum class TraversalOrder
+	{
+		// Parents are visited before their children.
+		PreOrder,
+		// Children are visited before their parents.
+		PostOrder,
+		// Entities are visited one depth level at a time.
+		BreadthFirst
+	};
+
+	// Walks the subtree of an Entity without recursion, so hierarchies of any depth are safe to visit.
+	// The working memory is kept between walks. A long-lived instance will stop allocating once it has
+	// grown to fit the largest subtree it has seen. A walk can also be paused and resumed at any time
+	// simply by deferring the next call to Next().
+	// The hierarchy should not be restructured while a walk is in progress.
+	class HierarchyTraversal
+	{
+	public:
+		// Marks the end of a Range. The iterators know when they have finished on their own.
+		struct RangeEndSentinel {};
+
+		template<class EntityType>
+		class Iterator
+		{
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type        = EntityType&;
+			using difference_type   = std::ptrdiff_t;
+			using pointer           = EntityType*;
+			using reference         = EntityType&;
+
+			Iterator(HierarchyTraversal& _traversal, Entity* _current)
+				: traversal(_traversal), current(_current)
+			{
+			}
+
+			Iterator& operator++()
+			{
+				ASSERT(current, "Invalid range.");
+				current = traversal.Next();
+				return *this;
+			}
+
+			EntityType& operator*() const
+			{
+				ASSERT(current, "Invalid range.");
+				return *current;
+			}
+
+			EntityType* operator->() const
+			{
+				ASSERT(current, "Invalid range.");
+				return current;
+			}
+
+			bool operator==(RangeEndSentinel) const { return current == nullptr; }
+			bool operator!=(RangeEndSentinel) const { return current != nullptr; }
+
+		private:
+			HierarchyTraversal& traversal;
+			Entity* current;
+		};
+
+		template<class EntityType>
+		class Range
+		{
+		public:
+			Range(HierarchyTraversal& _traversal)
+				: traversal(_traversal)
+			{
+			}
+
+			Iterator<EntityType> begin() { return { traversal, traversal.Next() }; }
+			RangeEndSentinel end() { return {}; }
+
+		private:
+			HierarchyTraversal& traversal;
+		};
+
+		// Begins a new walk of the subtree under 'root', 'root' included.
+		// Any walk already in progress is abandoned.
+		void Start(Entity& root, TraversalOrder order);
+
+		// Returns the next Entity of the walk, or null once the whole subtree has been visited.
+		Entity* Next();
+
+		// Prevents the children of the Entity last returned by Next() from being visited.
+		// This has no effect on post-order walks, where children are always visited first.
+		void SkipChildren();
+
+		// Abandons the walk in progress, if there is one.
+		void Reset();
+
+		// Returns true if there is no walk in progress.
+		bool IsFinished() const;
+
+		// Starts a new walk and returns it as a range, for use in a range-based for loop.
+		//	for (Entity& e : traversal.Walk(root, TraversalOrder::PreOrder)) { ... }
+		Range<Entity> Walk(Entity& root, TraversalOrder order);
+		Range<const Entity> Walk(const Entity& root, TraversalOrder order);
+
+	private:
+		Entity* NextPreOrder();
+		Entity* NextPostOrder();
+		Entity* NextBreadthFirst();
+
+		struct Frame
+		{
+			Entity* entity;
+			// The index of the next child of 'entity' to descend into.
+			unsigned nextChild;
+		};
+
+		// The path from the root to the current Entity. Used by depth-first walks.
+		std::vector<Frame> stack;
+		// Every Entity discovered so far. Used by breadth-first walks.
+		std::vector<Entity*> queue;
+		unsigned queueHead = 0;
+
+		Entity* current = nullptr;
+		TraversalOrder order = TraversalOrder::PreOrder;
+		bool started = false;
+		bool skipChildren = false;
+	};
+
+	// Invokes 'func' on every Entity in the subtree under 'root', 'root' included, spreading the work
+	// across the JobSystem. The order of the calls is unspecified, so 'func' must be safe to call
+	// concurrently. The hierarchy must not be restructured until the function returns.
+	void ParallelVisit(Entity& root, const std::function<void(Entity&)>& func);
+}
@@ -75,7 +75,7 @@ namespace gem
 				y = -(static_cast<int>(GET_Y_LPARAM(msg.lParam)) - Application.GetScreenHeight());
 				vec2 pos(static_cast<float>(x), static_cast<float>(y));
 
-				EventQueue.Push(std::make_unique<MouseMoved>(pos, pos - lastPos));
+				EventQueue.Emplace<MouseMoved>(pos, pos - lastPos);
 				break;
 			}
 
@@ -131,7 +131,7 @@ namespace gem
 			break;
 
 		case WM_MOUSEWHEEL:
-			EventQueue.Push(std::make_unique<MouseScrolled>(static_cast<int>(GET_WHEEL_DELTA_WPARAM(msg.wParam) / WHEEL_DELTA)));
+			EventQueue.Emplace<MouseScrolled>(static_cast<int>(GET_WHEEL_DELTA_WPARAM(msg.wParam) / WHEEL_DELTA));
 			break;
 
 		default:
@@ -148,11 +148,21 @@ namespace gem
 	{
 	}
 
+	MouseMoved MouseMoved::Accumulate(const MouseMoved& previous, const MouseMoved& next)
+	{
+		return MouseMoved(next.pos, previous.delta + next.delta);
+	}
+
 	MouseScrolled::MouseScrolled(int _scroll)
 		: scroll(_scroll)
 	{
 	}
 
+	MouseScrolled MouseScrolled::Accumulate(const MouseScrolled& previous, const MouseScrolled& next)
+	{
+		return MouseScrolled(previous.scroll + next.scroll);
+	}
+
 	KeyPressed::KeyPressed(Key _key)
 		: key(_key)
 	{
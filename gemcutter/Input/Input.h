@@ -66,10 +66,16 @@ namespace gem
 	};
 
 	// An event distributed by the engine when the mouse position has changed from the previous frame.
+	// Multiple movements in the same frame are combined into one event.
 	struct MouseMoved : public Event<MouseMoved>
 	{
+		static constexpr QueuePolicy queuePolicy = QueuePolicy::Accumulate;
+		static constexpr bool dropWithoutListeners = true;
+
 		MouseMoved(const vec2& pos, const vec2& delta);
 
+		static MouseMoved Accumulate(const MouseMoved& previous, const MouseMoved& next);
+
 		// The new mouse position.
 		const vec2 pos;
 		// The different between this position and the last.
@@ -77,10 +83,16 @@ namespace gem
 	};
 
 	// An event distributed by the engine when the mouse wheel is moved.
+	// Multiple scrolls in the same frame are combined into one event.
 	struct MouseScrolled : public Event<MouseScrolled>
 	{
+		static constexpr QueuePolicy queuePolicy = QueuePolicy::Accumulate;
+		static constexpr bool dropWithoutListeners = true;
+
 		MouseScrolled(int scroll);
 
+		static MouseScrolled Accumulate(const MouseScrolled& previous, const MouseScrolled& next);
+
 		// Each positive integer indicates a single roll away from the user, and vice-versa.
 		const int scroll;
 	};
@@ -2,6 +2,7 @@
 #include "ParticleEmitter.h"
 #include "gemcutter/Application/Application.h"
 #include "gemcutter/Application/Logging.h"
+#include "gemcutter/Application/Profiler.h"
 
 namespace gem
 {
@@ -78,6 +79,8 @@ namespace gem
 
 	void ParticleEmitter::Update()
 	{
+		GEM_PROFILE_SCOPE("ParticleEmitter::Update");
+
 		if (!isPaused)
 		{
 			UpdateInternal(Application.GetDeltaTime());
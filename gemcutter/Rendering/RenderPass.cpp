@@ -2,6 +2,7 @@
 #include "RenderPass.h"
 #include "gemcutter/Application/Application.h"
 #include "gemcutter/Application/Logging.h"
+#include "gemcutter/Application/Profiler.h"
 #include "gemcutter/Entity/Entity.h"
 #include "gemcutter/Entity/Hierarchy.h"
 #include "gemcutter/Math/Transform.h"
@@ -210,9 +211,14 @@ namespace gem
 
 	void RenderPass::Render(const Entity& root)
 	{
+		GEM_PROFILE_SCOPE("RenderPass::Render");
+
 		Bind();
 
-		RenderEntityRecursive(root);
+		for (const Entity& ent : traversal.Walk(root, TraversalOrder::PreOrder))
+		{
+			RenderEntity(ent);
+		}
 
 		if (skybox)
 		{
@@ -224,6 +230,8 @@ namespace gem
 
 	void RenderPass::Render(const std::vector<Entity::Ptr>& entities)
 	{
+		GEM_PROFILE_SCOPE("RenderPass::Render");
+
 		Bind();
 
 		for (auto& entity : entities)
@@ -466,19 +474,6 @@ namespace gem
 		UnBindRenderable(*renderable, shader.get());
 	}
 
-	void RenderPass::RenderEntityRecursive(const Entity& ent)
-	{
-		RenderEntity(ent);
-
-		if (auto* hierarchy = ent.Try<Hierarchy>())
-		{
-			for (auto& child : hierarchy->GetChildren())
-			{
-				RenderEntityRecursive(*child);
-			}
-		}
-	}
-
 	void RenderPass::CreateUniformBuffer()
 	{
 		MVP = transformBuffer.AddUniform<mat4>("MVP");
@@ -1,5 +1,6 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
+#include "gemcutter/Entity/HierarchyTraversal.h"
 #include "gemcutter/Rendering/RenderTarget.h"
 #include "gemcutter/Rendering/Viewport.h"
 #include "gemcutter/Resource/Shader.h"
@@ -57,7 +58,6 @@ namespace gem
 		void UnBind();
 
 		void RenderEntity(const Entity& ent);
-		void RenderEntityRecursive(const Entity& ent);
 
 		void CreateUniformBuffer();
 
@@ -67,6 +67,9 @@ namespace gem
 		Shader::Ptr shader;
 		Texture::Ptr skybox;
 
+		// Reused between calls to Render() to walk the hierarchy without allocating.
+		HierarchyTraversal traversal;
+
 		// Holds the world transformation matrices for an entity while rendering.
 		UniformBuffer transformBuffer;
 
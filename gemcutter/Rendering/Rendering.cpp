@@ -270,6 +270,34 @@ namespace gem
 		}
 	}
 
+	unsigned CountBytes(TextureFormat format)
+	{
+		switch (format)
+		{
+		case TextureFormat::RGB_8:
+		case TextureFormat::sRGB_8:
+		case TextureFormat::DEPTH_24:
+			return 3;
+		case TextureFormat::RGBA_8:
+		case TextureFormat::sRGBA_8:
+			return 4;
+		case TextureFormat::RGB_16:
+		case TextureFormat::RGB_16F:
+			return 6;
+		case TextureFormat::RGBA_16:
+		case TextureFormat::RGBA_16F:
+			return 8;
+		case TextureFormat::RGB_32:
+		case TextureFormat::RGB_32F:
+			return 12;
+		case TextureFormat::RGBA_32:
+		case TextureFormat::RGBA_32F:
+			return 16;
+		default:
+			return 0;
+		}
+	}
+
 	void ClearBackBuffer()
 	{
 		SetDepthFunc(DepthFunc::Normal);
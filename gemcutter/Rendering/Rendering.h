@@ -181,6 +181,8 @@ namespace gem
 	unsigned CountBytes(VertexFormat);
 	unsigned CountMipLevels(unsigned width, unsigned height, TextureFilter);
 	unsigned CountChannels(TextureFormat);
+	// The size of a single texel.
+	unsigned CountBytes(TextureFormat);
 
 	void ClearBackBuffer();
 	void ClearBackBufferDepth();
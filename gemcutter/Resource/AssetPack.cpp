@@ -0,0 +1,415 @@
+// Copyright (c) 2022 Emilian Cioca
+#include "AssetPack.h"
+#include "gemcutter/Application/Logging.h"
+#include "gemcutter/Resource/Resource.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <tuple>
+
+namespace
+{
+	// Packs are searched from the most recently mounted.
+	std::vector<gem::AssetPack> mountedPacks;
+
+	// The number of LooseAssetScopes on this thread.
+	thread_local unsigned numLooseScopes = 0;
+
+	std::uint64_t AlignOffset(std::uint64_t offset)
+	{
+		return (offset + gem::ASSET_PACK_ALIGNMENT - 1) & ~static_cast<std::uint64_t>(gem::ASSET_PACK_ALIGNMENT - 1);
+	}
+}
+
+namespace gem
+{
+	std::string NormalizeAssetPath(std::string_view path)
+	{
+		std::string result(path);
+		std::replace(result.begin(), result.end(), '\\', '/');
+
+		while (result.starts_with("./"))
+		{
+			result.erase(0, 2);
+		}
+
+		return result;
+	}
+
+	std::uint64_t HashAssetPath(std::string_view path)
+	{
+		// 64-bit FNV-1a.
+		std::uint64_t hash = 14695981039346656037ull;
+		for (char c : path)
+		{
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	bool AssetPack::Open(std::string_view filePath)
+	{
+		ASSERT(!IsOpen(), "AssetPack: Already associated with a file.");
+
+		if (!file.Open(filePath))
+		{
+			Error("AssetPack: ( %s )\nUnable to open file.", filePath.data());
+			return false;
+		}
+
+		AssetPackHeader header;
+		if (file.GetSize() < sizeof(header))
+		{
+			Error("AssetPack: ( %s )\nThe file is not an asset pack.", filePath.data());
+			file.Close();
+			return false;
+		}
+
+		std::memcpy(&header, file.GetData(), sizeof(header));
+		if (std::memcmp(header.signature, ASSET_PACK_SIGNATURE, sizeof(ASSET_PACK_SIGNATURE)) != 0)
+		{
+			Error("AssetPack: ( %s )\nThe file is not an asset pack, or is from an incompatible version.", filePath.data());
+			file.Close();
+			return false;
+		}
+
+		// Validate the whole index once, so lookups don't have to.
+		const std::uint64_t pathsStart = sizeof(AssetPackHeader) + std::uint64_t(header.numEntries) * sizeof(AssetPackEntry);
+		const std::uint64_t pathsEnd = pathsStart + header.pathsSize;
+		bool isValid = pathsEnd <= file.GetSize();
+		if (isValid)
+		{
+			entries = reinterpret_cast<const AssetPackEntry*>(file.GetData() + sizeof(AssetPackHeader));
+			paths = file.GetData() + pathsStart;
+			numEntries = header.numEntries;
+
+			for (unsigned i = 0; i < numEntries && isValid; ++i)
+			{
+				const AssetPackEntry& entry = entries[i];
+				isValid =
+					std::uint64_t(entry.pathOffset) + entry.pathLength <= header.pathsSize &&
+					entry.offset >= pathsEnd &&
+					entry.offset <= file.GetSize() &&
+					entry.size <= file.GetSize() - entry.offset &&
+					(i == 0 || entries[i - 1].pathHash <= entry.pathHash);
+			}
+		}
+
+		if (!isValid)
+		{
+			Error("AssetPack: ( %s )\nThe pack's index is corrupted.", filePath.data());
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void AssetPack::Close()
+	{
+		file.Close();
+		entries = nullptr;
+		paths = nullptr;
+		numEntries = 0;
+	}
+
+	bool AssetPack::IsOpen() const
+	{
+		return file.IsOpen();
+	}
+
+	bool AssetPack::Find(std::string_view path, std::string_view& outContents) const
+	{
+		const std::uint64_t hash = HashAssetPath(path);
+		const AssetPackEntry* end = entries + numEntries;
+
+		auto* itr = std::lower_bound(entries, end, hash, [](const AssetPackEntry& entry, std::uint64_t value) {
+			return entry.pathHash < value;
+		});
+
+		// Different paths can share a hash, so the path itself is compared as well.
+		for (; itr != end && itr->pathHash == hash; ++itr)
+		{
+			if (std::string_view(paths + itr->pathOffset, itr->pathLength) == path)
+			{
+				outContents = std::string_view(file.GetData() + itr->offset, static_cast<std::size_t>(itr->size));
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	unsigned AssetPack::GetNumFiles() const
+	{
+		return numEntries;
+	}
+
+	std::string_view AssetPack::GetPath(unsigned index) const
+	{
+		ASSERT(index < numEntries, "AssetPack: 'index' is out of range.");
+
+		return std::string_view(paths + entries[index].pathOffset, entries[index].pathLength);
+	}
+
+	bool AssetPackWriter::AddFile(std::string_view packPath, std::string_view filePath)
+	{
+		std::string path = NormalizeAssetPath(packPath);
+		if (path.empty() || IsPathAbsolute(path))
+		{
+			Error("AssetPackWriter: ( %s )\nFiles must be added with a path relative to the asset directory.", path.c_str());
+			return false;
+		}
+
+		if (!FileExists(filePath))
+		{
+			Error("AssetPackWriter: ( %s )\nUnable to open file.", filePath.data());
+			return false;
+		}
+
+		auto itr = std::find_if(files.begin(), files.end(), [&path](const File& file) { return file.packPath == path; });
+		if (itr != files.end())
+		{
+			Error("AssetPackWriter: ( %s )\nA file with the same path was already added.", path.c_str());
+			return false;
+		}
+
+		const std::uint64_t hash = HashAssetPath(path);
+		files.push_back({ std::move(path), std::string(filePath), hash });
+
+		return true;
+	}
+
+	bool AssetPackWriter::Save(std::string_view filePath) const
+	{
+		// The index is sorted by hash so that it can be binary searched.
+		std::vector<const File*> sorted;
+		sorted.reserve(files.size());
+		for (const File& file : files)
+		{
+			sorted.push_back(&file);
+		}
+
+		std::sort(sorted.begin(), sorted.end(), [](const File* a, const File* b) {
+			return std::tie(a->pathHash, a->packPath) < std::tie(b->pathHash, b->packPath);
+		});
+
+		std::string pathStrings;
+		std::vector<AssetPackEntry> entries;
+		entries.reserve(sorted.size());
+		for (const File* file : sorted)
+		{
+			AssetPackEntry entry = {};
+			entry.pathHash = file->pathHash;
+			entry.pathOffset = static_cast<std::uint32_t>(pathStrings.size());
+			entry.pathLength = static_cast<std::uint32_t>(file->packPath.size());
+			entries.push_back(entry);
+
+			pathStrings += file->packPath;
+		}
+
+		AssetPackHeader header = {};
+		std::memcpy(header.signature, ASSET_PACK_SIGNATURE, sizeof(ASSET_PACK_SIGNATURE));
+		header.numEntries = static_cast<std::uint32_t>(entries.size());
+		header.pathsSize = static_cast<std::uint32_t>(pathStrings.size());
+
+		// Lay out the file contents after the index.
+		const std::uint64_t indexSize = sizeof(AssetPackHeader) + entries.size() * sizeof(AssetPackEntry) + pathStrings.size();
+		std::vector<MappedFile> sources(sorted.size());
+		std::uint64_t offset = indexSize;
+		for (unsigned i = 0; i < sorted.size(); ++i)
+		{
+			if (!sources[i].Open(sorted[i]->filePath))
+			{
+				Error("AssetPackWriter: ( %s )\nUnable to open file.", sorted[i]->filePath.c_str());
+				return false;
+			}
+
+			offset = AlignOffset(offset);
+			entries[i].offset = offset;
+			entries[i].size = sources[i].GetSize();
+			offset += sources[i].GetSize();
+		}
+
+		std::ofstream output(std::string(filePath), std::ofstream::binary | std::ofstream::trunc);
+		if (!output)
+		{
+			Error("AssetPackWriter: ( %s )\nUnable to open file for writing.", filePath.data());
+			return false;
+		}
+
+		output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		output.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(AssetPackEntry));
+		output.write(pathStrings.data(), pathStrings.size());
+
+		const char padding[ASSET_PACK_ALIGNMENT] = {};
+		std::uint64_t position = indexSize;
+		for (unsigned i = 0; i < sources.size(); ++i)
+		{
+			output.write(padding, static_cast<std::streamsize>(entries[i].offset - position));
+			output.write(sources[i].GetData(), static_cast<std::streamsize>(sources[i].GetSize()));
+			position = entries[i].offset + entries[i].size;
+		}
+
+		if (!output)
+		{
+			Error("AssetPackWriter: ( %s )\nFailed to write the pack.", filePath.data());
+			return false;
+		}
+
+		return true;
+	}
+
+	unsigned AssetPackWriter::GetNumFiles() const
+	{
+		return static_cast<unsigned>(files.size());
+	}
+
+	bool MountAssetPack(std::string_view filePath)
+	{
+		AssetPack pack;
+		if (!pack.Open(filePath))
+		{
+			return false;
+		}
+
+		mountedPacks.push_back(std::move(pack));
+		return true;
+	}
+
+	void UnmountAssetPacks()
+	{
+		mountedPacks.clear();
+	}
+
+	bool FindPackedAsset(std::string_view path, std::string_view& outContents)
+	{
+		if (mountedPacks.empty())
+		{
+			return false;
+		}
+
+		const std::string normalized = NormalizeAssetPath(path);
+		for (auto itr = mountedPacks.rbegin(); itr != mountedPacks.rend(); ++itr)
+		{
+			if (itr->Find(normalized, outContents))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	LooseAssetScope::LooseAssetScope(bool _isEnabled)
+		: isEnabled(_isEnabled)
+	{
+		if (isEnabled)
+		{
+			++numLooseScopes;
+		}
+	}
+
+	LooseAssetScope::~LooseAssetScope()
+	{
+		if (isEnabled)
+		{
+			--numLooseScopes;
+		}
+	}
+
+	bool AssetFile::Open(std::string_view filePath)
+	{
+		ASSERT(!isOpen, "AssetFile: Already associated with a file.");
+
+		std::string_view relativePath = filePath;
+		if (relativePath.starts_with(RootAssetDirectory))
+		{
+			relativePath.remove_prefix(RootAssetDirectory.size());
+		}
+
+		if (numLooseScopes == 0 && IsPathRelative(relativePath) && FindPackedAsset(relativePath, contents))
+		{
+			isPacked = true;
+		}
+		else if (mapping.Open(filePath))
+		{
+			contents = mapping.GetView();
+		}
+		else
+		{
+			return false;
+		}
+
+		currentPos = 0;
+		isOpen = true;
+		return true;
+	}
+
+	void AssetFile::Close()
+	{
+		mapping.Close();
+		contents = {};
+		currentPos = 0;
+		isOpen = false;
+		isPacked = false;
+	}
+
+	bool AssetFile::IsOpen() const
+	{
+		return isOpen;
+	}
+
+	bool AssetFile::IsPacked() const
+	{
+		return isPacked;
+	}
+
+	bool AssetFile::Read(void* destination, std::size_t size)
+	{
+		if (size > contents.size() - currentPos)
+		{
+			return false;
+		}
+
+		std::memcpy(destination, contents.data() + currentPos, size);
+		currentPos += size;
+		return true;
+	}
+
+	bool AssetFile::ReadView(std::size_t size, std::string_view& outView)
+	{
+		if (size > contents.size() - currentPos)
+		{
+			return false;
+		}
+
+		outView = contents.substr(currentPos, size);
+		currentPos += size;
+		return true;
+	}
+
+	bool AssetFile::Skip(std::size_t size)
+	{
+		if (size > contents.size() - currentPos)
+		{
+			return false;
+		}
+
+		currentPos += size;
+		return true;
+	}
+
+	bool AssetFile::IsEOF() const
+	{
+		return currentPos == contents.size();
+	}
+
+	std::string_view AssetFile::GetContents() const
+	{
+		return contents;
+	}
+}
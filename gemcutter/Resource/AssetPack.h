@@ -0,0 +1,175 @@
+// Copyright (c) 2022 Emilian Cioca
+#pragma once
+#include "gemcutter/Application/FileSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/*
+ Asset packs combine many asset files into a single file, which is memory-mapped once when it is mounted.
+ Loading an asset from a mounted pack is a lookup in the pack's index instead of opening the file from the disk.
+
+ Packs are built from the AssetManager's output directory with the asset_packer tool.
+ Files in a pack are named by their path relative to RootAssetDirectory, such as "Models/Crate.model".
+ An asset is loaded from the newest mounted pack that contains it, and from a loose file otherwise.
+*/
+
+namespace gem
+{
+	// A pack starts with a header, followed by:
+	// - An AssetPackEntry for each file, sorted by the hash of its path.
+	// - The path of each file, without null terminators.
+	// - The contents of each file, each starting on an ASSET_PACK_ALIGNMENT boundary.
+	// All values are stored in the machine's byte order.
+	constexpr char ASSET_PACK_SIGNATURE[8] = { 'G', 'E', 'M', 'P', 'A', 'C', 'K', '\1' };
+	constexpr std::size_t ASSET_PACK_ALIGNMENT = 16;
+
+	struct AssetPackHeader
+	{
+		char signature[8];
+		std::uint32_t numEntries;
+		std::uint32_t pathsSize;
+	};
+
+	struct AssetPackEntry
+	{
+		std::uint64_t pathHash;
+		// The position of the file's contents, from the start of the pack.
+		std::uint64_t offset;
+		std::uint64_t size;
+		// The position of the file's path, from the start of the path strings.
+		std::uint32_t pathOffset;
+		std::uint32_t pathLength;
+	};
+
+	// Converts a relative path to the form it is stored with in a pack.
+	// Backslashes become forward slashes, and any leading "./" is removed.
+	std::string NormalizeAssetPath(std::string_view path);
+
+	// The hash that a normalized path is indexed by in a pack.
+	std::uint64_t HashAssetPath(std::string_view path);
+
+	// A read-only pack file.
+	class AssetPack
+	{
+	public:
+		bool Open(std::string_view filePath);
+		void Close();
+
+		bool IsOpen() const;
+
+		// Searches for a file by its normalized path.
+		// The contents are a view into the pack, and remain valid until the pack is closed.
+		bool Find(std::string_view path, std::string_view& outContents) const;
+
+		unsigned GetNumFiles() const;
+		std::string_view GetPath(unsigned index) const;
+
+	private:
+		MappedFile file;
+		const AssetPackEntry* entries = nullptr;
+		const char* paths = nullptr;
+		unsigned numEntries = 0;
+	};
+
+	// Builds a pack from loose files.
+	class AssetPackWriter
+	{
+	public:
+		// Adds a file to be saved into the pack.
+		// 'packPath' is the path that it will be loaded with, relative to RootAssetDirectory.
+		bool AddFile(std::string_view packPath, std::string_view filePath);
+
+		bool Save(std::string_view filePath) const;
+
+		unsigned GetNumFiles() const;
+
+	private:
+		struct File
+		{
+			std::string packPath;
+			std::string filePath;
+			std::uint64_t pathHash;
+		};
+
+		std::vector<File> files;
+	};
+
+	// Makes the assets in the pack available to all loaders.
+	// Packs should be mounted at startup, before loading any assets. A pack mounted later takes priority.
+	bool MountAssetPack(std::string_view filePath);
+
+	// Closes all mounted packs. Any assets already loaded from them are unaffected.
+	void UnmountAssetPacks();
+
+	// Searches the mounted packs for a file, by its path relative to RootAssetDirectory.
+	bool FindPackedAsset(std::string_view path, std::string_view& outContents);
+
+	// While one exists, AssetFile::Open() ignores the mounted packs on the calling thread, and reads loose files from the disk.
+	// Hot reloading uses this, since a file that changed on the disk is newer than any packed copy of it.
+	class LooseAssetScope
+	{
+	public:
+		explicit LooseAssetScope(bool isEnabled = true);
+		~LooseAssetScope();
+
+		LooseAssetScope(const LooseAssetScope&) = delete;
+		LooseAssetScope& operator=(const LooseAssetScope&) = delete;
+
+	private:
+		bool isEnabled;
+	};
+
+	// Read-only access to the contents of an asset file, for loaders.
+	// The file is read from a mounted pack if possible, or is mapped from the disk otherwise.
+	// Either way, its contents are accessed in place without being copied into a buffer.
+	class AssetFile
+	{
+	public:
+		// Paths starting with RootAssetDirectory, as given to Resource::Load(), are searched for in the mounted packs first.
+		// See LooseAssetScope.
+		bool Open(std::string_view filePath);
+		void Close();
+
+		bool IsOpen() const;
+		// Returns true if the file was found in a mounted pack.
+		bool IsPacked() const;
+
+		// Copies the next bytes into the value. Returns false if the file ends first.
+		template<typename T>
+		bool Read(T& value);
+		bool Read(void* destination, std::size_t size);
+
+		// Returns a view of the next bytes, without copying them. Returns false if the file ends first.
+		// The view remains valid until the file is closed.
+		bool ReadView(std::size_t size, std::string_view& outView);
+
+		// Moves past the next bytes. Returns false if the file ends first.
+		bool Skip(std::size_t size);
+
+		// Returns true if the current position is at the end of the file.
+		bool IsEOF() const;
+
+		// The contents of the whole file.
+		std::string_view GetContents() const;
+
+	private:
+		MappedFile mapping;
+		std::string_view contents;
+		std::size_t currentPos = 0;
+		bool isOpen = false;
+		bool isPacked = false;
+	};
+
+	template<typename T>
+	bool AssetFile::Read(T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be read from an asset file.");
+
+		return Read(&value, sizeof(T));
+	}
+}
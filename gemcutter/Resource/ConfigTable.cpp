@@ -34,30 +34,23 @@ namespace gem
 	bool ConfigTable::Load(std::string_view file)
 	{
 		FileReader input;
-		if (!input.OpenAsBuffer(file))
+		if (!input.OpenAsMapped(file))
 		{
 			return false;
 		}
 
 		while (!input.IsEOF())
 		{
-			std::string line = input.GetLine();
+			std::string_view line = input.GetLineView();
 
 			if (line.empty() || line[0] == ':')
 				continue;
 
 			size_t pos = line.find('=');
-			if (pos == std::string::npos)
+			if (pos == std::string_view::npos)
 				continue;
 
-			std::string leftSide = line.substr(0, pos);
-			std::string rightSide;
-			if (pos != line.size() - 1)
-			{
-				rightSide = line.substr(pos + 1);
-			}
-
-			settings[std::move(leftSide)] = std::move(rightSide);
+			settings[std::string(line.substr(0, pos))] = line.substr(pos + 1);
 		}
 
 		return true;
@@ -3,12 +3,13 @@
 #include "gemcutter/Application/Logging.h"
 #include "gemcutter/Math/Math.h"
 #include "gemcutter/Rendering/Rendering.h"
+#include "gemcutter/Resource/AssetPack.h"
 #include "gemcutter/Resource/Texture.h"
-#include "gemcutter/Utilities/ScopeGuard.h"
 #include "gemcutter/Utilities/String.h"
 
 #include <cstdio>
 #include <glew/glew.h>
+#include <utility>
 
 namespace gem
 {
@@ -101,39 +102,41 @@ namespace gem
 			return false;
 		}
 
-		FILE* fontFile = fopen(filePath.c_str(), "rb");
-		if (fontFile == nullptr)
+		AssetFile fontFile;
+		if (!fontFile.Open(filePath))
 		{
 			Error("Font: ( %s )\nUnable to open file.", filePath.c_str());
 			return false;
 		}
 
-		// Load bitmap data.
+		// Read header.
 		TextureFilter filter;
 		unsigned long int bitmapSize = 0;
-		unsigned char* bitmap = nullptr;
-		defer{ free(bitmap); };
-
-		// Read header.
-		fread(&bitmapSize, sizeof(unsigned long int), 1, fontFile);
-		fread(&width, sizeof(unsigned), 1, fontFile);
-		fread(&height, sizeof(unsigned), 1, fontFile);
-		fread(&filter, sizeof(TextureFilter), 1, fontFile);
-
-		// Load Data.
-		bitmap = static_cast<unsigned char*>(malloc(sizeof(unsigned char) * bitmapSize));
-		fread(bitmap, sizeof(unsigned char), bitmapSize, fontFile);
-		fread(dimensions, sizeof(CharData), 94, fontFile);
-		fread(positions, sizeof(CharData), 94, fontFile);
-		fread(advances, sizeof(CharData), 94, fontFile);
-		fread(masks, sizeof(bool), 94, fontFile);
+		if (!fontFile.Read(bitmapSize) ||
+			!fontFile.Read(width) ||
+			!fontFile.Read(height) ||
+			!fontFile.Read(filter))
+		{
+			Error("Font: ( %s )\nInvalid file header.", filePath.c_str());
+			return false;
+		}
 
-		fclose(fontFile);
+		// Load Data. The bitmaps are uploaded straight from the file.
+		std::string_view bitmap;
+		if (!fontFile.ReadView(bitmapSize, bitmap) ||
+			!fontFile.Read(dimensions) ||
+			!fontFile.Read(positions) ||
+			!fontFile.Read(advances) ||
+			!fontFile.Read(masks))
+		{
+			Error("Font: ( %s )\nThe file ends before the character data.", filePath.c_str());
+			return false;
+		}
 
 		// Upload data to OpenGL.
 		glGenTextures(94, textures);
 
-		unsigned char* bitmapItr = bitmap;
+		const char* bitmapItr = bitmap.data();
 		for (unsigned i = 0; i < 94; ++i)
 		{
 			if (!masks[i])
@@ -177,6 +180,17 @@ namespace gem
 		memset(textures, GL_NONE, sizeof(unsigned) * 94);
 	}
 
+	void Font::SwapContents(Font& other)
+	{
+		std::swap(textures, other.textures);
+		std::swap(dimensions, other.dimensions);
+		std::swap(positions, other.positions);
+		std::swap(advances, other.advances);
+		std::swap(masks, other.masks);
+		std::swap(width, other.width);
+		std::swap(height, other.height);
+	}
+
 	int Font::GetStringWidth(std::string_view text) const
 	{
 		int length = 0;
@@ -25,6 +25,9 @@ namespace gem
 		bool Load(std::string filePath);
 		void Unload();
 
+		// Exchanges the glyphs of the two fonts, so a reloaded font can replace this one in place.
+		void SwapContents(Font& other);
+
 		// Returns the real world unit width of the string.
 		// If the string is multi-line, the length of the longest line is returned.
 		int GetStringWidth(std::string_view text) const;
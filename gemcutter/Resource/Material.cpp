@@ -1,10 +1,11 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Material.h"
 #include "gemcutter/Application/Logging.h"
-#include "gemcutter/Utilities/ScopeGuard.h"
+#include "gemcutter/Resource/AssetPack.h"
 #include "gemcutter/Utilities/String.h"
 
 #include <dirent/dirent.h>
+#include <utility>
 
 namespace gem
 {
@@ -21,43 +22,43 @@ namespace gem
 			return false;
 		}
 
-		// Load binary file.
-		FILE* binaryFile = fopen(filePath.c_str(), "rb");
-		if (binaryFile == nullptr)
+		AssetFile binaryFile;
+		if (!binaryFile.Open(filePath))
 		{
 			Error("Material: ( %s )\nUnable to open file.", filePath.c_str());
 			return false;
 		}
-		defer{ fclose(binaryFile); };
-
-		char pathBuffer[MAX_PATH + 1];
 
 		size_t shaderLen = 0;
-		fread(&shaderLen, sizeof(size_t), 1, binaryFile);
+		if (!binaryFile.Read(shaderLen))
+		{
+			Error("Material: ( %s )\nInvalid file header.", filePath.c_str());
+			return false;
+		}
+
 		if (shaderLen == 0)
 		{
 			shader = Shader::MakeNewPassThrough();
 		}
 		else
 		{
-			if (shaderLen > MAX_PATH)
+			std::string_view shaderPath;
+			if (shaderLen > MAX_PATH || !binaryFile.ReadView(shaderLen, shaderPath))
 			{
 				Error("Material: ( %s )\nInvalid Shader file path length.", filePath.c_str());
 				return false;
 			}
-			fread(pathBuffer, sizeof(char), shaderLen, binaryFile);
-			pathBuffer[shaderLen] = '\0';
 
-			shader = gem::Load<Shader>(pathBuffer);
+			shader = gem::Load<Shader>(std::string(shaderPath));
 			if (!shader)
 			{
-				Error("Material: ( %s )\nFailed to load Shader ( %s ).", filePath.c_str(), pathBuffer);
+				Error("Material: ( %s )\nFailed to load Shader ( %.*s ).", filePath.c_str(), static_cast<int>(shaderPath.size()), shaderPath.data());
 				return false;
 			}
 		}
 
 		size_t textureCount = 0;
-		fread(&textureCount, sizeof(size_t), 1, binaryFile);
+		binaryFile.Read(textureCount);
 		if (textureCount > GPUInfo.GetMaxTextureSlots())
 		{
 			Error("Material: ( %s )\nMaterial contains more texture units than is supported ( %d ).", filePath.c_str(), GPUInfo.GetMaxTextureSlots());
@@ -67,33 +68,45 @@ namespace gem
 		for (size_t i = 0; i < textureCount; ++i)
 		{
 			int unit = 0;
-			fread(&unit, sizeof(int), 1, binaryFile);
+			binaryFile.Read(unit);
 
 			size_t textureLen = 0;
-			fread(&textureLen, sizeof(size_t), 1, binaryFile);
-			if (textureLen == 0 || textureLen > MAX_PATH)
+			std::string_view texturePath;
+			if (!binaryFile.Read(textureLen) ||
+				textureLen == 0 || textureLen > MAX_PATH ||
+				!binaryFile.ReadView(textureLen, texturePath))
 			{
 				Error("Material: ( %s )\nInvalid Texture file path length.", filePath.c_str());
 				return false;
 			}
 
-			fread(pathBuffer, sizeof(char), textureLen, binaryFile);
-			pathBuffer[textureLen] = '\0';
-
-			auto texture = gem::Load<Texture>(pathBuffer);
+			auto texture = gem::Load<Texture>(std::string(texturePath));
 			if (!texture)
 			{
-				Error("Material: ( %s )\nFailed to load Texture ( %s ).", filePath.c_str(), pathBuffer);
+				Error("Material: ( %s )\nFailed to load Texture ( %.*s ).", filePath.c_str(), static_cast<int>(texturePath.size()), texturePath.data());
 				return false;
 			}
 
 			textures.Add(std::move(texture), unit);
 		}
 
-		fread(&blendMode, sizeof(BlendFunc), 1, binaryFile);
-		fread(&depthMode, sizeof(DepthFunc), 1, binaryFile);
-		fread(&cullMode, sizeof(CullFunc), 1, binaryFile);
+		if (!binaryFile.Read(blendMode) ||
+			!binaryFile.Read(depthMode) ||
+			!binaryFile.Read(cullMode))
+		{
+			Error("Material: ( %s )\nThe file ends before the render states.", filePath.c_str());
+			return false;
+		}
 
 		return true;
 	}
+
+	void Material::SwapContents(Material& other)
+	{
+		std::swap(blendMode, other.blendMode);
+		std::swap(depthMode, other.depthMode);
+		std::swap(cullMode, other.cullMode);
+		std::swap(shader, other.shader);
+		std::swap(textures, other.textures);
+	}
 }
@@ -19,6 +19,9 @@ namespace gem
 
 		bool Load(std::string filePath);
 
+		// Exchanges the render states, shader, and textures of the two materials, so a reloaded material can replace this one in place.
+		void SwapContents(Material& other);
+
 		BlendFunc blendMode = BlendFunc::None;
 		DepthFunc depthMode = DepthFunc::Normal;
 		CullFunc cullMode = CullFunc::Clockwise;
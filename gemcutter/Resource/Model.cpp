@@ -1,11 +1,26 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Model.h"
 #include "gemcutter/Application/Logging.h"
+#include "gemcutter/Resource/AssetPack.h"
 #include "gemcutter/Utilities/ScopeGuard.h"
 #include "gemcutter/Utilities/String.h"
 
+#include <utility>
+
 namespace gem
 {
+	struct Model::Staging
+	{
+		AssetFile file;
+		std::string_view vertexData;
+		VertexBufferUsage usage;
+		int numVertices;
+		int stride;
+	};
+
+	Model::Model() = default;
+	Model::~Model() = default;
+
 	bool Model::Load(std::string filePath)
 	{
 		return Load(std::move(filePath), VertexBufferUsage::Static);
@@ -13,6 +28,13 @@ namespace gem
 
 	bool Model::Load(std::string filePath, VertexBufferUsage usage)
 	{
+		return Decode(std::move(filePath), usage) && Upload();
+	}
+
+	bool Model::Decode(std::string filePath, VertexBufferUsage usage)
+	{
+		ASSERT(!staging, "Model: Already holds a decoded file.");
+
 		auto ext = ExtractFileExtension(filePath);
 		if (ext.empty())
 		{
@@ -24,22 +46,26 @@ namespace gem
 			return false;
 		}
 
-		// Load binary file.
-		FILE* binaryFile = fopen(filePath.c_str(), "rb");
-		if (binaryFile == nullptr)
+		auto data = std::make_unique<Staging>();
+		AssetFile& binaryFile = data->file;
+		if (!binaryFile.Open(filePath))
 		{
 			Error("Model: ( %s )\nUnable to open file.", filePath.c_str());
 			return false;
 		}
-		defer { fclose(binaryFile); };
 
-		int numVertices;
-		fread(&minBounds, sizeof(vec3), 1, binaryFile);
-		fread(&maxBounds, sizeof(vec3), 1, binaryFile);
-		fread(&hasUvs, sizeof(bool), 1, binaryFile);
-		fread(&hasNormals, sizeof(bool), 1, binaryFile);
-		fread(&hasTangents, sizeof(bool), 1, binaryFile);
-		fread(&numVertices, sizeof(int), 1, binaryFile);
+		int numVertices = 0;
+		if (!binaryFile.Read(minBounds) ||
+			!binaryFile.Read(maxBounds) ||
+			!binaryFile.Read(hasUvs) ||
+			!binaryFile.Read(hasNormals) ||
+			!binaryFile.Read(hasTangents) ||
+			!binaryFile.Read(numVertices) ||
+			numVertices < 0)
+		{
+			Error("Model: ( %s )\nInvalid file header.", filePath.c_str());
+			return false;
+		}
 
 		// Determine mesh properties.
 		int bufferSize = numVertices * 3;
@@ -60,13 +86,30 @@ namespace gem
 			stride += sizeof(float) * 4;
 		}
 
-		auto buffer = VertexBuffer::MakeNew(sizeof(float) * bufferSize, usage, VertexBufferType::Data);
-
-		{ // Read the data buffer from the file.
-			auto mapping = buffer->MapBuffer(VertexAccess::WriteOnly);
-			fread(mapping.GetPtr(), sizeof(float), bufferSize, binaryFile);
+		// The vertex data is uploaded straight from the file.
+		if (!binaryFile.ReadView(sizeof(float) * bufferSize, data->vertexData))
+		{
+			Error("Model: ( %s )\nThe file ends before the vertex data.", filePath.c_str());
+			return false;
 		}
 
+		data->usage = usage;
+		data->numVertices = numVertices;
+		data->stride = stride;
+		staging = std::move(data);
+
+		return true;
+	}
+
+	bool Model::Upload()
+	{
+		ASSERT(staging, "Model: Decode() must succeed before calling Upload().");
+		defer { staging.reset(); };
+
+		const auto size = static_cast<unsigned>(staging->vertexData.size());
+		auto buffer = VertexBuffer::MakeNew(size, staging->usage, VertexBufferType::Data);
+		buffer->SetData(0, size, staging->vertexData.data());
+
 		// Enable vertex attribute streams.
 		VertexStream stream = {};
 		stream.buffer       = std::move(buffer);
@@ -74,7 +117,7 @@ namespace gem
 		stream.format       = VertexFormat::Vec3;
 		stream.normalized   = false;
 		stream.startOffset  = 0;
-		stream.stride       = stride;
+		stream.stride       = staging->stride;
 
 		AddStream(stream);
 		stream.startOffset += sizeof(float) * 3;
@@ -103,11 +146,22 @@ namespace gem
 			AddStream(stream);
 		}
 
-		SetVertexCount(numVertices);
+		SetVertexCount(staging->numVertices);
 
 		return true;
 	}
 
+	void Model::SwapContents(Model& other)
+	{
+		VertexArray::SwapContents(other);
+
+		std::swap(minBounds, other.minBounds);
+		std::swap(maxBounds, other.maxBounds);
+		std::swap(hasUvs, other.hasUvs);
+		std::swap(hasNormals, other.hasNormals);
+		std::swap(hasTangents, other.hasTangents);
+	}
+
 	const vec3& Model::GetMinBounds() const
 	{
 		return minBounds;
@@ -4,6 +4,8 @@
 #include "gemcutter/Resource/Resource.h"
 #include "gemcutter/Resource/VertexArray.h"
 
+#include <memory>
+
 namespace gem
 {
 	// A 3D model resource. Can be attached to an Entity's Mesh component.
@@ -16,10 +18,22 @@ namespace gem
 	class Model : public VertexArray, public Resource<Model>
 	{
 	public:
+		Model();
+		~Model();
+
 		// Loads pre-packed *.model resources.
 		bool Load(std::string filePath);
 		bool Load(std::string filePath, VertexBufferUsage usage);
 
+		// The two halves of Load(), used by LoadAsync().
+		// Decode() reads the file without touching the graphics context, so it can run on any thread.
+		bool Decode(std::string filePath, VertexBufferUsage usage = VertexBufferUsage::Static);
+		// Creates the vertex streams from the decoded file. Must be called from the main thread.
+		bool Upload();
+
+		// Exchanges the loaded meshes of the two models, so a reloaded model can replace this one in place.
+		void SwapContents(Model& other);
+
 		// Returns the extents of each axis in local-space.
 		const vec3& GetMinBounds() const;
 		const vec3& GetMaxBounds() const;
@@ -29,6 +43,10 @@ namespace gem
 		bool HasTangents() const;
 
 	private:
+		// The file's contents, held between Decode() and Upload().
+		struct Staging;
+		std::unique_ptr<Staging> staging;
+
 		vec3 minBounds;
 		vec3 maxBounds;
 
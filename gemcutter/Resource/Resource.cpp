@@ -1,7 +1,182 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Resource.h"
+#include "gemcutter/Application/FileWatcher.h"
+#include "gemcutter/Application/Timer.h"
+#include "gemcutter/Resource/AssetPack.h"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	std::mutex uploadLock;
+	std::deque<gem::JobFunction> uploads;
+
+	std::atomic<double> uploadBudgetMS = 2.0;
+
+	std::atomic<unsigned> resourceFrame = 0;
+
+	// Constructed on first use, since the caches register themselves during static initialization.
+	struct CacheRegistry
+	{
+		std::mutex lock;
+		std::vector<gem::detail::ResourceCacheBase*> caches;
+	};
+
+	CacheRegistry& GetCacheRegistry()
+	{
+		static CacheRegistry registry;
+		return registry;
+	}
+
+	gem::FileWatcher assetWatcher;
+	std::vector<std::string> changedFiles;
+}
 
 namespace gem
 {
 	std::string RootAssetDirectory = "./";
+
+	namespace detail
+	{
+		void QueueResourceUpload(JobFunction upload)
+		{
+			std::lock_guard guard(uploadLock);
+			uploads.push_back(std::move(upload));
+		}
+
+		bool RunResourceUpload()
+		{
+			JobFunction upload;
+			{
+				std::lock_guard guard(uploadLock);
+				if (uploads.empty())
+				{
+					return false;
+				}
+
+				upload = std::move(uploads.front());
+				uploads.pop_front();
+			}
+
+			upload();
+			return true;
+		}
+
+		unsigned GetResourceFrame()
+		{
+			return resourceFrame.load(std::memory_order_relaxed);
+		}
+
+		ResourceCacheBase::ResourceCacheBase()
+		{
+			CacheRegistry& registry = GetCacheRegistry();
+			std::lock_guard guard(registry.lock);
+			registry.caches.push_back(this);
+		}
+
+		ResourceCacheBase::~ResourceCacheBase()
+		{
+			CacheRegistry& registry = GetCacheRegistry();
+			std::lock_guard guard(registry.lock);
+			registry.caches.erase(std::find(registry.caches.begin(), registry.caches.end(), this));
+		}
+	}
+
+	void ProcessResourceUploads()
+	{
+		ASSERT(!JobSystem.IsRunning() || JobSystem.IsMainThread(), "Resource uploads must be processed from the main thread.");
+
+		const double budget = uploadBudgetMS.load(std::memory_order_relaxed);
+		const Timer timer;
+		while (detail::RunResourceUpload())
+		{
+			if (timer.IsElapsedMS(budget))
+			{
+				break;
+			}
+		}
+	}
+
+	void SetResourceUploadBudget(double milliseconds)
+	{
+		ASSERT(milliseconds >= 0.0, "'milliseconds' cannot be negative.");
+
+		uploadBudgetMS = milliseconds;
+	}
+
+	double GetResourceUploadBudget()
+	{
+		return uploadBudgetMS;
+	}
+
+	unsigned GetNumPendingResourceUploads()
+	{
+		std::lock_guard guard(uploadLock);
+		return static_cast<unsigned>(uploads.size());
+	}
+
+	void EnforceResourceBudgets()
+	{
+		ASSERT(!JobSystem.IsRunning() || JobSystem.IsMainThread(), "Resource budgets must be enforced from the main thread.");
+
+		CacheRegistry& registry = GetCacheRegistry();
+		std::lock_guard guard(registry.lock);
+		for (detail::ResourceCacheBase* cache : registry.caches)
+		{
+			cache->EnforceBudget();
+		}
+
+		resourceFrame.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	bool EnableHotReload()
+	{
+		if (assetWatcher.IsWatching())
+		{
+			return true;
+		}
+
+		return assetWatcher.Start(RootAssetDirectory);
+	}
+
+	void DisableHotReload()
+	{
+		assetWatcher.Stop();
+	}
+
+	bool IsHotReloadEnabled()
+	{
+		return assetWatcher.IsWatching();
+	}
+
+	void ReloadChangedResources()
+	{
+		ASSERT(!JobSystem.IsRunning() || JobSystem.IsMainThread(), "Resources must be reloaded from the main thread.");
+
+		if (!assetWatcher.IsWatching())
+		{
+			return;
+		}
+
+		changedFiles.clear();
+		assetWatcher.PollChanges(changedFiles);
+		if (changedFiles.empty())
+		{
+			return;
+		}
+
+		CacheRegistry& registry = GetCacheRegistry();
+		std::lock_guard guard(registry.lock);
+		for (const std::string& changedFile : changedFiles)
+		{
+			const std::string normalized = NormalizeAssetPath(changedFile);
+			for (detail::ResourceCacheBase* cache : registry.caches)
+			{
+				cache->OnFileChanged(normalized);
+			}
+		}
+	}
 }
@@ -2,19 +2,116 @@
 #pragma once
 #include "gemcutter/Application/FileSystem.h"
 #include "gemcutter/Application/Logging.h"
-#include "gemcutter/Utilities/Container.h"
+#include "gemcutter/Application/Profiler.h"
+#include "gemcutter/Application/Threading.h"
+#include "gemcutter/Resource/ResourceCache.h"
 
+#include <cstddef>
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <thread>
 
 namespace gem
 {
 	extern std::string RootAssetDirectory;
 
+	template<class Asset>
+	class Resource;
+
+	namespace detail
+	{
+		// Queues the final step of an asynchronous load for the main thread.
+		void QueueResourceUpload(JobFunction upload);
+
+		// Runs the oldest queued upload. Returns false if there were none.
+		bool RunResourceUpload();
+
+		// Blocks until the state has finished loading, and returns the asset if it succeeded.
+		// The main thread runs queued uploads while it waits, since the load might depend on one of them.
+		// Other threads ask the main thread to run the uploads with a main thread job, and help with other jobs in the meantime.
+		// This way, the main thread can't be stuck waiting on a job which is itself waiting for an upload.
+		template<class Asset>
+		std::shared_ptr<Asset> WaitForLoad(const LoadState<Asset>& state)
+		{
+			if (!JobSystem.IsRunning() || JobSystem.IsMainThread())
+			{
+				while (state.status.load(std::memory_order_acquire) == LoadStatus::Loading)
+				{
+					if (!RunResourceUpload())
+					{
+						std::this_thread::yield();
+					}
+				}
+			}
+			else
+			{
+				while (state.status.load(std::memory_order_acquire) == LoadStatus::Loading)
+				{
+					// The upload might not be queued yet if the asset is still being decoded, in which case we try again.
+					JobCounter counter;
+					JobSystem.Run([&state]() {
+						while (state.status.load(std::memory_order_acquire) == LoadStatus::Loading && RunResourceUpload()) {}
+					}, &counter, JobAffinity::MainThread);
+
+					JobSystem.Wait(counter);
+				}
+			}
+
+			return state.status.load(std::memory_order_acquire) == LoadStatus::Loaded ? state.asset : nullptr;
+		}
+	}
+
+	// The result of LoadAsync(). Can be copied, and polled from any thread.
+	// Every future for the same file shares the same load.
+	template<class Asset>
+	class ResourceFuture
+	{
+		friend Resource<Asset>;
+	public:
+		ResourceFuture() = default;
+
+		// Returns true if the future is associated with a load.
+		bool IsValid() const { return load != nullptr; }
+
+		// Returns true once the load has finished, whether or not it succeeded.
+		bool IsReady() const { return GetStatus() != LoadStatus::Loading; }
+
+		LoadStatus GetStatus() const
+		{
+			ASSERT(load, "ResourceFuture: Not associated with a load.");
+
+			return load->status.load(std::memory_order_acquire);
+		}
+
+		// Returns the asset if it has finished loading, or null otherwise.
+		std::shared_ptr<Asset> Get() const
+		{
+			return GetStatus() == LoadStatus::Loaded ? load->asset : nullptr;
+		}
+
+		// Blocks until the load has finished, and returns the asset. Returns null if the asset failed to load.
+		// On the main thread, queued uploads are run in the meantime regardless of the upload budget.
+		std::shared_ptr<Asset> Wait() const
+		{
+			ASSERT(load, "ResourceFuture: Not associated with a load.");
+
+			return detail::WaitForLoad(*load);
+		}
+
+	private:
+		explicit ResourceFuture(std::shared_ptr<detail::LoadState<Asset>> _load)
+			: load(std::move(_load))
+		{
+		}
+
+		std::shared_ptr<detail::LoadState<Asset>> load;
+	};
+
 	// Base resource class. Provides an interface for cached loading.
 	template<class Asset>
 	class Resource
 	{
+		friend detail::ResourceCache<Asset>;
 	protected:
 		Resource() = default;
 
@@ -24,22 +121,44 @@ namespace gem
 
 		// Loads an asset from the specified file, if it wasn't loaded already.
 		// Calls the derived class's Load() with the file path and any other arguments.
+		// Relative paths are read from the mounted asset packs if they contain the file. See AssetPack.h.
+		// If the file is already being loaded, this waits for that load instead.
+		// Can be called from any thread. While the JobSystem is running, only the main thread may touch the graphics
+		// and audio contexts, so other threads only run Decode() and then wait for the main thread to finish the asset.
+		// Assets which can't be decoded separately are loaded entirely on the main thread. See WaitForLoad().
 		template<typename... Args>
 		static std::shared_ptr<Asset> Load(std::string filePath, Args&&... params)
 		{
-			if (IsPathRelative(filePath))
-			{
-				filePath = RootAssetDirectory + filePath;
-			}
-			else
+			ResolvePath(filePath);
+
+			bool isNew = false;
+			auto state = resourceCache.FindOrAdd(filePath, isNew);
+			if (!isNew)
 			{
-				Warning("Asset loaded with an absolute path. To ensure proper asset caching, it is recommended to use only relative paths.");
+				// Loaded already, or being loaded elsewhere.
+				return detail::WaitForLoad(*state);
 			}
 
-			// Search for the cached asset.
-			if (auto ptr = Find(filePath))
+			GEM_PROFILE_SCOPE("Resource::Load");
+
+			state->filePath = filePath;
+			SetLoader(*state, params...);
+
+			// The main thread finishes the asset, since it owns the graphics and audio contexts.
+			if (JobSystem.IsRunning() && !JobSystem.IsMainThread())
 			{
-				return ptr;
+				state->asset = std::make_shared<Asset>();
+				if (state->decode)
+				{
+					state->isDecoded = state->decode(*state->asset, state->filePath);
+				}
+				else
+				{
+					state->isDecoded = true;
+				}
+
+				detail::QueueResourceUpload([state]() { FinishAsync(*state); });
+				return detail::WaitForLoad(*state);
 			}
 
 			// Create the new asset.
@@ -48,41 +167,257 @@ namespace gem
 			if (!resourcePtr->Load(filePath, std::forward<Args>(params)...))
 			{
 				// Error loading file.
+				resourceCache.Remove(filePath, *state);
+				Publish(*state, LoadStatus::Failed);
 				return nullptr;
 			}
 
-			// Add new asset to cache.
-			resourceCache.insert(std::pair(std::move(filePath), resourcePtr));
+			state->asset = resourcePtr;
+			resourceCache.SetMemoryUsage(filePath, *state, detail::MeasureMemoryUsage(*resourcePtr));
+			Publish(*state, LoadStatus::Loaded);
 
 			return resourcePtr;
 		}
 
+		// Like Load(), but returns immediately without waiting for the asset.
+		// Assets which split their Load() into Decode() and Upload() are read and decoded by the JobSystem.
+		// Decode() must not touch the graphics or audio context, since it runs on a worker thread.
+		// Upload() then finishes the asset on the main thread, during ProcessResourceUploads().
+		// Other assets are loaded entirely on the main thread, during ProcessResourceUploads().
+		template<typename... Args>
+		static ResourceFuture<Asset> LoadAsync(std::string filePath, Args&&... params)
+		{
+			ResolvePath(filePath);
+
+			bool isNew = false;
+			auto load = resourceCache.FindOrAdd(filePath, isNew);
+			if (!isNew)
+			{
+				return ResourceFuture<Asset>(std::move(load));
+			}
+
+			load->filePath = std::move(filePath);
+			load->asset = std::make_shared<Asset>();
+			SetLoader(*load, params...);
+			Schedule(load, nullptr);
+
+			return ResourceFuture<Asset>(std::move(load));
+		}
+
 		// Searches for a loaded asset previously loaded from the specified file path.
+		// Assets which are still loading are not returned.
 		static std::shared_ptr<Asset> Find(std::string_view filePath)
 		{
-			auto itr = resourceCache.find(filePath);
-			if (itr == resourceCache.end())
+			auto state = resourceCache.Find(filePath);
+			if (!state || state->status.load(std::memory_order_acquire) != LoadStatus::Loaded)
 			{
 				return nullptr;
 			}
 			else
 			{
-				return itr->second;
+				return state->asset;
 			}
 		}
 
 		// Clears the asset cache. An asset will need to load from file again after this call.
+		// Loads which are still in progress will finish, but won't be added to the cache.
 		static void UnloadAll()
 		{
-			resourceCache.clear();
+			resourceCache.Clear();
+		}
+
+		// Unloads the cached assets which are not referenced anywhere else. Returns the number of assets unloaded.
+		// Must be called from the main thread.
+		static unsigned UnloadUnused()
+		{
+			return resourceCache.EvictUnused(0);
+		}
+
+		// Limits the memory used by the cached assets of this type. Zero removes the limit, which is the default.
+		// While over budget, the least recently used assets which are not referenced outside the cache are unloaded.
+		// The budget is checked once per frame, by EnforceResourceBudgets().
+		static void SetMemoryBudget(std::size_t bytes)
+		{
+			resourceCache.SetMemoryBudget(bytes);
+		}
+
+		static ResourceStats GetStats()
+		{
+			return resourceCache.GetStats();
 		}
 
 	private:
-		static std::unordered_map<std::string, std::shared_ptr<Asset>, string_hash, std::equal_to<>> resourceCache;
+		static void ResolvePath(std::string& filePath)
+		{
+			if (IsPathRelative(filePath))
+			{
+				filePath = RootAssetDirectory + filePath;
+			}
+			else
+			{
+				Warning("Asset loaded with an absolute path. To ensure proper asset caching, it is recommended to use only relative paths.");
+			}
+		}
+
+		// Records how to load the asset, so it can be loaded asynchronously or reloaded later.
+		template<typename... Args>
+		static void SetLoader(detail::LoadState<Asset>& state, Args&... params)
+		{
+			if constexpr (requires(Asset& asset) { asset.Decode(state.filePath, params...); asset.Upload(); })
+			{
+				state.decode = [...params = params](Asset& asset, const std::string& path) mutable {
+					return asset.Decode(path, params...);
+				};
+				state.upload = [](Asset& asset, const std::string&) {
+					return asset.Upload();
+				};
+			}
+			else
+			{
+				state.upload = [...params = params](Asset& asset, const std::string& path) mutable {
+					return asset.Load(path, params...);
+				};
+			}
+		}
+
+		// Decodes the asset on a worker thread if it supports it, then finishes it on the main thread.
+		// If 'previous' is set, the new asset replaces it once it has loaded. See FinishReload().
+		static void Schedule(std::shared_ptr<detail::LoadState<Asset>> load, std::shared_ptr<detail::LoadState<Asset>> previous)
+		{
+			if (load->decode)
+			{
+				JobSystem.Run([load = std::move(load), previous = std::move(previous)]() {
+					{
+						GEM_PROFILE_SCOPE("Resource::Decode");
+						// Reloads read the changed file, not its copy in a mounted pack.
+						const LooseAssetScope loose(previous != nullptr);
+						load->isDecoded = load->decode(*load->asset, load->filePath);
+					}
+
+					detail::QueueResourceUpload([load, previous]() { Finish(load, previous); });
+				});
+			}
+			else
+			{
+				load->isDecoded = true;
+				detail::QueueResourceUpload([load = std::move(load), previous = std::move(previous)]() { Finish(load, previous); });
+			}
+		}
+
+		static void Finish(const std::shared_ptr<detail::LoadState<Asset>>& load, const std::shared_ptr<detail::LoadState<Asset>>& previous)
+		{
+			if (previous)
+			{
+				FinishReload(load, previous);
+			}
+			else
+			{
+				FinishAsync(*load);
+			}
+		}
+
+		// Completes an asynchronous load on the main thread.
+		static void FinishAsync(detail::LoadState<Asset>& load)
+		{
+			GEM_PROFILE_SCOPE("Resource::Upload");
+
+			if (load.isDecoded && load.upload(*load.asset, load.filePath))
+			{
+				resourceCache.SetMemoryUsage(load.filePath, load, detail::MeasureMemoryUsage(*load.asset));
+				Publish(load, LoadStatus::Loaded);
+			}
+			else
+			{
+				// The asset is released here, since its destructor might need the main thread.
+				resourceCache.Remove(load.filePath, load);
+				load.asset.reset();
+				Publish(load, LoadStatus::Failed);
+			}
+		}
+
+		// Loads a new version of a cached asset whose file has changed. Must be called from the main thread.
+		static void Reload(const std::shared_ptr<detail::LoadState<Asset>>& current)
+		{
+			if (current->isReloading)
+			{
+				current->isReloadQueued = true;
+				return;
+			}
+
+			current->isReloading = true;
+
+			auto reload = std::make_shared<detail::LoadState<Asset>>();
+			reload->filePath = current->filePath;
+			reload->decode = current->decode;
+			reload->upload = current->upload;
+			reload->asset = std::make_shared<Asset>();
+
+			Schedule(std::move(reload), current);
+		}
+
+		// Finishes a reload on the main thread, between frames.
+		// Assets with a SwapContents() function take on the new contents in place, so everything holding them sees the new version.
+		// Other assets are replaced in the cache, and holders of the previous version keep it until they call Load() or Find() again.
+		static void FinishReload(const std::shared_ptr<detail::LoadState<Asset>>& reload, const std::shared_ptr<detail::LoadState<Asset>>& previous)
+		{
+			GEM_PROFILE_SCOPE("Resource::Reload");
+
+			previous->isReloading = false;
+
+			// Assets loaded all at once read the changed file here, not its copy in a mounted pack.
+			const LooseAssetScope loose;
+
+			bool isReplaced = false;
+			if (reload->isDecoded && reload->upload(*reload->asset, reload->filePath))
+			{
+				if constexpr (requires(Asset& asset) { asset.SwapContents(asset); })
+				{
+					previous->asset->SwapContents(*reload->asset);
+					resourceCache.SetMemoryUsage(previous->filePath, *previous, detail::MeasureMemoryUsage(*previous->asset));
+
+					// The previous contents are released here, since their destructor might need the main thread.
+					reload->asset.reset();
+					Log("Resource: ( %s )\nReloaded.", reload->filePath.c_str());
+				}
+				else
+				{
+					const std::size_t memoryUsage = detail::MeasureMemoryUsage(*reload->asset);
+					Publish(*reload, LoadStatus::Loaded);
+
+					// The asset might have been unloaded in the meantime.
+					isReplaced = resourceCache.Replace(reload->filePath, *previous, reload, memoryUsage);
+					if (isReplaced)
+					{
+						Log("Resource: ( %s )\nReloaded.", reload->filePath.c_str());
+					}
+				}
+			}
+			else
+			{
+				reload->asset.reset();
+				Publish(*reload, LoadStatus::Failed);
+				Warning("Resource: ( %s )\nFailed to reload. The previous version is still in use.", reload->filePath.c_str());
+			}
+
+			if (previous->isReloadQueued)
+			{
+				previous->isReloadQueued = false;
+				Reload(isReplaced ? reload : previous);
+			}
+		}
+
+		// Ends a load, waking up anyone waiting for it.
+		static void Publish(detail::LoadState<Asset>& state, LoadStatus status)
+		{
+			state.status.store(status, std::memory_order_release);
+			state.status.notify_all();
+		}
+
+		static detail::ResourceCache<Asset> resourceCache;
 	};
 
 	template<class Asset>
-	std::unordered_map<std::string, std::shared_ptr<Asset>, string_hash, std::equal_to<>> Resource<Asset>::resourceCache;
+	detail::ResourceCache<Asset> Resource<Asset>::resourceCache;
 
 	// Helper function to load an asset.
 	template<class Asset, typename... Args>
@@ -91,10 +426,65 @@ namespace gem
 		return Resource<Asset>::Load(filePath, std::forward<Args>(params)...);
 	}
 
+	// Helper function to load an asset asynchronously.
+	template<class Asset, typename... Args>
+	ResourceFuture<Asset> LoadAsync(const std::string& filePath, Args&&... params)
+	{
+		return Resource<Asset>::LoadAsync(filePath, std::forward<Args>(params)...);
+	}
+
 	// Helper function to unload all managed instances of an asset.
 	template<class Asset>
 	void UnloadAll()
 	{
 		Resource<Asset>::UnloadAll();
 	}
+
+	// Helper function to unload the assets which are only referenced by the cache.
+	template<class Asset>
+	unsigned UnloadUnused()
+	{
+		return Resource<Asset>::UnloadUnused();
+	}
+
+	// Helper function to limit the memory used by the cached assets of a type.
+	template<class Asset>
+	void SetResourceBudget(std::size_t bytes)
+	{
+		Resource<Asset>::SetMemoryBudget(bytes);
+	}
+
+	// Helper function to get the memory usage and activity of the cached assets of a type.
+	template<class Asset>
+	ResourceStats GetResourceStats()
+	{
+		return Resource<Asset>::GetStats();
+	}
+
+	// Runs queued uploads of assets loaded with LoadAsync(), until the upload budget for the frame is spent.
+	// At least one upload is run each time, so loading always makes progress. Called once per frame by the Application.
+	void ProcessResourceUploads();
+
+	// The time, in milliseconds, that ProcessResourceUploads() may spend each frame.
+	void SetResourceUploadBudget(double milliseconds);
+	double GetResourceUploadBudget();
+
+	// Returns the number of asynchronous loads waiting for the main thread.
+	unsigned GetNumPendingResourceUploads();
+
+	// Watches RootAssetDirectory for changes, and reloads the cached assets whose files have changed.
+	// New versions are decoded in the background if possible, then replace the cached versions during ProcessResourceUploads().
+	// Assets with a SwapContents() function, such as Textures, Models, Shaders, Materials and Fonts, are updated in place.
+	// For other assets, anything holding on to the previous version keeps it until it calls Load() or Find() again.
+	// New versions are always read from the loose files, even if the assets were first loaded from a mounted pack.
+	bool EnableHotReload();
+	void DisableHotReload();
+	bool IsHotReloadEnabled();
+
+	// Starts reloading the cached assets whose files have changed since the last call. Called once per frame by the Application.
+	void ReloadChangedResources();
+
+	// Unloads the least recently used assets of each type that is over its memory budget.
+	// Also advances the frame used to determine which assets were used least recently. Called once per frame by the Application.
+	void EnforceResourceBudgets();
 }
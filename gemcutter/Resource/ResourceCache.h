@@ -0,0 +1,439 @@
+// Copyright (c) 2022 Emilian Cioca
+#pragma once
+#include "gemcutter/Resource/AssetPack.h"
+#include "gemcutter/Utilities/Container.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace gem
+{
+	enum class LoadStatus
+	{
+		Loading,
+		Loaded,
+		Failed
+	};
+
+	// The memory usage and activity of the cached assets of one type.
+	struct ResourceStats
+	{
+		unsigned numAssets = 0;
+		std::size_t memoryUsage = 0;
+		// Zero if the cache has no budget.
+		std::size_t memoryBudget = 0;
+
+		// Requests for assets that were already cached or loading, and requests which had to load the file.
+		unsigned numHits = 0;
+		unsigned numMisses = 0;
+		unsigned numEvictions = 0;
+	};
+
+	template<class Asset>
+	class Resource;
+
+	namespace detail
+	{
+		// Returns the number of times EnforceResourceBudgets() has run. Used to find the least recently used assets.
+		unsigned GetResourceFrame();
+
+		// Returns the memory owned by the asset. Assets can report their size with GetMemoryUsage(),
+		// which should include any memory held by the graphics or audio context.
+		template<class Asset>
+		std::size_t MeasureMemoryUsage(const Asset& asset)
+		{
+			if constexpr (requires { { asset.GetMemoryUsage() } -> std::convertible_to<std::size_t>; })
+			{
+				return asset.GetMemoryUsage();
+			}
+			else
+			{
+				return sizeof(Asset);
+			}
+		}
+
+		// A cached asset, or one that is still being loaded.
+		// Everyone requesting the same file shares the same state, so the file is only loaded once.
+		template<class Asset>
+		struct LoadState
+		{
+			// The asset can only be read once 'status' is Loaded.
+			std::shared_ptr<Asset> asset;
+			std::atomic<LoadStatus> status = LoadStatus::Loading;
+
+			// How to load the asset, kept so that it can be reloaded with the same arguments.
+			std::string filePath;
+			// Run on a worker thread, if the asset supports it.
+			std::function<bool(Asset&, const std::string&)> decode;
+			// Run on the main thread.
+			std::function<bool(Asset&, const std::string&)> upload;
+			bool isDecoded = false;
+
+			// Only accessed while the cache is locked.
+			std::size_t memoryUsage = 0;
+			unsigned lastUsed = 0;
+
+			// Only accessed from the main thread.
+			bool isReloading = false;
+			// Set if the file changed again while it was being reloaded.
+			bool isReloadQueued = false;
+		};
+
+		// Lets the budgets of all asset types be enforced together.
+		// Caches register themselves for their entire lifetime.
+		class ResourceCacheBase
+		{
+		public:
+			ResourceCacheBase();
+			virtual ~ResourceCacheBase();
+
+			ResourceCacheBase(const ResourceCacheBase&) = delete;
+			ResourceCacheBase& operator=(const ResourceCacheBase&) = delete;
+
+			// Evicts unused assets until the cache is within its budget.
+			virtual void EnforceBudget() = 0;
+
+			// Reloads any assets loaded from the file. The path must already be normalized with NormalizeAssetPath().
+			virtual void OnFileChanged(std::string_view changedFile) = 0;
+		};
+
+		// The loaded and loading assets of one type, by file path.
+		// The paths are split between several independently locked maps, so that threads loading
+		// different files rarely contend with each other.
+		// Unused assets are evicted from the cache, least recently used first, while it is over its memory budget.
+		template<class Asset>
+		class ResourceCache : public ResourceCacheBase
+		{
+		public:
+			using State = LoadState<Asset>;
+
+			// Returns the state for the file. If the file wasn't in the cache, a new state is added and
+			// 'isNew' is set, in which case the caller is responsible for loading the asset.
+			std::shared_ptr<State> FindOrAdd(std::string_view filePath, bool& isNew)
+			{
+				Shard& shard = GetShard(filePath);
+				std::lock_guard guard(shard.lock);
+
+				auto itr = shard.entries.find(filePath);
+				if (itr != shard.entries.end())
+				{
+					++shard.numHits;
+					itr->second->lastUsed = GetResourceFrame();
+
+					isNew = false;
+					return itr->second;
+				}
+
+				++shard.numMisses;
+
+				isNew = true;
+				auto state = std::make_shared<State>();
+				state->lastUsed = GetResourceFrame();
+				shard.entries.emplace(std::string(filePath), state);
+				AddSource(filePath);
+
+				return state;
+			}
+
+			// Returns the state for the file, whether it is loaded or not, or null if it isn't in the cache.
+			std::shared_ptr<State> Find(std::string_view filePath)
+			{
+				Shard& shard = GetShard(filePath);
+				std::lock_guard guard(shard.lock);
+
+				auto itr = shard.entries.find(filePath);
+				if (itr == shard.entries.end())
+				{
+					return nullptr;
+				}
+
+				itr->second->lastUsed = GetResourceFrame();
+				return itr->second;
+			}
+
+			// Records the memory used by a successfully loaded asset. Must be called before the state is marked as Loaded,
+			// or from the main thread when a loaded asset is reloaded in place.
+			void SetMemoryUsage(std::string_view filePath, State& state, std::size_t memoryUsage)
+			{
+				Shard& shard = GetShard(filePath);
+				std::lock_guard guard(shard.lock);
+
+				// The asset only counts towards the budget if it wasn't removed from the cache while it was loading.
+				auto itr = shard.entries.find(filePath);
+				if (itr != shard.entries.end() && itr->second.get() == &state)
+				{
+					shard.memoryUsage -= state.memoryUsage;
+					shard.memoryUsage += memoryUsage;
+				}
+
+				state.memoryUsage = memoryUsage;
+			}
+
+			// Removes the file from the cache, but only if it is still associated with the given state.
+			void Remove(std::string_view filePath, const State& state)
+			{
+				Shard& shard = GetShard(filePath);
+				std::lock_guard guard(shard.lock);
+
+				auto itr = shard.entries.find(filePath);
+				if (itr != shard.entries.end() && itr->second.get() == &state)
+				{
+					shard.memoryUsage -= state.memoryUsage;
+					shard.entries.erase(itr);
+					RemoveSource(filePath);
+				}
+			}
+
+			void Clear()
+			{
+				for (Shard& shard : shards)
+				{
+					std::lock_guard guard(shard.lock);
+					for (auto& [filePath, state] : shard.entries)
+					{
+						RemoveSource(filePath);
+					}
+
+					shard.entries.clear();
+					shard.memoryUsage = 0;
+				}
+			}
+
+			// Removes the least recently used assets that are no longer referenced outside of the cache,
+			// until the memory usage is within 'targetUsage'. Returns the number of assets removed.
+			// Should be called from the main thread, since the evicted assets are destroyed here.
+			unsigned EvictUnused(std::size_t targetUsage)
+			{
+				struct Candidate
+				{
+					unsigned lastUsed;
+					Shard* shard;
+					std::string filePath;
+				};
+
+				std::size_t memoryUsage = 0;
+				std::vector<Candidate> candidates;
+				for (Shard& shard : shards)
+				{
+					std::lock_guard guard(shard.lock);
+					memoryUsage += shard.memoryUsage;
+
+					for (auto& [filePath, state] : shard.entries)
+					{
+						if (IsUnused(state))
+						{
+							candidates.push_back({ state->lastUsed, &shard, filePath });
+						}
+					}
+				}
+
+				if (memoryUsage <= targetUsage)
+				{
+					return 0;
+				}
+
+				std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+					return a.lastUsed < b.lastUsed;
+				});
+
+				// The assets are destroyed once the shards are unlocked.
+				std::vector<std::shared_ptr<State>> evicted;
+				for (Candidate& candidate : candidates)
+				{
+					if (memoryUsage <= targetUsage)
+					{
+						break;
+					}
+
+					Shard& shard = *candidate.shard;
+					std::lock_guard guard(shard.lock);
+
+					// The asset might have been requested again since the candidates were gathered.
+					auto itr = shard.entries.find(candidate.filePath);
+					if (itr == shard.entries.end() || !IsUnused(itr->second))
+					{
+						continue;
+					}
+
+					memoryUsage -= itr->second->memoryUsage;
+					shard.memoryUsage -= itr->second->memoryUsage;
+					evicted.push_back(std::move(itr->second));
+					shard.entries.erase(itr);
+					RemoveSource(candidate.filePath);
+				}
+
+				numEvictions.fetch_add(static_cast<unsigned>(evicted.size()), std::memory_order_relaxed);
+				return static_cast<unsigned>(evicted.size());
+			}
+
+			// Replaces a loaded asset with a newer version, but only if 'previous' is still the cached version.
+			bool Replace(std::string_view filePath, const State& previous, std::shared_ptr<State> replacement, std::size_t memoryUsage)
+			{
+				Shard& shard = GetShard(filePath);
+				std::lock_guard guard(shard.lock);
+
+				auto itr = shard.entries.find(filePath);
+				if (itr == shard.entries.end() || itr->second.get() != &previous)
+				{
+					return false;
+				}
+
+				shard.memoryUsage -= previous.memoryUsage;
+				shard.memoryUsage += memoryUsage;
+				replacement->memoryUsage = memoryUsage;
+				replacement->lastUsed = previous.lastUsed;
+
+				// The previous version is destroyed once the shard is unlocked, unless it is still referenced.
+				itr->second.swap(replacement);
+				return true;
+			}
+
+			void OnFileChanged(std::string_view changedFile) override
+			{
+				// Loaders often add an extension to the path they were given, so the file's extension is optional.
+				std::string_view withoutExtension;
+				const std::size_t extension = changedFile.find_last_of("./");
+				if (extension != std::string_view::npos && changedFile[extension] == '.')
+				{
+					withoutExtension = changedFile.substr(0, extension);
+				}
+
+				std::vector<std::string> filePaths;
+				{
+					std::lock_guard guard(sourceLock);
+					for (std::string_view source : { changedFile, withoutExtension })
+					{
+						auto [begin, end] = sources.equal_range(source);
+						for (auto itr = begin; itr != end; ++itr)
+						{
+							filePaths.push_back(itr->second);
+						}
+					}
+				}
+
+				std::vector<std::shared_ptr<State>> changed;
+				for (const std::string& filePath : filePaths)
+				{
+					Shard& shard = GetShard(filePath);
+					std::lock_guard guard(shard.lock);
+
+					// Assets that are still loading are not reloaded.
+					auto itr = shard.entries.find(filePath);
+					if (itr != shard.entries.end() && itr->second->status.load(std::memory_order_acquire) == LoadStatus::Loaded)
+					{
+						changed.push_back(itr->second);
+					}
+				}
+
+				for (auto& state : changed)
+				{
+					Resource<Asset>::Reload(state);
+				}
+			}
+
+			void EnforceBudget() override
+			{
+				const std::size_t budget = memoryBudget.load(std::memory_order_relaxed);
+				if (budget != 0)
+				{
+					EvictUnused(budget);
+				}
+			}
+
+			// Zero disables the budget.
+			void SetMemoryBudget(std::size_t bytes)
+			{
+				memoryBudget.store(bytes, std::memory_order_relaxed);
+			}
+
+			ResourceStats GetStats()
+			{
+				ResourceStats stats;
+				for (Shard& shard : shards)
+				{
+					std::lock_guard guard(shard.lock);
+					stats.numAssets += static_cast<unsigned>(shard.entries.size());
+					stats.memoryUsage += shard.memoryUsage;
+					stats.numHits += shard.numHits;
+					stats.numMisses += shard.numMisses;
+				}
+
+				stats.memoryBudget = memoryBudget.load(std::memory_order_relaxed);
+				stats.numEvictions = numEvictions.load(std::memory_order_relaxed);
+
+				return stats;
+			}
+
+		private:
+			static constexpr unsigned NUM_SHARDS = 16;
+
+			struct alignas(64) Shard
+			{
+				std::mutex lock;
+				std::unordered_map<std::string, std::shared_ptr<State>, string_hash, std::equal_to<>> entries;
+				std::size_t memoryUsage = 0;
+				unsigned numHits = 0;
+				unsigned numMisses = 0;
+			};
+
+			// An asset is unused if it has loaded and only the cache refers to it.
+			// Nothing else can start referring to it without locking its shard first.
+			static bool IsUnused(const std::shared_ptr<State>& state)
+			{
+				return state.use_count() == 1 &&
+					state->status.load(std::memory_order_acquire) == LoadStatus::Loaded &&
+					state->asset.use_count() == 1;
+			}
+
+			Shard& GetShard(std::string_view filePath)
+			{
+				return shards[string_hash{}(filePath) % NUM_SHARDS];
+			}
+
+			// Called with the file's shard locked, so the index always agrees with the shards.
+			void AddSource(std::string_view filePath)
+			{
+				std::string source = NormalizeAssetPath(filePath);
+
+				std::lock_guard guard(sourceLock);
+				sources.emplace(std::move(source), filePath);
+			}
+
+			void RemoveSource(std::string_view filePath)
+			{
+				const std::string source = NormalizeAssetPath(filePath);
+
+				std::lock_guard guard(sourceLock);
+				auto [begin, end] = sources.equal_range(source);
+				for (auto itr = begin; itr != end; ++itr)
+				{
+					if (itr->second == filePath)
+					{
+						sources.erase(itr);
+						break;
+					}
+				}
+			}
+
+			std::array<Shard, NUM_SHARDS> shards;
+
+			// The file path of each cached asset, by its normalized path. Lets a changed file be found without a search.
+			// Always locked after a shard, never before one.
+			std::mutex sourceLock;
+			std::unordered_multimap<std::string, std::string, string_hash, std::equal_to<>> sources;
+
+			std::atomic<std::size_t> memoryBudget = 0;
+			std::atomic<unsigned> numEvictions = 0;
+		};
+	}
+}
@@ -3,12 +3,14 @@
 #include "gemcutter/Application/FileSystem.h"
 #include "gemcutter/Application/Logging.h"
 #include "gemcutter/Math/Vector.h"
+#include "gemcutter/Resource/AssetPack.h"
 #include "gemcutter/Utilities/ScopeGuard.h"
 #include "gemcutter/Utilities/String.h"
 
 #include <cctype>
 #include <functional>
 #include <glew/glew.h>
+#include <utility>
 
 namespace
 {
@@ -397,14 +399,14 @@ namespace gem
 			return false;
 		}
 
-		std::string source;
-		if (!LoadFileAsString(filePath, source))
+		AssetFile file;
+		if (!file.Open(filePath))
 		{
 			Error("Shader: ( %s )\nUnable to open file.", filePath.c_str());
 			return false;
 		}
 
-		if (!LoadInternal(source))
+		if (!LoadInternal(std::string(file.GetContents())))
 		{
 			Error("Shader: ( %s )", filePath.c_str());
 			return false;
@@ -686,22 +688,14 @@ namespace gem
 						*chr = '\0';
 					}
 
-					if (IsPathRelative(path))
+					AssetFile file;
+					if (!file.Open(IsPathRelative(path) ? RootAssetDirectory + path : std::string(path)))
 					{
-						if (!LoadFileAsString(RootAssetDirectory + path, *output))
-						{
-							Error("Shader include ( %s ) failed to load.", path);
-							return false;
-						}
-					}
-					else
-					{
-						if (!LoadFileAsString(path, *output))
-						{
-							Error("Shader include ( %s ) failed to load.", path);
-							return false;
-						}
+						Error("Shader include ( %s ) failed to load.", path);
+						return false;
 					}
+
+					output->assign(file.GetContents());
 				}
 				else
 				{
@@ -1208,6 +1202,22 @@ namespace gem
 		return bufferBindings;
 	}
 
+	void Shader::SwapContents(Shader& other)
+	{
+		std::swap(textures, other.textures);
+		std::swap(buffers, other.buffers);
+		std::swap(loaded, other.loaded);
+		std::swap(variants, other.variants);
+		std::swap(textureBindings, other.textureBindings);
+		std::swap(bufferBindings, other.bufferBindings);
+		std::swap(attributes, other.attributes);
+		std::swap(samplers, other.samplers);
+		std::swap(uniformBuffers, other.uniformBuffers);
+		std::swap(vertexSource, other.vertexSource);
+		std::swap(geometrySource, other.geometrySource);
+		std::swap(fragmentSrouce, other.fragmentSrouce);
+	}
+
 	//-----------------------------------------------------------------------------------------------------
 
 	Shader::ShaderVariant::~ShaderVariant()
@@ -117,6 +117,9 @@ namespace gem
 		// Unloads all GPU-side memory and cleans the object.
 		void Unload();
 
+		// Exchanges the programs and bindings of the two shaders, so a reloaded shader can replace this one in place.
+		void SwapContents(Shader& other);
+
 		void Bind();
 		// Binds the shader compiled with the provided variant definitions.
 		void Bind(const ShaderVariantControl& definitions);
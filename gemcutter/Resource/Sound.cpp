@@ -1,11 +1,11 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Sound.h"
 #include "gemcutter/Application/Logging.h"
+#include "gemcutter/Resource/AssetPack.h"
 #include "gemcutter/Utilities/ScopeGuard.h"
 #include "gemcutter/Utilities/String.h"
 
 #include <AL/al.h>
-#include <cstdio>
 
 #ifdef _DEBUG
 	#define AL_DEBUG_CHECK() \
@@ -42,6 +42,17 @@ struct WaveHeader
 
 namespace gem
 {
+	struct Sound::Staging
+	{
+		AssetFile file;
+		std::string filePath;
+		std::string_view samples;
+		ALenum format;
+		unsigned sampleRate;
+	};
+
+	Sound::Sound() = default;
+
 	Sound::~Sound()
 	{
 		Unload();
@@ -49,6 +60,13 @@ namespace gem
 
 	bool Sound::Load(std::string filePath)
 	{
+		return Decode(std::move(filePath)) && Upload();
+	}
+
+	bool Sound::Decode(std::string filePath)
+	{
+		ASSERT(!staging, "Sound: Already holds a decoded file.");
+
 		auto ext = ExtractFileExtension(filePath);
 		if (ext.empty())
 		{
@@ -60,85 +78,68 @@ namespace gem
 			return false;
 		}
 
-		FILE* file = fopen(filePath.c_str(), "rb");
-		if (file == nullptr)
+		auto data = std::make_unique<Staging>();
+		AssetFile& file = data->file;
+		if (!file.Open(filePath))
 		{
 			Error("Sound: ( %s )\nUnable to open file.", filePath.c_str());
 			return false;
 		}
-		defer { fclose(file); };
 
 		// Variables to store info about the WAVE file.
-		char chunkID[5] = { '\0' };
-		unsigned chunkSize;
+		std::string_view chunkID;
+		unsigned chunkSize = 0;
 		WaveHeader header;
-		unsigned char* soundData = nullptr;
-		defer{ free(soundData); };
 
 		// Check that the WAVE file is OK.
-		fread(chunkID, sizeof(char), 4, file);
-		if (strcmp(chunkID, "RIFF") != 0)
+		if (!file.ReadView(4, chunkID) || chunkID != "RIFF" ||
+			!file.Read(chunkSize) ||
+			!file.ReadView(4, chunkID) || chunkID != "WAVE" ||
+			!file.ReadView(4, chunkID) || chunkID != "fmt ")
 		{
 			Error("Sound: ( %s )\nIncorrect file type.", filePath.c_str());
 			return false;
 		}
 
-		fread(&chunkSize, sizeof(unsigned), 1, file);
-		fread(chunkID, sizeof(char), 4, file);
-		if (strcmp(chunkID, "WAVE") != 0)
-		{
-			Error("Sound: ( %s )\nIncorrect file type.", filePath.c_str());
-			return false;
-		}
-
-		fread(chunkID, sizeof(char), 4, file);
-		if (strcmp(chunkID, "fmt ") != 0)
+		// Read sound format.
+		if (!file.Read(chunkSize) ||
+			!file.Read(header.FormatTag) ||
+			!file.Read(header.Channels) ||
+			!file.Read(header.SamplesPerSec) ||
+			!file.Read(header.AvgBytesPerSec) ||
+			!file.Read(header.BlockAlign) ||
+			!file.Read(header.BitsPerSample))
 		{
 			Error("Sound: ( %s )\nIncorrect file type.", filePath.c_str());
 			return false;
 		}
 
-		// Read sound format.
-		fread(&chunkSize, sizeof(unsigned), 1, file);
-		fread(&header.FormatTag, sizeof(short), 1, file);
-		fread(&header.Channels, sizeof(short), 1, file);
-		fread(&header.SamplesPerSec, sizeof(unsigned), 1, file);
-		fread(&header.AvgBytesPerSec, sizeof(unsigned), 1, file);
-		fread(&header.BlockAlign, sizeof(short), 1, file);
-		fread(&header.BitsPerSample, sizeof(short), 1, file);
-
 		// Skip any extra header information.
 		if (header.FormatTag == WaveFormat::WAVE_FORMAT_EXTENSIBLE)
 		{
-			fseek(file, 24, SEEK_CUR);
+			file.Skip(24);
 		}
 		else if (header.FormatTag != WaveFormat::WAVE_FORMAT_PCM)
 		{
-			fseek(file, 2, SEEK_CUR);
+			file.Skip(2);
 		}
 
-		// Search for data chunk.
-		while (fread(&chunkID, sizeof(char), 4, file) != 0)
+		// Search for data chunk. The samples are sent to OpenAL straight from the file.
+		std::string_view soundData;
+		while (file.ReadView(4, chunkID) && file.Read(chunkSize))
 		{
-			if (strcmp(chunkID, "data") == 0)
+			if (chunkID == "data")
 			{
-				// Read data.
-				fread(&chunkSize, sizeof(unsigned), 1, file);
-				soundData = static_cast<unsigned char*>(malloc(chunkSize * sizeof(unsigned char)));
-				fread(soundData, sizeof(unsigned char), chunkSize, file);
-
+				file.ReadView(chunkSize, soundData);
 				break;
 			}
-			else
+			else if (!file.Skip(chunkSize))
 			{
-				// Skip chunk.
-				int size;
-				fread(&size, sizeof(int), 1, file);
-				fseek(file, size, SEEK_CUR);
+				break;
 			}
 		}
 
-		if (soundData == nullptr)
+		if (soundData.empty())
 		{
 			// We didn't find any data to load.
 			Error("Sound: ( %s )\nNo data found in file.", filePath.c_str());
@@ -176,26 +177,43 @@ namespace gem
 			return false;
 		}
 
+		data->filePath = std::move(filePath);
+		data->samples = soundData;
+		data->format = format;
+		data->sampleRate = header.SamplesPerSec;
+		staging = std::move(data);
+
+		return true;
+	}
+
+	bool Sound::Upload()
+	{
+		ASSERT(hBuffer == AL_NONE, "Sound already has a buffer loaded.");
+		ASSERT(staging, "Sound: Decode() must succeed before calling Upload().");
+		defer { staging.reset(); };
+
 		// Create OpenAL buffer.
 		alGenBuffers(1, &hBuffer);
 		ALenum error = alGetError();
 		if (error != AL_NO_ERROR)
 		{
 			Unload();
-			Error("Sound: ( %s )\n%s", filePath.c_str(), alGetString(error));
+			Error("Sound: ( %s )\n%s", staging->filePath.c_str(), alGetString(error));
 			return false;
 		}
 
 		// Send data to OpenAL.
-		alBufferData(hBuffer, format, soundData, chunkSize, header.SamplesPerSec);
+		alBufferData(hBuffer, staging->format, staging->samples.data(), static_cast<ALsizei>(staging->samples.size()), staging->sampleRate);
 		error = alGetError();
 		if (error != AL_NO_ERROR)
 		{
 			Unload();
-			Error("Sound: ( %s )\n%s", filePath.c_str(), alGetString(error));
+			Error("Sound: ( %s )\n%s", staging->filePath.c_str(), alGetString(error));
 			return false;
 		}
 
+		bufferSize = static_cast<unsigned>(staging->samples.size());
+
 		return true;
 	}
 
@@ -206,6 +224,7 @@ namespace gem
 			alDeleteBuffers(1, &hBuffer);
 			AL_DEBUG_CHECK();
 			hBuffer = 0;
+			bufferSize = 0;
 		}
 	}
 
@@ -213,4 +232,9 @@ namespace gem
 	{
 		return hBuffer;
 	}
+
+	std::size_t Sound::GetMemoryUsage() const
+	{
+		return sizeof(Sound) + bufferSize;
+	}
 }
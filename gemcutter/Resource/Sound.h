@@ -3,6 +3,9 @@
 #include "gemcutter/Resource/Resource.h"
 #include "gemcutter/Resource/Shareable.h"
 
+#include <cstddef>
+#include <memory>
+
 namespace gem
 {
 	// An audio clip.
@@ -11,15 +14,30 @@ namespace gem
 	class Sound : public Resource<Sound>, public Shareable<Sound>
 	{
 	public:
+		Sound();
 		~Sound();
 
 		// Loads .wav (must be 8-bit unsigned PCM).
 		bool Load(std::string filePath);
 		void Unload();
 
+		// The two halves of Load(), used by LoadAsync().
+		// Decode() reads the file without touching the audio context, so it can run on any thread.
+		bool Decode(std::string filePath);
+		// Creates the buffer from the decoded file. Must be called from the main thread.
+		bool Upload();
+
 		unsigned GetBufferHandle() const;
 
+		// The memory used by the clip's samples, in bytes.
+		std::size_t GetMemoryUsage() const;
+
 	private:
+		// The file's contents, held between Decode() and Upload().
+		struct Staging;
+		std::unique_ptr<Staging> staging;
+
 		unsigned hBuffer = 0;
+		unsigned bufferSize = 0;
 	};
 }
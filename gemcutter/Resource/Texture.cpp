@@ -1,15 +1,29 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Texture.h"
 #include "gemcutter/Application/Logging.h"
+#include "gemcutter/Resource/AssetPack.h"
 #include "gemcutter/Utilities/ScopeGuard.h"
 #include "gemcutter/Utilities/String.h"
 
 #include <algorithm>
 #include <glew/glew.h>
+#include <optional>
 #include <soil/SOIL.h>
+#include <utility>
 
 namespace gem
 {
+	struct Texture::Staging
+	{
+		AssetFile file;
+		// Set if the pixels were decoded from an image, rather than read from a packed texture.
+		std::optional<Image> image;
+		std::string_view pixels;
+		bool isCubeMap = false;
+	};
+
+	Texture::Texture() = default;
+
 	Texture::~Texture()
 	{
 		Unload();
@@ -63,10 +77,16 @@ namespace gem
 	}
 
 	bool Texture::Load(std::string filePath)
+	{
+		return Decode(std::move(filePath)) && Upload();
+	}
+
+	bool Texture::Decode(std::string filePath)
 	{
 		ASSERT(hTex == 0, "Texture already has a texture loaded.");
+		ASSERT(!staging, "Texture: Already holds a decoded file.");
 
-		unsigned numLevels = 0;
+		auto data = std::make_unique<Staging>();
 
 		auto ext = ExtractFileExtension(filePath);
 		if (ext.empty() || CompareLowercase(ext, ".texture"))
@@ -76,85 +96,86 @@ namespace gem
 				filePath += ".texture";
 			}
 
-			FILE* fontFile = fopen(filePath.c_str(), "rb");
-			if (fontFile == nullptr)
+			AssetFile& textureFile = data->file;
+			if (!textureFile.Open(filePath))
 			{
 				Error("Texture: ( %s )\nUnable to open file.", filePath.c_str());
 				return false;
 			}
-			defer { fclose(fontFile); };
 
 			// Read header.
-			bool isCubeMap = false;
-			fread(&isCubeMap, sizeof(bool), 1, fontFile);
-			fread(&width, sizeof(unsigned), 1, fontFile);
-			fread(&height, sizeof(unsigned), 1, fontFile);
-			fread(&format, sizeof(TextureFormat), 1, fontFile);
-			fread(&filter, sizeof(TextureFilter), 1, fontFile);
-			fread(&wraps.x, sizeof(TextureWrap), 1, fontFile);
-			fread(&wraps.y, sizeof(TextureWrap), 1, fontFile);
-			fread(&anisotropicLevel, sizeof(float), 1, fontFile);
-
-			numLevels = CountMipLevels(width, height, filter);
-			const unsigned textureSize = width * height * CountChannels(format);
-			const unsigned dataFormat = CountChannels(format) == 3 ? GL_RGB : GL_RGBA;
-			if (isCubeMap)
+			if (!textureFile.Read(data->isCubeMap) ||
+				!textureFile.Read(width) ||
+				!textureFile.Read(height) ||
+				!textureFile.Read(format) ||
+				!textureFile.Read(filter) ||
+				!textureFile.Read(wraps.x) ||
+				!textureFile.Read(wraps.y) ||
+				!textureFile.Read(anisotropicLevel))
 			{
-				auto* image = static_cast<unsigned char*>(malloc(sizeof(unsigned char) * textureSize * 6));
-				defer{ free(image); };
-
-				fread(image, sizeof(unsigned char), textureSize * 6, fontFile);
-
-				glGenTextures(1, &hTex);
-				glBindTexture(GL_TEXTURE_CUBE_MAP, hTex);
-				glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, ResolveFilterMag(filter));
-				glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, ResolveFilterMin(filter));
-				glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-				glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-				glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-				glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropicLevel);
-
-				glTexStorage2D(GL_TEXTURE_CUBE_MAP, numLevels, ResolveFormat(format), width, height);
-
-				for (unsigned i = 0; i < 6; ++i)
-				{
-					glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, 0, 0, width, height, dataFormat, GL_UNSIGNED_BYTE, image + (textureSize * i));
-				}
-
-				target = GL_TEXTURE_CUBE_MAP;
+				Error("Texture: ( %s )\nInvalid file header.", filePath.c_str());
+				return false;
 			}
-			else
-			{
-				auto* image = static_cast<unsigned char*>(malloc(sizeof(unsigned char) * textureSize));
-				defer{ free(image); };
-
-				fread(image, sizeof(unsigned char), textureSize, fontFile);
 
-				glGenTextures(1, &hTex);
-				glBindTexture(GL_TEXTURE_2D, hTex);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, ResolveFilterMag(filter));
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, ResolveFilterMin(filter));
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, ResolveWrap(wraps.x));
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, ResolveWrap(wraps.y));
-				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropicLevel);
-
-				glTexStorage2D(GL_TEXTURE_2D, numLevels, ResolveFormat(format), width, height);
-				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, dataFormat, GL_UNSIGNED_BYTE, image);
-
-				target = GL_TEXTURE_2D;
+			// The pixels are uploaded straight from the file.
+			const unsigned numFaces = data->isCubeMap ? 6 : 1;
+			const unsigned textureSize = width * height * CountChannels(format);
+			if (!textureFile.ReadView(textureSize * numFaces, data->pixels))
+			{
+				Error("Texture: ( %s )\nThe file ends before the image data.", filePath.c_str());
+				return false;
 			}
 		}
 		else
 		{
-			auto image = Image::Load(filePath, true, false);
+			const Image& image = data->image.emplace(Image::Load(filePath, true, false));
 			if (image.data == nullptr)
 				return false;
 
 			width = image.width;
 			height = image.height;
 			format = image.format;
-			numLevels = CountMipLevels(width, height, filter);
+			data->pixels = std::string_view(reinterpret_cast<const char*>(image.data), width * height * CountChannels(format));
+		}
+
+		staging = std::move(data);
+
+		return true;
+	}
+
+	bool Texture::Upload()
+	{
+		ASSERT(hTex == 0, "Texture already has a texture loaded.");
+		ASSERT(staging, "Texture: Decode() must succeed before calling Upload().");
+		defer { staging.reset(); };
+
+		const unsigned numLevels = CountMipLevels(width, height, filter);
+		const unsigned textureSize = width * height * CountChannels(format);
+		const unsigned dataFormat = CountChannels(format) == 3 ? GL_RGB : GL_RGBA;
+		const char* pixels = staging->pixels.data();
+
+		if (staging->isCubeMap)
+		{
+			glGenTextures(1, &hTex);
+			glBindTexture(GL_TEXTURE_CUBE_MAP, hTex);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, ResolveFilterMag(filter));
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, ResolveFilterMin(filter));
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+			glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropicLevel);
+
+			glTexStorage2D(GL_TEXTURE_CUBE_MAP, numLevels, ResolveFormat(format), width, height);
+
+			for (unsigned i = 0; i < 6; ++i)
+			{
+				glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, 0, 0, width, height, dataFormat, GL_UNSIGNED_BYTE, pixels + (textureSize * i));
+			}
 
+			target = GL_TEXTURE_CUBE_MAP;
+		}
+		else
+		{
 			glGenTextures(1, &hTex);
 			glBindTexture(GL_TEXTURE_2D, hTex);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, ResolveFilterMag(filter));
@@ -163,10 +184,8 @@ namespace gem
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, ResolveWrap(wraps.y));
 			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropicLevel);
 
-			const unsigned dataFormat = CountChannels(format) == 3 ? GL_RGB : GL_RGBA;
-
 			glTexStorage2D(GL_TEXTURE_2D, numLevels, ResolveFormat(format), width, height);
-			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, dataFormat, GL_UNSIGNED_BYTE, image.data);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, dataFormat, GL_UNSIGNED_BYTE, pixels);
 
 			target = GL_TEXTURE_2D;
 		}
@@ -313,6 +332,44 @@ namespace gem
 		return target == GL_TEXTURE_CUBE_MAP;
 	}
 
+	void Texture::SwapContents(Texture& other)
+	{
+		std::swap(hTex, other.hTex);
+		std::swap(numSamples, other.numSamples);
+		std::swap(target, other.target);
+		std::swap(width, other.width);
+		std::swap(height, other.height);
+		std::swap(format, other.format);
+		std::swap(filter, other.filter);
+		std::swap(wraps, other.wraps);
+		std::swap(anisotropicLevel, other.anisotropicLevel);
+	}
+
+	std::size_t Texture::GetMemoryUsage() const
+	{
+		if (hTex == GL_NONE)
+		{
+			return sizeof(Texture);
+		}
+
+		const std::size_t numFaces = target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+		const std::size_t texelSize = CountBytes(format) * numSamples;
+
+		// Each mip level is half the size of the previous one.
+		std::size_t numTexels = 0;
+		unsigned levelWidth = static_cast<unsigned>(width);
+		unsigned levelHeight = static_cast<unsigned>(height);
+		const unsigned numLevels = numSamples == 1 ? CountMipLevels(levelWidth, levelHeight, filter) : 1;
+		for (unsigned i = 0; i < numLevels; ++i)
+		{
+			numTexels += static_cast<std::size_t>(levelWidth) * levelHeight;
+			levelWidth = std::max(levelWidth / 2, 1u);
+			levelHeight = std::max(levelHeight / 2, 1u);
+		}
+
+		return sizeof(Texture) + numTexels * texelSize * numFaces;
+	}
+
 	void Texture::RegenerateMipmaps()
 	{
 		ASSERT(hTex != 0, "A texture must be loaded to call this function.");
@@ -411,6 +468,15 @@ namespace gem
 	{
 	}
 
+	Image::Image(Image&& other) noexcept
+		: width(other.width)
+		, height(other.height)
+		, format(other.format)
+		, data(other.data)
+	{
+		other.data = nullptr;
+	}
+
 	Image::~Image()
 	{
 		free(const_cast<unsigned char*>(data));
@@ -422,7 +488,17 @@ namespace gem
 		int height = 0;
 		int numChannels = 0;
 
-		unsigned char* data = SOIL_load_image(file.data(), &width, &height, &numChannels, SOIL_LOAD_AUTO);
+		AssetFile imageFile;
+		if (!imageFile.Open(file))
+		{
+			Error("Texture: ( %s )\nUnable to open file.", file.data());
+			return Image(0, 0, TextureFormat::RGB_8, nullptr);
+		}
+
+		const std::string_view contents = imageFile.GetContents();
+		unsigned char* data = SOIL_load_image_from_memory(
+			reinterpret_cast<const unsigned char*>(contents.data()), static_cast<int>(contents.size()),
+			&width, &height, &numChannels, SOIL_LOAD_AUTO);
 		if (data == nullptr)
 		{
 			Error("Texture: ( %s )\n%s", file.data(), SOIL_last_result());
@@ -4,6 +4,8 @@
 #include "gemcutter/Resource/Resource.h"
 #include "gemcutter/Resource/Shareable.h"
 
+#include <cstddef>
+#include <memory>
 #include <string_view>
 #include <vector>
 
@@ -13,7 +15,7 @@ namespace gem
 	class Texture : public Resource<Texture>, public Shareable<Texture>
 	{
 	public:
-		Texture() = default;
+		Texture();
 		~Texture();
 
 		// Creates an empty texture that can be rendered to.
@@ -29,6 +31,15 @@ namespace gem
 		bool Load(std::string filePath);
 		void Unload();
 
+		// The two halves of Load(), used by LoadAsync().
+		// Decode() reads and decodes the file without touching the graphics context, so it can run on any thread.
+		bool Decode(std::string filePath);
+		// Creates the texture from the decoded file. Must be called from the main thread.
+		bool Upload();
+
+		// Exchanges the loaded textures of the two objects, so a reloaded texture can replace this one in place.
+		void SwapContents(Texture& other);
+
 		void Bind(unsigned slot);
 		void UnBind(unsigned slot);
 
@@ -50,9 +61,16 @@ namespace gem
 
 		bool IsCubeMap() const;
 
+		// The memory used by the texture and its mipmaps, in bytes.
+		std::size_t GetMemoryUsage() const;
+
 		void RegenerateMipmaps();
 
 	private:
+		// The file's contents, held between Decode() and Upload().
+		struct Staging;
+		std::unique_ptr<Staging> staging;
+
 		unsigned hTex       = 0;
 		unsigned numSamples = 1;
 		unsigned target     = 0;
@@ -103,6 +121,8 @@ namespace gem
 	class Image
 	{
 	public:
+		Image(const Image&) = delete;
+		Image(Image&&) noexcept;
 		~Image();
 
 		// Loads *.png, *.jpg, *.tga, and *.bmp.
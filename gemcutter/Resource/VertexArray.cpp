@@ -2,8 +2,10 @@
 #include "VertexArray.h"
 #include "gemcutter/Application/Logging.h"
 
+#include <algorithm>
 #include <glew/glew.h>
 #include <numeric>
+#include <utility>
 
 namespace gem
 {
@@ -413,4 +415,37 @@ namespace gem
 	{
 		return vertexCount;
 	}
+
+	std::size_t VertexArray::GetMemoryUsage() const
+	{
+		std::size_t memoryUsage = sizeof(VertexArray);
+		if (indexBuffer)
+		{
+			memoryUsage += indexBuffer->GetSize();
+		}
+
+		for (unsigned i = 0; i < streams.size(); ++i)
+		{
+			const VertexBuffer* buffer = streams[i].buffer.get();
+			const bool isCounted = std::any_of(streams.begin(), streams.begin() + i, [buffer](const VertexStream& stream) {
+				return stream.buffer.get() == buffer;
+			});
+
+			if (!isCounted)
+			{
+				memoryUsage += buffer->GetSize();
+			}
+		}
+
+		return memoryUsage;
+	}
+
+	void VertexArray::SwapContents(VertexArray& other)
+	{
+		std::swap(VAO, other.VAO);
+		std::swap(vertexCount, other.vertexCount);
+		std::swap(indexBuffer, other.indexBuffer);
+		std::swap(streams, other.streams);
+		std::swap(format, other.format);
+	}
 }
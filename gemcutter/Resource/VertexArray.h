@@ -4,6 +4,7 @@
 #include "gemcutter/Rendering/Rendering.h"
 #include "gemcutter/Resource/Shareable.h"
 
+#include <cstddef>
 #include <vector>
 
 namespace gem
@@ -127,6 +128,13 @@ namespace gem
 		unsigned GetVertexCount() const;
 		const auto& GetStreams() const { return streams; }
 
+		// The memory used by the VertexBuffers of all streams and the index buffer, in bytes.
+		// Buffers shared by several streams are only counted once.
+		std::size_t GetMemoryUsage() const;
+
+		// Exchanges the streams, index buffer, and GPU handle of the two arrays.
+		void SwapContents(VertexArray& other);
+
 		VertexArrayFormat format = VertexArrayFormat::Triangle;
 
 	private:
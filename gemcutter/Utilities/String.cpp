@@ -7,7 +7,8 @@
 namespace
 {
 	constexpr unsigned BUFFER_SIZE = 1024;
-	char buffer[BUFFER_SIZE] = { '\0' };
+	// Each thread formats into its own buffer, since messages are logged from many threads.
+	thread_local char buffer[BUFFER_SIZE] = { '\0' };
 }
 
 namespace gem
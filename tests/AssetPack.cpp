@@ -0,0 +1,145 @@
+#include <catch/catch.hpp>
+#include <gemcutter/Resource/AssetPack.h>
+#include <gemcutter/Resource/Resource.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace gem;
+
+namespace
+{
+	void WriteFile(const char* fileName, std::string_view contents)
+	{
+		std::ofstream output(fileName, std::ofstream::binary);
+		output.write(contents.data(), contents.size());
+	}
+}
+
+TEST_CASE("AssetPack")
+{
+	const char* packName = "AssetPackTest.pack";
+	WriteFile("AssetPackTest_Crate.tmp", "crate model");
+	WriteFile("AssetPackTest_Brick.tmp", "brick texture!");
+	WriteFile("AssetPackTest_Empty.tmp", "");
+	WriteFile("AssetPackTest_Loose.tmp", "loose file");
+
+	{
+		AssetPackWriter writer;
+		REQUIRE(writer.AddFile("Models/Crate.model", "AssetPackTest_Crate.tmp"));
+		REQUIRE(writer.AddFile(".\\Textures\\Brick.texture", "AssetPackTest_Brick.tmp"));
+		REQUIRE(writer.AddFile("Empty.txt", "AssetPackTest_Empty.tmp"));
+		CHECK_FALSE(writer.AddFile("Models/Crate.model", "AssetPackTest_Loose.tmp"));
+		CHECK_FALSE(writer.AddFile("Missing.txt", "AssetPackTest_Missing.tmp"));
+		CHECK(writer.GetNumFiles() == 3);
+		REQUIRE(writer.Save(packName));
+	}
+
+	SECTION("Paths")
+	{
+		CHECK(NormalizeAssetPath("./Models\\Crate.model") == "Models/Crate.model");
+		CHECK(NormalizeAssetPath("Models/Crate.model") == "Models/Crate.model");
+		CHECK(HashAssetPath("Models/Crate.model") != HashAssetPath("Models/Crate.modeL"));
+	}
+
+	SECTION("Index")
+	{
+		AssetPack pack;
+		REQUIRE(pack.Open(packName));
+		REQUIRE(pack.GetNumFiles() == 3);
+
+		std::string_view contents;
+		REQUIRE(pack.Find("Models/Crate.model", contents));
+		CHECK(contents == "crate model");
+		CHECK(reinterpret_cast<std::uintptr_t>(contents.data()) % ASSET_PACK_ALIGNMENT == 0);
+
+		REQUIRE(pack.Find("Textures/Brick.texture", contents));
+		CHECK(contents == "brick texture!");
+		CHECK(reinterpret_cast<std::uintptr_t>(contents.data()) % ASSET_PACK_ALIGNMENT == 0);
+
+		REQUIRE(pack.Find("Empty.txt", contents));
+		CHECK(contents.empty());
+
+		CHECK_FALSE(pack.Find("Models/Missing.model", contents));
+		CHECK_FALSE(pack.Find("Models/Crate", contents));
+
+		// The index is sorted by hash.
+		for (unsigned i = 1; i < pack.GetNumFiles(); ++i)
+		{
+			CHECK(HashAssetPath(pack.GetPath(i - 1)) <= HashAssetPath(pack.GetPath(i)));
+		}
+	}
+
+	SECTION("Mounted")
+	{
+		REQUIRE(MountAssetPack(packName));
+
+		AssetFile file;
+		REQUIRE(file.Open(RootAssetDirectory + "Models/Crate.model"));
+		CHECK(file.IsPacked());
+		CHECK(file.GetContents() == "crate model");
+
+		char word[5] = {};
+		CHECK(file.Read(word, 5));
+		CHECK(std::string_view(word, 5) == "crate");
+		CHECK(file.Skip(1));
+
+		std::string_view view;
+		CHECK_FALSE(file.ReadView(6, view));
+		CHECK(file.ReadView(5, view));
+		CHECK(view == "model");
+		CHECK(file.IsEOF());
+
+		std::uint32_t value = 0;
+		CHECK_FALSE(file.Read(value));
+		CHECK_FALSE(file.Skip(1));
+		file.Close();
+
+		// Files missing from the pack are loaded from the disk.
+		REQUIRE(file.Open(RootAssetDirectory + "AssetPackTest_Loose.tmp"));
+		CHECK_FALSE(file.IsPacked());
+		CHECK(file.GetContents() == "loose file");
+		file.Close();
+
+		CHECK_FALSE(file.Open(RootAssetDirectory + "Models/Missing.model"));
+
+		// Hot reloading reads loose files even if they are also packed.
+		WriteFile("Empty.txt", "changed");
+		{
+			const LooseAssetScope loose;
+			REQUIRE(file.Open(RootAssetDirectory + "Empty.txt"));
+			CHECK_FALSE(file.IsPacked());
+			CHECK(file.GetContents() == "changed");
+			file.Close();
+		}
+
+		REQUIRE(file.Open(RootAssetDirectory + "Empty.txt"));
+		CHECK(file.IsPacked());
+		CHECK(file.GetContents().empty());
+		file.Close();
+		std::remove("Empty.txt");
+
+		UnmountAssetPacks();
+		CHECK_FALSE(file.Open(RootAssetDirectory + "Models/Crate.model"));
+	}
+
+	SECTION("Invalid")
+	{
+		WriteFile("AssetPackTest_Invalid.tmp", "not an asset pack");
+
+		AssetPack pack;
+		CHECK_FALSE(pack.Open("AssetPackTest_Invalid.tmp"));
+		CHECK_FALSE(pack.IsOpen());
+		CHECK_FALSE(pack.Open("AssetPackTest_Missing.tmp"));
+
+		std::remove("AssetPackTest_Invalid.tmp");
+	}
+
+	std::remove(packName);
+	std::remove("AssetPackTest_Crate.tmp");
+	std::remove("AssetPackTest_Brick.tmp");
+	std::remove("AssetPackTest_Empty.tmp");
+	std::remove("AssetPackTest_Loose.tmp");
+}
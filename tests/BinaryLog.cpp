@@ -0,0 +1,221 @@
+#include <catch/catch.hpp>
+#include <gemcutter/Application/BinaryLog.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace gem;
+
+namespace
+{
+	enum class Color
+	{
+		Red = 3
+	};
+
+	// Keeps the test's messages out of the console while it runs.
+	class SilenceConsole
+	{
+	public:
+		SilenceConsole() : previous((FlushLog(), std::cout.rdbuf(output.rdbuf()))) {}
+		~SilenceConsole() { FlushLog(); std::cout.rdbuf(previous); }
+
+	private:
+		std::stringstream output;
+		std::streambuf* previous;
+	};
+
+	template<typename... Args>
+	std::string Format(const char* format, const Args&... args)
+	{
+		using RecordArgs = detail::LogArgs<Args...>;
+
+		std::byte buffer[LOG_RECORD_SIZE];
+		unsigned size = 0;
+		detail::StoreLogArgs(buffer, size, args...);
+
+		return FormatLogRecord(format, RecordArgs::types, buffer, size);
+	}
+}
+
+TEST_CASE("Binary Log")
+{
+	SECTION("Compile-Time Format Check")
+	{
+		STATIC_REQUIRE(detail::CheckLogFormat("none", ""));
+		STATIC_REQUIRE(detail::CheckLogFormat("%d %s %.2f %%", "isf"));
+		STATIC_REQUIRE(detail::CheckLogFormat("%llu %zu %p %c", "UUpc"));
+		STATIC_REQUIRE_FALSE(detail::CheckLogFormat("%d", ""));
+		STATIC_REQUIRE_FALSE(detail::CheckLogFormat("", "i"));
+		STATIC_REQUIRE_FALSE(detail::CheckLogFormat("%s", "i"));
+		STATIC_REQUIRE_FALSE(detail::CheckLogFormat("%d", "f"));
+		STATIC_REQUIRE_FALSE(detail::CheckLogFormat("%*d", "ii"));
+		STATIC_REQUIRE_FALSE(detail::CheckLogFormat("trailing %", ""));
+	}
+
+	SECTION("Format")
+	{
+		CHECK(Format("plain text") == "plain text");
+		CHECK(Format("%d%%", -5) == "-5%");
+		CHECK(Format("%u %llu %lld", 7u, 1ull << 40, -(1ll << 40)) == "7 1099511627776 -1099511627776");
+		CHECK(Format("%hd %zu", static_cast<short>(-3), std::size_t(9)) == "-3 9");
+		CHECK(Format("%.3f %g", 1.5f, 0.25) == "1.500 0.25");
+		CHECK(Format("%c%c", 'o', 'k') == "ok");
+		CHECK(Format("[%5s|%-4d]", "ab", 12) == "[   ab|12  ]");
+		CHECK(Format("%d", Color::Red) == "3");
+		CHECK(Format("%s %s", std::string("copied"), std::string_view("view")) == "copied view");
+		CHECK(Format("%s", static_cast<const char*>(nullptr)) == "(null)");
+		CHECK(Format("%x %X", 255, 255u) == "ff FF");
+	}
+
+	SECTION("Long Strings")
+	{
+		const std::string text(100, 'a');
+
+		// Strings are truncated to fit the record.
+		const std::string result = Format("%d %s", 1, text);
+		CHECK(result == "1 " + std::string(LOG_RECORD_SIZE - sizeof(std::int32_t) - 1, 'a'));
+
+		// Room is left for the arguments after the string.
+		const std::string followed = Format("%s %d %d", text, 1, 2);
+		CHECK(followed == std::string(LOG_RECORD_SIZE - 2 * sizeof(std::int32_t) - 1, 'a') + " 1 2");
+
+		const std::string twoStrings = Format("%s %s %c", text, text, 'z');
+		CHECK(twoStrings == std::string(LOG_RECORD_SIZE - 3, 'a') + "  z");
+	}
+
+	SECTION("Invalid Record")
+	{
+		const std::byte truncated[2] = {};
+		CHECK(FormatLogRecord("value: %d", "i", truncated, sizeof(truncated)) == "value: <invalid record>");
+	}
+
+	SECTION("Deferred Messages")
+	{
+		std::remove("Log_Output.txt");
+		std::remove("Log_Output.bin");
+
+		{
+			SilenceConsole silence;
+			OpenOutputLog();
+			OpenBinaryLog();
+
+			for (int i = 0; i < 3; ++i)
+			{
+				GEM_LOG("Deferred %d of %s", i, "three");
+			}
+			GEM_WARNING("Deferred warning");
+			Error("Formatted %d", 4);
+			GEM_ERROR("Deferred error %.1f", 0.5);
+			GEM_LOG("%s %d %d", std::string(100, 'x'), 1, 2);
+
+			CloseBinaryLog();
+			CloseOutputLog();
+		}
+
+		const std::string expected =
+			"Log:     Deferred 0 of three\n"
+			"Log:     Deferred 1 of three\n"
+			"Log:     Deferred 2 of three\n"
+			"WARNING: Deferred warning\n"
+			"ERROR:   Formatted 4\n"
+			"ERROR:   Deferred error 0.5\n"
+			"Log:     " + std::string(LOG_RECORD_SIZE - 2 * sizeof(std::int32_t) - 1, 'x') + " 1 2\n";
+
+		std::stringstream text;
+		text << std::ifstream("Log_Output.txt").rdbuf();
+		CHECK(text.str() == expected);
+
+		std::ifstream binary("Log_Output.bin", std::ifstream::binary);
+		std::stringstream decoded;
+		CHECK(DecodeBinaryLog(binary, decoded));
+		CHECK(decoded.str() == expected);
+
+		binary.close();
+		std::remove("Log_Output.txt");
+		std::remove("Log_Output.bin");
+	}
+
+	SECTION("Channels")
+	{
+		std::remove("Log_Output.txt");
+		std::remove("Log_Output.bin");
+
+		unsigned numEvaluated = 0;
+		auto evaluate = [&numEvaluated]() { return ++numEvaluated; };
+
+		{
+			SilenceConsole silence;
+			OpenOutputLog();
+			OpenBinaryLog();
+
+			SetLogLevel(LogChannel::Resource, LogLevel::Error);
+			GEM_LOG_CHANNEL(LogChannel::Resource, LogLevel::Warning, "Hidden %u", evaluate());
+			GEM_LOG_CHANNEL(LogChannel::Resource, LogLevel::Error, "Shown %u", evaluate());
+			GEM_DEBUG("Debug %u", evaluate());
+			SetLogLevel(LogChannel::Resource, LogLevel::Debug);
+
+			CloseBinaryLog();
+			CloseOutputLog();
+		}
+
+		// Arguments aren't evaluated for disabled messages.
+		std::string expected = "ERROR:   [Resource] Shown 1\n";
+		if constexpr (MIN_LOG_LEVEL == LogLevel::Debug)
+		{
+			CHECK(numEvaluated == 2);
+			expected += "Debug:   Debug 2\n";
+		}
+		else
+		{
+			CHECK(numEvaluated == 1);
+		}
+
+		std::stringstream text;
+		text << std::ifstream("Log_Output.txt").rdbuf();
+		CHECK(text.str() == expected);
+
+		std::ifstream binary("Log_Output.bin", std::ifstream::binary);
+		std::stringstream decoded;
+		CHECK(DecodeBinaryLog(binary, decoded));
+		CHECK(decoded.str() == expected);
+
+		binary.close();
+		std::remove("Log_Output.txt");
+		std::remove("Log_Output.bin");
+	}
+
+	SECTION("Decode Invalid")
+	{
+		SilenceConsole silence;
+
+		std::stringstream notALog("not a log");
+		std::stringstream output;
+		CHECK_FALSE(DecodeBinaryLog(notALog, output));
+
+		std::stringstream truncated;
+		truncated.write(BINARY_LOG_SIGNATURE, sizeof(BINARY_LOG_SIGNATURE));
+		truncated.put(static_cast<char>(BinaryLogEntry::Record));
+		CHECK_FALSE(DecodeBinaryLog(truncated, output));
+	}
+}
+
+TEST_CASE("Binary Log Benchmark", "[!benchmark]")
+{
+	SilenceConsole silence;
+
+	BENCHMARK("Formatted")
+	{
+		Log("Benchmark message %d of %s", 42, "many");
+	};
+
+	FlushLog();
+
+	BENCHMARK("Deferred")
+	{
+		GEM_LOG("Benchmark message %d of %s", 42, "many");
+	};
+}
@@ -0,0 +1,252 @@
+#include <catch/catch.hpp>
+#include <gemcutter/Application/ConcurrentQueue.h>
+
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gem;
+
+TEST_CASE("Concurrent Queues")
+{
+	SECTION("SpscRingBuffer")
+	{
+		SpscRingBuffer<std::unique_ptr<int>, 4> queue;
+		CHECK(queue.IsEmpty());
+
+		std::unique_ptr<int> value;
+		CHECK(!queue.TryPop(value));
+
+		for (int i = 0; i < 4; ++i)
+		{
+			CHECK(queue.TryPush(std::make_unique<int>(i)));
+		}
+		CHECK(!queue.TryPush(std::make_unique<int>(4)));
+
+		for (int i = 0; i < 4; ++i)
+		{
+			REQUIRE(queue.TryPop(value));
+			CHECK(*value == i);
+		}
+		CHECK(queue.IsEmpty());
+
+		// Items left in the queue are destroyed along with it.
+		CHECK(queue.TryPush(std::make_unique<int>(5)));
+	}
+
+	SECTION("SpscRingBuffer Threads")
+	{
+		constexpr unsigned numItems = 100000;
+		SpscRingBuffer<unsigned, 64> queue;
+
+		std::thread producer([&]() {
+			for (unsigned i = 0; i < numItems; ++i)
+			{
+				while (!queue.TryPush(i)) {}
+			}
+		});
+
+		bool ordered = true;
+		for (unsigned i = 0; i < numItems; ++i)
+		{
+			unsigned value;
+			while (!queue.TryPop(value)) {}
+			ordered = ordered && value == i;
+		}
+
+		producer.join();
+		CHECK(ordered);
+		CHECK(queue.IsEmpty());
+	}
+
+	SECTION("MpmcBoundedQueue")
+	{
+		MpmcBoundedQueue<std::unique_ptr<int>, 4> queue;
+
+		std::unique_ptr<int> value;
+		CHECK(!queue.TryPop(value));
+
+		for (int i = 0; i < 4; ++i)
+		{
+			CHECK(queue.TryPush(std::make_unique<int>(i)));
+		}
+		CHECK(!queue.TryPush(std::make_unique<int>(4)));
+
+		for (int i = 0; i < 4; ++i)
+		{
+			REQUIRE(queue.TryPop(value));
+			CHECK(*value == i);
+		}
+		CHECK(!queue.TryPop(value));
+
+		CHECK(queue.TryPush(std::make_unique<int>(5)));
+	}
+
+	SECTION("MpmcBoundedQueue Threads")
+	{
+		constexpr unsigned numProducers = 3;
+		constexpr unsigned numConsumers = 3;
+		constexpr unsigned numItems = 30000;
+		MpmcBoundedQueue<unsigned, 128> queue;
+
+		// Every value is consumed exactly once, and each producer's values come out in order.
+		std::vector<std::atomic<unsigned>> seen(numProducers * numItems);
+		std::atomic<unsigned> numConsumed = 0;
+		std::atomic<bool> ordered = true;
+
+		std::vector<std::thread> threads;
+		for (unsigned p = 0; p < numProducers; ++p)
+		{
+			threads.emplace_back([&, p]() {
+				for (unsigned i = 0; i < numItems; ++i)
+				{
+					while (!queue.TryPush(p * numItems + i)) {}
+				}
+			});
+		}
+
+		for (unsigned c = 0; c < numConsumers; ++c)
+		{
+			threads.emplace_back([&]() {
+				std::vector<int> last(numProducers, -1);
+				while (numConsumed.load() < numProducers * numItems)
+				{
+					unsigned value;
+					if (queue.TryPop(value))
+					{
+						const unsigned producer = value / numItems;
+						const int index = value % numItems;
+						if (index <= last[producer])
+						{
+							ordered = false;
+						}
+
+						last[producer] = index;
+						seen[value]++;
+						numConsumed++;
+					}
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		bool once = true;
+		for (auto& count : seen)
+		{
+			once = once && count == 1;
+		}
+
+		CHECK(once);
+		CHECK(ordered);
+	}
+}
+
+TEST_CASE("Concurrent Queues Benchmark", "[!benchmark]")
+{
+	constexpr unsigned numItems = 200000;
+
+	// A locked std::queue for comparison.
+	struct LockedQueue
+	{
+		bool TryPush(unsigned value)
+		{
+			std::lock_guard guard(lock);
+			items.push(value);
+			return true;
+		}
+
+		bool TryPop(unsigned& out)
+		{
+			std::lock_guard guard(lock);
+			if (items.empty())
+			{
+				return false;
+			}
+
+			out = items.front();
+			items.pop();
+			return true;
+		}
+
+		std::mutex lock;
+		std::queue<unsigned> items;
+	};
+
+	auto transfer = [](auto& queue, unsigned numProducers, unsigned numConsumers) {
+		std::atomic<unsigned> numConsumed = 0;
+		std::vector<std::thread> threads;
+		for (unsigned p = 0; p < numProducers; ++p)
+		{
+			threads.emplace_back([&]() {
+				for (unsigned i = 0; i < numItems / numProducers; ++i)
+				{
+					while (!queue.TryPush(i)) { std::this_thread::yield(); }
+				}
+			});
+		}
+
+		for (unsigned c = 0; c < numConsumers; ++c)
+		{
+			threads.emplace_back([&]() {
+				unsigned value;
+				while (numConsumed.load(std::memory_order_relaxed) < numItems / numProducers * numProducers)
+				{
+					if (queue.TryPop(value))
+					{
+						numConsumed.fetch_add(1, std::memory_order_relaxed);
+					}
+					else
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	};
+
+	{
+		LockedQueue locked;
+		BENCHMARK("Locked Queue 1 to 1")
+		{
+			transfer(locked, 1, 1);
+		}
+
+		auto spsc = std::make_unique<SpscRingBuffer<unsigned, 1024>>();
+		BENCHMARK("SpscRingBuffer 1 to 1")
+		{
+			transfer(*spsc, 1, 1);
+		}
+
+		auto mpmc = std::make_unique<MpmcBoundedQueue<unsigned, 1024>>();
+		BENCHMARK("MpmcBoundedQueue 1 to 1")
+		{
+			transfer(*mpmc, 1, 1);
+		}
+	}
+
+	{
+		LockedQueue locked;
+		BENCHMARK("Locked Queue 4 to 4")
+		{
+			transfer(locked, 4, 4);
+		}
+
+		auto mpmc = std::make_unique<MpmcBoundedQueue<unsigned, 1024>>();
+		BENCHMARK("MpmcBoundedQueue 4 to 4")
+		{
+			transfer(*mpmc, 4, 4);
+		}
+	}
+}
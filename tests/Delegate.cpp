@@ -1,6 +1,7 @@
 #include <catch/catch.hpp>
 #include <gemcutter/Application/Delegate.h>
 #include <gemcutter/Application/Event.h>
+#include <gemcutter/Application/InlineDelegate.h>
 #include <gemcutter/Entity/Entity.h>
 
 using namespace gem;
@@ -180,3 +181,274 @@ TEST_CASE("Events")
 		}
 	}
 }
+
+TEST_CASE("Inline Events")
+{
+	SECTION("Delegates")
+	{
+		int count = 0;
+		std::optional<int> result;
+
+		InlineDelegate<int()> delegate;
+		CHECK(!delegate);
+
+		InlineDelegateHandle handle = delegate.Bind([&]() { return ++count; });
+		CHECK(delegate);
+		CHECK(count == 0);
+
+		result = delegate();
+		REQUIRE(result.has_value());
+		CHECK(result.value() == 1);
+		CHECK(count == 1);
+
+		SECTION("Handle Expired")
+		{
+			handle.Expire();
+			CHECK(!delegate);
+
+			result = delegate();
+			CHECK(!result.has_value());
+			CHECK(count == 1);
+		}
+
+		SECTION("Handle Moved")
+		{
+			InlineDelegateHandle movedHandle = std::move(handle);
+			handle.Expire();
+			CHECK(delegate);
+
+			movedHandle.Expire();
+			CHECK(!delegate);
+		}
+
+		SECTION("Moved")
+		{
+			InlineDelegate<int()> movedDelegate = std::move(delegate);
+			CHECK(movedDelegate);
+
+			result = movedDelegate();
+			REQUIRE(result.has_value());
+			CHECK(result.value() == 2);
+
+			handle.Expire();
+			CHECK(!movedDelegate);
+		}
+
+		SECTION("Clear")
+		{
+			delegate.Clear();
+			CHECK(!delegate);
+
+			result = delegate();
+			CHECK(!result.has_value());
+			CHECK(count == 1);
+
+			// The handle no longer refers to the delegate.
+			InlineDelegateHandle newHandle = delegate.Bind([&]() { return count += 10; });
+			handle.Expire();
+			CHECK(delegate);
+		}
+
+		SECTION("Destroyed First")
+		{
+			auto temporary = std::make_unique<InlineDelegate<void()>>();
+			InlineDelegateHandle temporaryHandle = temporary->Bind([]() {});
+
+			temporary.reset();
+			temporaryHandle.Expire();
+		}
+	}
+
+	SECTION("Captured State")
+	{
+		auto counter = std::make_shared<int>(0);
+
+		InlineDelegate<void(int)> delegate;
+		InlineDelegateHandle handle = delegate.Bind([counter](int amount) { *counter += amount; });
+		CHECK(counter.use_count() == 2);
+
+		delegate(5);
+		CHECK(*counter == 5);
+
+		delegate.Clear();
+		CHECK(counter.use_count() == 1);
+	}
+
+	SECTION("Dispatcher")
+	{
+		int countA = 0;
+		int countB = 0;
+
+		InlineDispatcher<void()> dispatcher;
+		CHECK(!dispatcher.HasBindings());
+
+		InlineDelegateHandle handleA = dispatcher.Add([&]() { countA++; });
+		InlineDelegateHandle handleB = dispatcher.Add([&]() { countB++; });
+		CHECK(dispatcher.HasBindings());
+
+		dispatcher.Dispatch();
+		CHECK(countA == 1);
+		CHECK(countB == 1);
+
+		SECTION("Handles Expired")
+		{
+			handleA.Expire();
+			CHECK(dispatcher.HasBindings());
+
+			dispatcher.Dispatch();
+			CHECK(countA == 1);
+			CHECK(countB == 2);
+
+			handleB.Expire();
+			CHECK(!dispatcher.HasBindings());
+
+			dispatcher.Dispatch();
+			CHECK(countA == 1);
+			CHECK(countB == 2);
+		}
+
+		SECTION("Moved")
+		{
+			InlineDispatcher<void()> movedDispatcher = std::move(dispatcher);
+			CHECK(movedDispatcher.HasBindings());
+
+			movedDispatcher.Dispatch();
+			CHECK(countA == 2);
+			CHECK(countB == 2);
+
+			handleA.Expire();
+			movedDispatcher.Dispatch();
+			CHECK(countA == 2);
+			CHECK(countB == 3);
+		}
+
+		SECTION("Clear")
+		{
+			dispatcher.Clear();
+			CHECK(!dispatcher.HasBindings());
+
+			dispatcher.Dispatch();
+			CHECK(countA == 1);
+			CHECK(countB == 1);
+		}
+
+		SECTION("Changed During Dispatch")
+		{
+			std::vector<InlineDelegateHandle> added;
+
+			// Adds enough bindings to force the storage to grow, and expires itself.
+			InlineDelegateHandle handleC;
+			handleC = dispatcher.Add([&]() {
+				handleC.Expire();
+				for (unsigned i = 0; i < 64; ++i)
+				{
+					added.push_back(dispatcher.Add([&]() { countA++; }));
+				}
+			});
+
+			dispatcher.Dispatch();
+			CHECK(added.size() == 64);
+			CHECK(countA == 2);
+			CHECK(countB == 2);
+
+			dispatcher.Dispatch();
+			CHECK(added.size() == 64);
+			CHECK(countA == 3 + 64);
+			CHECK(countB == 3);
+
+			added.clear();
+			dispatcher.Dispatch();
+			CHECK(countA == 4 + 64);
+			CHECK(countB == 4);
+		}
+	}
+}
+
+TEST_CASE("Delegate Benchmark", "[!benchmark]")
+{
+	constexpr unsigned numBindings = 16;
+	constexpr unsigned numDispatches = 10000;
+
+	int count = 0;
+
+	SECTION("Delegate")
+	{
+		Delegate<int(int)> delegate;
+		DelegateHandle handle = delegate.Bind([&](int value) { return count += value; });
+
+		InlineDelegate<int(int)> inlineDelegate;
+		InlineDelegateHandle inlineHandle = inlineDelegate.Bind([&](int value) { return count += value; });
+
+		BENCHMARK("Delegate")
+		{
+			for (unsigned i = 0; i < numDispatches; ++i)
+			{
+				delegate(1);
+			}
+		}
+
+		BENCHMARK("InlineDelegate")
+		{
+			for (unsigned i = 0; i < numDispatches; ++i)
+			{
+				inlineDelegate(1);
+			}
+		}
+	}
+
+	SECTION("Dispatcher")
+	{
+		Dispatcher<void(int)> dispatcher;
+		InlineDispatcher<void(int)> inlineDispatcher;
+		std::vector<DelegateHandle> handles;
+		std::vector<InlineDelegateHandle> inlineHandles;
+
+		for (unsigned i = 0; i < numBindings; ++i)
+		{
+			handles.push_back(dispatcher.Add([&](int value) { count += value; }));
+			inlineHandles.push_back(inlineDispatcher.Add([&](int value) { count += value; }));
+		}
+
+		BENCHMARK("Dispatcher")
+		{
+			for (unsigned i = 0; i < numDispatches; ++i)
+			{
+				dispatcher.Dispatch(1);
+			}
+		}
+
+		BENCHMARK("InlineDispatcher")
+		{
+			for (unsigned i = 0; i < numDispatches; ++i)
+			{
+				inlineDispatcher.Dispatch(1);
+			}
+		}
+	}
+
+	SECTION("Binding")
+	{
+		Dispatcher<void(int)> dispatcher;
+		InlineDispatcher<void(int)> inlineDispatcher;
+
+		BENCHMARK("Dispatcher Add and Expire")
+		{
+			for (unsigned i = 0; i < numDispatches; ++i)
+			{
+				DelegateHandle handle = dispatcher.Add([&](int value) { count += value; });
+				dispatcher.Dispatch(1);
+			}
+		}
+
+		BENCHMARK("InlineDispatcher Add and Expire")
+		{
+			for (unsigned i = 0; i < numDispatches; ++i)
+			{
+				InlineDelegateHandle handle = inlineDispatcher.Add([&](int value) { count += value; });
+				inlineDispatcher.Dispatch(1);
+			}
+		}
+	}
+
+	CHECK(count != 0);
+}
@@ -0,0 +1,561 @@
+#include <catch/catch.hpp>
+#include <gemcutter/Application/Event.h>
+#include <gemcutter/Application/HierarchicalEvent.h>
+
+#include <thread>
+
+using namespace gem;
+
+struct TestEvent : public Event<TestEvent>
+{
+	TestEvent(int _value) : value(_value) {}
+
+	int value;
+};
+
+struct OtherEvent : public Event<OtherEvent>
+{
+	OtherEvent(int _value) : value(_value) {}
+
+	int value;
+};
+
+struct LatestEvent : public Event<LatestEvent>
+{
+	static constexpr QueuePolicy queuePolicy = QueuePolicy::Latest;
+
+	LatestEvent(int _value) : value(_value) {}
+
+	const int value;
+};
+
+struct SumEvent : public Event<SumEvent>
+{
+	static constexpr QueuePolicy queuePolicy = QueuePolicy::Accumulate;
+
+	SumEvent(int _value) : value(_value) {}
+
+	static SumEvent Accumulate(const SumEvent& previous, const SumEvent& next)
+	{
+		return SumEvent(previous.value + next.value);
+	}
+
+	const int value;
+};
+
+struct UrgentEvent : public Event<UrgentEvent>
+{
+	static constexpr int queuePriority = 10;
+	static constexpr bool dropWithoutListeners = true;
+
+	UrgentEvent(int _value) : value(_value) {}
+
+	int value;
+};
+
+struct ClickEvent : public Event<ClickEvent>
+{
+	ClickEvent(int _value) : value(_value) {}
+
+	int value;
+};
+
+TEST_CASE("Event Queue")
+{
+	std::vector<int> received;
+	Listener<TestEvent> listener([&](const TestEvent& e) { received.push_back(e.value); });
+
+	SECTION("Order")
+	{
+		EventQueue.Push(std::make_unique<TestEvent>(1));
+		EventQueue.Push(std::make_unique<TestEvent>(2));
+		EventQueue.Push(std::make_unique<TestEvent>(3));
+		CHECK(received.empty());
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 1, 2, 3 });
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 1, 2, 3 });
+	}
+
+	SECTION("Batch")
+	{
+		EventBatch batch;
+		CHECK(batch.IsEmpty());
+
+		batch.Push(std::make_unique<TestEvent>(2));
+		batch.Push(std::make_unique<TestEvent>(3));
+		CHECK(!batch.IsEmpty());
+
+		EventQueue.Push(std::make_unique<TestEvent>(1));
+		EventQueue.Push(batch);
+		EventQueue.Push(std::make_unique<TestEvent>(4));
+		CHECK(batch.IsEmpty());
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 1, 2, 3, 4 });
+	}
+
+	SECTION("Posted During Dispatch")
+	{
+		Listener<TestEvent> reposter([](const TestEvent& e) {
+			if (e.value < 3)
+			{
+				EventQueue.Push(std::make_unique<TestEvent>(e.value + 1));
+			}
+		});
+
+		EventQueue.Push(std::make_unique<TestEvent>(1));
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 1 });
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 1, 2 });
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 1, 2, 3 });
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 1, 2, 3 });
+	}
+
+	SECTION("Emplaced")
+	{
+		Listener<OtherEvent> otherListener([&](const OtherEvent& e) { received.push_back(-e.value); });
+
+		EventQueue.Emplace<OtherEvent>(4);
+		EventQueue.Emplace<TestEvent>(2);
+		EventQueue.Emplace<OtherEvent>(5);
+		EventQueue.Push(std::make_unique<TestEvent>(1));
+		EventQueue.Emplace<TestEvent>(3);
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 1, -4, -5, 2, 3 });
+
+		EventQueue.Dispatch();
+		CHECK(received.size() == 5);
+
+		// Emplaced events posted during a dispatch wait for the next one.
+		Listener<TestEvent> reposter([](const TestEvent& e) {
+			if (e.value < 2)
+			{
+				EventQueue.Emplace<TestEvent>(e.value + 1);
+			}
+		});
+
+		received.clear();
+		EventQueue.Emplace<TestEvent>(1);
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 1 });
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 1, 2 });
+
+		// The same goes for events posted by listeners of pushed events.
+		received.clear();
+		EventQueue.Push(std::make_unique<TestEvent>(1));
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 1 });
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 1, 2 });
+
+		// And for types which have events waiting to be raised later in the same dispatch.
+		Listener<UrgentEvent> urgentListener([](const UrgentEvent& e) { EventQueue.Emplace<OtherEvent>(e.value); });
+
+		received.clear();
+		EventQueue.Emplace<OtherEvent>(1);
+		EventQueue.Emplace<UrgentEvent>(2);
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ -1 });
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ -1, -2 });
+	}
+
+	SECTION("Policies")
+	{
+		Listener<LatestEvent> latestListener([&](const LatestEvent& e) { received.push_back(e.value); });
+		Listener<SumEvent> sumListener([&](const SumEvent& e) { received.push_back(e.value); });
+
+		EventQueue.Emplace<TestEvent>(1);
+		EventQueue.Emplace<LatestEvent>(2);
+		EventQueue.Emplace<LatestEvent>(3);
+		EventQueue.Emplace<SumEvent>(4);
+		EventQueue.Emplace<SumEvent>(5);
+		EventQueue.Emplace<SumEvent>(6);
+		EventQueue.Emplace<TestEvent>(7);
+
+		// UrgentEvent has no listeners yet, so it is dropped.
+		EventQueue.Emplace<UrgentEvent>(8);
+		CHECK(!UrgentEvent::HasListenersStatic());
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 1, 7, 3, 15 });
+
+		Listener<UrgentEvent> urgentListener([&](const UrgentEvent& e) { received.push_back(e.value); });
+		CHECK(UrgentEvent::HasListenersStatic());
+
+		received.clear();
+		EventQueue.Emplace<SumEvent>(1);
+		EventQueue.Emplace<TestEvent>(2);
+		EventQueue.Emplace<UrgentEvent>(3);
+		EventQueue.Emplace<UrgentEvent>(4);
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 3, 4, 1, 2 });
+	}
+
+	SECTION("Multiple Threads")
+	{
+		Listener<OtherEvent> otherListener([&](const OtherEvent& e) { received.push_back(e.value); });
+
+		constexpr int numThreads = 4;
+		constexpr int numEvents = 1000;
+
+		std::vector<std::thread> threads;
+		for (int t = 0; t < numThreads; ++t)
+		{
+			threads.emplace_back([t]() {
+				EventBatch batch;
+				for (int i = 0; i < numEvents; ++i)
+				{
+					const int value = t * numEvents + i;
+					if (i % 3 == 0)
+					{
+						EventQueue.Push(std::make_unique<TestEvent>(value));
+					}
+					else if (i % 3 == 1)
+					{
+						EventQueue.Emplace<OtherEvent>(value);
+					}
+					else
+					{
+						batch.Push(std::make_unique<TestEvent>(value));
+						EventQueue.Push(batch);
+					}
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		EventQueue.Dispatch();
+		REQUIRE(received.size() == numThreads * numEvents);
+
+		// Events of the same kind from each thread must keep their relative order.
+		std::vector<int> lastSeen(numThreads * 2, -1);
+		for (int value : received)
+		{
+			const int index = (value / numEvents) * 2 + (value % numEvents % 3 == 1);
+			CHECK(value > lastSeen[index]);
+			lastSeen[index] = value;
+		}
+	}
+}
+
+TEST_CASE("Event Listeners")
+{
+	std::vector<int> received;
+	auto makeListener = [&](int id) {
+		return std::make_unique<Listener<TestEvent>>([&received, id](const TestEvent&) { received.push_back(id); });
+	};
+
+	auto l1 = makeListener(1);
+	auto l2 = makeListener(2);
+	auto l3 = makeListener(3);
+	CHECK(TestEvent::GetListenersStatic().size() == 3);
+
+	SECTION("Unsubscribe")
+	{
+		l2.reset();
+		CHECK(TestEvent::HasListenersStatic());
+
+		EventQueue.Dispatch(TestEvent(0));
+		CHECK(received == std::vector<int>{ 1, 3 });
+		CHECK(TestEvent::GetListenersStatic().size() == 2);
+
+		// Order of subscription is kept after compaction.
+		auto l4 = makeListener(4);
+		l1.reset();
+		received.clear();
+		EventQueue.Dispatch(TestEvent(0));
+		CHECK(received == std::vector<int>{ 3, 4 });
+
+		l3.reset();
+		l4.reset();
+		CHECK(!TestEvent::HasListenersStatic());
+		CHECK(TestEvent::GetListenersStatic().empty());
+	}
+
+	SECTION("Unsubscribe During Raise")
+	{
+		std::unique_ptr<Listener<TestEvent>> l4;
+		Listener<TestEvent> remover([&](const TestEvent&) {
+			l1.reset();
+			l4.reset();
+		});
+		l4 = makeListener(4);
+
+		// The listener after the remover is skipped.
+		EventQueue.Dispatch(TestEvent(0));
+		CHECK(received == std::vector<int>{ 1, 2, 3 });
+
+		received.clear();
+		EventQueue.Dispatch(TestEvent(0));
+		CHECK(received == std::vector<int>{ 2, 3 });
+	}
+
+	SECTION("Subscribe During Raise")
+	{
+		std::unique_ptr<Listener<TestEvent>> l4;
+		Listener<TestEvent> adder([&](const TestEvent&) {
+			if (!l4)
+			{
+				l4 = makeListener(4);
+			}
+		});
+
+		EventQueue.Dispatch(TestEvent(0));
+		CHECK(received == std::vector<int>{ 1, 2, 3, 4 });
+	}
+
+	SECTION("Churn")
+	{
+		// Listeners that come and go without the event being raised don't accumulate.
+		for (unsigned i = 0; i < 1000; ++i)
+		{
+			auto temp = makeListener(0);
+		}
+
+		CHECK(TestEvent::GetListenersStatic().size() == 3);
+	}
+}
+
+TEST_CASE("Hierarchical Events")
+{
+	std::vector<int> order;
+	std::vector<DelegateHandle> handles;
+
+	auto listen = [&](Entity& ent, int id, bool consume = false) {
+		auto& listener = ent.Add<HierarchicalListener<ClickEvent>>();
+		handles.push_back(listener.callback.Bind([&order, id, consume](const ClickEvent&) {
+			order.push_back(id);
+			return consume;
+		}));
+	};
+
+	// root
+	// |- a
+	// |  |- c
+	// |- b
+	//    |- d
+	auto root = Entity::MakeNewRoot();
+	root->Add<HierarchicalDispatcher<ClickEvent>>();
+	auto a = root->Get<Hierarchy>().CreateChild();
+	auto b = root->Get<Hierarchy>().CreateChild();
+	auto c = a->Get<Hierarchy>().CreateChild();
+	auto d = b->Get<Hierarchy>().CreateChild();
+
+	listen(*a, 1);
+	listen(*b, 2);
+	listen(*c, 3);
+	listen(*d, 4);
+
+	SECTION("Order")
+	{
+		EventQueue.Dispatch(ClickEvent(0));
+		CHECK(order == std::vector<int>{ 1, 2, 3, 4 });
+
+		order.clear();
+		EventQueue.Dispatch(ClickEvent(0));
+		CHECK(order == std::vector<int>{ 1, 2, 3, 4 });
+	}
+
+	SECTION("Consumed")
+	{
+		b->Remove<HierarchicalListener<ClickEvent>>();
+		listen(*b, 2, true);
+
+		EventQueue.Dispatch(ClickEvent(0));
+		CHECK(order == std::vector<int>{ 1, 2 });
+	}
+
+	SECTION("Listeners Changed")
+	{
+		EventQueue.Dispatch(ClickEvent(0));
+		order.clear();
+
+		a->Remove<HierarchicalListener<ClickEvent>>();
+		auto e = d->Get<Hierarchy>().CreateChild();
+		listen(*e, 5);
+
+		EventQueue.Dispatch(ClickEvent(0));
+		CHECK(order == std::vector<int>{ 2, 3, 4, 5 });
+	}
+
+	SECTION("Hierarchy Changed")
+	{
+		EventQueue.Dispatch(ClickEvent(0));
+		order.clear();
+
+		a->Get<Hierarchy>().RemoveChild(*c);
+		d->Get<Hierarchy>().AddChild(c);
+
+		EventQueue.Dispatch(ClickEvent(0));
+		CHECK(order == std::vector<int>{ 1, 2, 4, 3 });
+
+		order.clear();
+		root->Get<Hierarchy>().ClearChildren();
+
+		EventQueue.Dispatch(ClickEvent(0));
+		CHECK(order.empty());
+	}
+
+	SECTION("Changed During Dispatch")
+	{
+		// The first listener to be notified detaches another listener's Entity and adds a new one.
+		a->Remove<HierarchicalListener<ClickEvent>>();
+		auto& listener = a->Add<HierarchicalListener<ClickEvent>>();
+		handles.push_back(listener.callback.Bind([&](const ClickEvent&) {
+			order.push_back(1);
+			b->Get<Hierarchy>().RemoveChild(*d);
+			d.reset();
+			listen(*c->Get<Hierarchy>().CreateChild(), 5);
+			return false;
+		}));
+
+		EventQueue.Dispatch(ClickEvent(0));
+		CHECK(order == std::vector<int>{ 1, 2, 3, 5 });
+
+		order.clear();
+		EventQueue.Dispatch(ClickEvent(0));
+		CHECK(order.size() == 5);
+	}
+
+	SECTION("Nested Dispatch")
+	{
+		a->Remove<HierarchicalListener<ClickEvent>>();
+		auto& listener = a->Add<HierarchicalListener<ClickEvent>>();
+		handles.push_back(listener.callback.Bind([&](const ClickEvent& e) {
+			order.push_back(1);
+			if (e.value == 0)
+			{
+				EventQueue.Dispatch(ClickEvent(1));
+			}
+			return false;
+		}));
+
+		EventQueue.Dispatch(ClickEvent(0));
+		CHECK(order == std::vector<int>{ 1, 1, 2, 3, 4, 2, 3, 4 });
+	}
+}
+
+TEST_CASE("Event Queue Benchmark", "[!benchmark]")
+{
+	constexpr int numFrames = 100;
+	constexpr int numEvents = 1000;
+
+	int sum = 0;
+	Listener<TestEvent> listener([&](const TestEvent& e) { sum += e.value; });
+
+	BENCHMARK("Push")
+	{
+		for (int frame = 0; frame < numFrames; ++frame)
+		{
+			for (int i = 0; i < numEvents; ++i)
+			{
+				EventQueue.Push(std::make_unique<TestEvent>(i));
+			}
+
+			EventQueue.Dispatch();
+		}
+	}
+
+	BENCHMARK("Emplace")
+	{
+		for (int frame = 0; frame < numFrames; ++frame)
+		{
+			for (int i = 0; i < numEvents; ++i)
+			{
+				EventQueue.Emplace<TestEvent>(i);
+			}
+
+			EventQueue.Dispatch();
+		}
+	}
+
+	CHECK(sum != 0);
+}
+
+TEST_CASE("Event Listeners Benchmark", "[!benchmark]")
+{
+	constexpr unsigned numListeners = 20000;
+
+	std::vector<std::unique_ptr<Listener<TestEvent>>> listeners;
+	listeners.reserve(numListeners);
+
+	BENCHMARK("Subscribe and Unsubscribe")
+	{
+		for (unsigned i = 0; i < numListeners; ++i)
+		{
+			listeners.push_back(std::make_unique<Listener<TestEvent>>([](const TestEvent&) {}));
+		}
+
+		// Teardown in creation order, which was the worst case for a linear search.
+		for (auto& listener : listeners)
+		{
+			listener.reset();
+		}
+
+		listeners.clear();
+		EventQueue.Dispatch(TestEvent(0));
+	}
+
+	CHECK(!TestEvent::HasListenersStatic());
+}
+
+TEST_CASE("Hierarchical Events Benchmark", "[!benchmark]")
+{
+	// A wide and deep tree where only a handful of Entities are listening.
+	auto root = Entity::MakeNewRoot();
+	root->Add<HierarchicalDispatcher<ClickEvent>>();
+
+	std::vector<Entity::Ptr> nodes = { root };
+	for (unsigned i = 0; nodes.size() < 5000; ++i)
+	{
+		for (unsigned j = 0; j < 4; ++j)
+		{
+			nodes.push_back(nodes[i]->Get<Hierarchy>().CreateChild());
+		}
+	}
+
+	int count = 0;
+	std::vector<DelegateHandle> handles;
+	for (unsigned i = 1; i < nodes.size(); i += 500)
+	{
+		auto& listener = nodes[i]->Add<HierarchicalListener<ClickEvent>>();
+		handles.push_back(listener.callback.Bind([&](const ClickEvent& e) {
+			count += e.value;
+			return false;
+		}));
+	}
+
+	BENCHMARK("Distribute")
+	{
+		for (unsigned i = 0; i < 1000; ++i)
+		{
+			EventQueue.Dispatch(ClickEvent(1));
+		}
+	}
+
+	CHECK(count != 0);
+}
@@ -1,6 +1,9 @@
 #include <catch/catch.hpp>
 #include <gemcutter/Application/FileSystem.h>
 
+#include <cstdio>
+#include <fstream>
+
 using namespace gem;
 
 TEST_CASE("FileSystem")
@@ -32,3 +35,114 @@ TEST_CASE("FileSystem")
 		CHECK(ExtractFileExtension("C:/user/test5.txt.zip") == ".zip");
 	}
 }
+
+TEST_CASE("FileReader")
+{
+	const char* fileName = "FileReaderTest.txt";
+	{
+		std::ofstream output(fileName, std::ofstream::binary);
+		output << "first line\nsecond  words\t here\n3.5 -42 7x\n\nlast";
+	}
+
+	auto checkContents = [](FileReader& reader) {
+		CHECK(reader.GetSize() == 47);
+		CHECK(reader.GetLine() == "first line");
+		CHECK(reader.GetWord() == "second");
+		CHECK(reader.GetWord() == "words");
+		CHECK(reader.GetWord() == "here");
+		CHECK(reader.GetFloat() == 3.5f);
+		CHECK(reader.GetInt() == -42);
+		CHECK(reader.GetInt() == 7);
+		CHECK(reader.GetChar() == 'x');
+	};
+
+	SECTION("Buffer")
+	{
+		FileReader reader;
+		REQUIRE(reader.OpenAsBuffer(fileName));
+		checkContents(reader);
+
+		CHECK(reader.GetContents() == "\n\nlast");
+		CHECK(reader.IsEOF());
+	}
+
+	SECTION("Mapped")
+	{
+		FileReader reader;
+		REQUIRE(reader.OpenAsMapped(fileName));
+		checkContents(reader);
+
+		CHECK(reader.GetLineView() == "");
+		CHECK(reader.GetLineView() == "");
+		CHECK(reader.GetWordView() == "last");
+		CHECK(reader.IsEOF());
+		CHECK(reader.GetWordView().empty());
+		CHECK(reader.GetInt() == 0);
+
+		reader.Close();
+		CHECK(!reader);
+	}
+
+	SECTION("Stream")
+	{
+		FileReader reader;
+		REQUIRE(reader.OpenAsStream(fileName));
+		checkContents(reader);
+	}
+
+	SECTION("Line Endings")
+	{
+		{
+			std::ofstream output(fileName, std::ofstream::binary);
+			output << "key=value\r\nother=\r\n";
+		}
+
+		FileReader reader;
+		REQUIRE(reader.OpenAsMapped(fileName));
+		CHECK(reader.GetLineView() == "key=value");
+		CHECK(reader.GetLineView() == "other=");
+		CHECK(reader.IsEOF());
+	}
+
+	SECTION("Numbers")
+	{
+		{
+			std::ofstream output(fileName, std::ofstream::binary);
+			output << "+5 +2.5\nword\n12";
+		}
+
+		FileReader reader;
+		REQUIRE(reader.OpenAsMapped(fileName));
+		CHECK(reader.GetInt() == 5);
+		CHECK(reader.GetFloat() == 2.5f);
+
+		// A failed read doesn't move past the end of the line.
+		CHECK(reader.GetInt() == 0);
+		CHECK(reader.GetFloat() == 0.0f);
+		CHECK(reader.GetLineView() == "");
+		CHECK(reader.GetLineView() == "word");
+		CHECK(reader.GetInt() == 12);
+		CHECK(reader.IsEOF());
+	}
+
+	SECTION("Missing and Empty Files")
+	{
+		FileReader missing;
+		CHECK_FALSE(missing.OpenAsMapped("MissingFile.txt"));
+		CHECK(!missing);
+
+		std::ofstream(fileName, std::ofstream::trunc);
+
+		MappedFile mapped;
+		REQUIRE(mapped.Open(fileName));
+		CHECK(mapped.IsOpen());
+		CHECK(mapped.GetSize() == 0);
+		CHECK(mapped.GetView().empty());
+
+		MappedFile moved = std::move(mapped);
+		CHECK(moved.IsOpen());
+		CHECK_FALSE(mapped.IsOpen());
+	}
+
+	std::remove(fileName);
+}
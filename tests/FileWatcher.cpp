@@ -0,0 +1,76 @@
+#include <catch/catch.hpp>
+#include <gemcutter/Application/FileSystem.h>
+#include <gemcutter/Application/FileWatcher.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gem;
+
+namespace
+{
+	void WriteFile(const std::string& fileName, std::string_view contents)
+	{
+		std::ofstream output(fileName, std::ofstream::binary);
+		output.write(contents.data(), contents.size());
+	}
+
+	bool Contains(const std::vector<std::string>& files, std::string_view file)
+	{
+		return std::find(files.begin(), files.end(), file) != files.end();
+	}
+
+	// The OS reports changes asynchronously, so they are polled for a while.
+	void PollUntil(FileWatcher& watcher, std::vector<std::string>& changes, std::string_view file)
+	{
+		for (unsigned i = 0; i < 200 && !Contains(changes, file); ++i)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			watcher.PollChanges(changes);
+		}
+	}
+}
+
+TEST_CASE("FileWatcher")
+{
+	REQUIRE(MakeDirectory("FileWatcherTest/Models"));
+
+	FileWatcher watcher;
+	CHECK_FALSE(watcher.IsWatching());
+	REQUIRE(watcher.Start("FileWatcherTest"));
+	CHECK(watcher.IsWatching());
+
+	std::vector<std::string> changes;
+	watcher.PollChanges(changes);
+	CHECK(changes.empty());
+
+	SECTION("Changes")
+	{
+		WriteFile("FileWatcherTest/Value.txt", "one");
+		WriteFile("FileWatcherTest/Models/Crate.model", "crate");
+		WriteFile("FileWatcherTest/Models/Crate.model", "crate again");
+
+		PollUntil(watcher, changes, "FileWatcherTest/Value.txt");
+		PollUntil(watcher, changes, "FileWatcherTest/Models/Crate.model");
+		CHECK(Contains(changes, "FileWatcherTest/Value.txt"));
+		CHECK(Contains(changes, "FileWatcherTest/Models/Crate.model"));
+		CHECK(std::count(changes.begin(), changes.end(), "FileWatcherTest/Value.txt") == 1);
+	}
+
+	SECTION("Stop")
+	{
+		watcher.Stop();
+		CHECK_FALSE(watcher.IsWatching());
+
+		CHECK_FALSE(watcher.Start("FileWatcherTest/Missing"));
+		CHECK_FALSE(watcher.IsWatching());
+	}
+
+	watcher.Stop();
+	std::filesystem::remove_all("FileWatcherTest");
+}
@@ -0,0 +1,154 @@
+#include <catch/catch.hpp>
+#include <gemcutter/Application/FrameStats.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace gem;
+
+namespace
+{
+	FrameTiming Frame(float totalMS)
+	{
+		FrameTiming frame;
+		frame.updateMS = totalMS * 0.5f;
+		frame.renderMS = totalMS * 0.25f;
+		frame.idleMS = totalMS * 0.25f;
+		frame.totalMS = totalMS;
+
+		return frame;
+	}
+}
+
+TEST_CASE("Frame Stats")
+{
+	FrameStats stats;
+
+	SECTION("Empty")
+	{
+		CHECK(stats.GetNumFrames() == 0);
+		CHECK(stats.GetNumHitches() == 0);
+		CHECK(stats.GetPercentile(50.0f) == 0.0f);
+		CHECK(stats.GetSummary().max == 0.0f);
+		CHECK(stats.GetLastFrame().totalMS == 0.0f);
+	}
+
+	SECTION("Percentiles")
+	{
+		// Frame times from 1ms to 100ms, in a shuffled order.
+		for (unsigned i = 0; i < 100; ++i)
+		{
+			stats.AddFrame(Frame(static_cast<float>((i * 37) % 100 + 1)));
+		}
+
+		CHECK(stats.GetNumFrames() == 100);
+		CHECK(stats.GetLastFrame().totalMS == 64.0f);
+		CHECK(stats.GetPercentile(0.0f) == 1.0f);
+		CHECK(stats.GetPercentile(100.0f) == 100.0f);
+
+		const FrameTimeSummary summary = stats.GetSummary();
+		CHECK(summary.p50 == 50.0f);
+		CHECK(summary.p95 == 95.0f);
+		CHECK(summary.p99 == 99.0f);
+		CHECK(summary.max == 100.0f);
+		CHECK(summary.average == Approx(50.5f));
+
+		const FrameTiming average = stats.GetAverage();
+		CHECK(average.updateMS == Approx(25.25f));
+		CHECK(average.renderMS == Approx(12.625f));
+		CHECK(average.idleMS == Approx(12.625f));
+	}
+
+	SECTION("Rolling Window")
+	{
+		for (unsigned i = 0; i < FrameStats::HISTORY_SIZE; ++i)
+		{
+			stats.AddFrame(Frame(100.0f));
+		}
+
+		// Old frames are pushed out of the percentiles, but are still counted by the totals.
+		for (unsigned i = 0; i < FrameStats::HISTORY_SIZE; ++i)
+		{
+			stats.AddFrame(Frame(10.0f));
+		}
+
+		CHECK(stats.GetSummary().max == 10.0f);
+		CHECK(stats.GetNumFrames() == FrameStats::HISTORY_SIZE * 2);
+		CHECK(stats.GetNumHitches() == FrameStats::HISTORY_SIZE);
+	}
+
+	SECTION("Hitches and Histogram")
+	{
+		stats.SetHitchThreshold(20.0f);
+		CHECK(stats.GetHitchThreshold() == 20.0f);
+
+		stats.AddFrame(Frame(0.5f));
+		stats.AddFrame(Frame(16.6f));
+		stats.AddFrame(Frame(16.7f));
+		stats.AddFrame(Frame(20.0f));
+		stats.AddFrame(Frame(45.0f));
+		stats.AddFrame(Frame(500.0f));
+
+		CHECK(stats.GetNumHitches() == 2);
+
+		const auto& histogram = stats.GetHistogram();
+		CHECK(histogram[0] == 1);
+		CHECK(histogram[16] == 2);
+		CHECK(histogram[20] == 1);
+		CHECK(histogram[45] == 1);
+		CHECK(histogram[FrameStats::HISTOGRAM_SIZE - 1] == 1);
+
+		stats.Reset();
+		CHECK(stats.GetNumFrames() == 0);
+		CHECK(stats.GetNumHitches() == 0);
+		CHECK(stats.GetHistogram()[16] == 0);
+		CHECK(stats.GetSummary().max == 0.0f);
+	}
+
+	SECTION("Wake Latency")
+	{
+		CHECK(stats.GetWakeLatency().max == 0.0f);
+
+		for (unsigned i = 0; i < 99; ++i)
+		{
+			stats.AddWakeLatency(0.01f);
+		}
+		stats.AddWakeLatency(2.0f);
+
+		const FrameTimeSummary latency = stats.GetWakeLatency();
+		CHECK(latency.p50 == 0.01f);
+		CHECK(latency.p99 == 0.01f);
+		CHECK(latency.max == 2.0f);
+		CHECK(latency.average == Approx(0.0299f));
+
+		// Wake-ups are separate from frames.
+		CHECK(stats.GetNumFrames() == 0);
+
+		stats.Reset();
+		CHECK(stats.GetWakeLatency().max == 0.0f);
+	}
+
+	SECTION("Save")
+	{
+		stats.AddFrame(Frame(16.0f));
+		stats.AddFrame(Frame(50.0f));
+		stats.AddWakeLatency(0.5f);
+
+		const char* fileName = "FrameStatsTest.txt";
+		REQUIRE(stats.Save(fileName));
+
+		std::stringstream contents;
+		contents << std::ifstream(fileName).rdbuf();
+		std::remove(fileName);
+
+		const std::string text = contents.str();
+		CHECK(text.find("Frames: 2\n") != std::string::npos);
+		CHECK(text.find("Hitches (over 33.3333ms): 1\n") != std::string::npos);
+		CHECK(text.find("max: 50\n") != std::string::npos);
+		CHECK(text.find("Wake-up latency (ms):\np50: 0.5\n") != std::string::npos);
+		CHECK(text.find("16-17: 1\n") != std::string::npos);
+		CHECK(text.find("50-51: 1\n") != std::string::npos);
+	}
+}
@@ -1,6 +1,10 @@
 #include <catch/catch.hpp>
+#include <gemcutter/Application/Threading.h>
 #include <gemcutter/Entity/Entity.h>
 #include <gemcutter/Entity/Hierarchy.h>
+#include <gemcutter/Entity/HierarchyTraversal.h>
+
+#include <atomic>
 
 using namespace gem;
 
@@ -93,3 +97,133 @@ TEST_CASE("Hierarchy")
 		CHECK(root->Get<Hierarchy>().IsLeaf());
 	}
 }
+
+TEST_CASE("Hierarchy Traversal")
+{
+	auto root = Entity::MakeNewRoot("root");
+	auto a = root->Get<Hierarchy>().CreateChild();
+	auto a1 = a->Get<Hierarchy>().CreateChild();
+	auto a2 = a->Get<Hierarchy>().CreateChild();
+	auto b = root->Get<Hierarchy>().CreateChild();
+	auto b1 = b->Get<Hierarchy>().CreateChild();
+
+	HierarchyTraversal traversal;
+	std::vector<Entity*> visited;
+
+	auto walk = [&](TraversalOrder order) {
+		visited.clear();
+		for (Entity& ent : traversal.Walk(*root, order))
+		{
+			visited.push_back(&ent);
+		}
+
+		return visited;
+	};
+
+	SECTION("Orders")
+	{
+		CHECK(walk(TraversalOrder::PreOrder) == std::vector<Entity*>{ root.get(), a.get(), a1.get(), a2.get(), b.get(), b1.get() });
+		CHECK(traversal.IsFinished());
+
+		CHECK(walk(TraversalOrder::PostOrder) == std::vector<Entity*>{ a1.get(), a2.get(), a.get(), b1.get(), b.get(), root.get() });
+		CHECK(traversal.IsFinished());
+
+		CHECK(walk(TraversalOrder::BreadthFirst) == std::vector<Entity*>{ root.get(), a.get(), b.get(), a1.get(), a2.get(), b1.get() });
+		CHECK(traversal.IsFinished());
+	}
+
+	SECTION("Leaf")
+	{
+		auto loose = Entity::MakeNew();
+
+		for (auto order : { TraversalOrder::PreOrder, TraversalOrder::PostOrder, TraversalOrder::BreadthFirst })
+		{
+			visited.clear();
+			for (Entity& ent : traversal.Walk(*loose, order))
+			{
+				visited.push_back(&ent);
+			}
+
+			CHECK(visited == std::vector<Entity*>{ loose.get() });
+		}
+	}
+
+	SECTION("Skip Children")
+	{
+		visited.clear();
+		traversal.Start(*root, TraversalOrder::PreOrder);
+		while (Entity* ent = traversal.Next())
+		{
+			visited.push_back(ent);
+			if (ent == a.get())
+			{
+				traversal.SkipChildren();
+			}
+		}
+		CHECK(visited == std::vector<Entity*>{ root.get(), a.get(), b.get(), b1.get() });
+
+		visited.clear();
+		traversal.Start(*root, TraversalOrder::BreadthFirst);
+		while (Entity* ent = traversal.Next())
+		{
+			visited.push_back(ent);
+			if (ent == b.get())
+			{
+				traversal.SkipChildren();
+			}
+		}
+		CHECK(visited == std::vector<Entity*>{ root.get(), a.get(), b.get(), a1.get(), a2.get() });
+	}
+
+	SECTION("Paused")
+	{
+		traversal.Start(*root, TraversalOrder::PreOrder);
+		CHECK(!traversal.IsFinished());
+		CHECK(traversal.Next() == root.get());
+		CHECK(traversal.Next() == a.get());
+
+		traversal.Reset();
+		CHECK(traversal.IsFinished());
+		CHECK(traversal.Next() == nullptr);
+	}
+
+	SECTION("Deep")
+	{
+		Entity::Ptr leaf = b1;
+		for (unsigned i = 0; i < 1000; ++i)
+		{
+			leaf = leaf->Get<Hierarchy>().CreateChild();
+		}
+
+		CHECK(walk(TraversalOrder::PreOrder).size() == 1006);
+		CHECK(visited.back() == leaf.get());
+
+		CHECK(walk(TraversalOrder::PostOrder).size() == 1006);
+		CHECK(visited.front() == a1.get());
+		CHECK(visited.back() == root.get());
+
+		b1->Get<Hierarchy>().ClearChildren();
+	}
+
+	SECTION("Parallel")
+	{
+		std::vector<Entity::Ptr> extra;
+		for (unsigned i = 0; i < 500; ++i)
+		{
+			extra.push_back(a1->Get<Hierarchy>().CreateChild());
+			extra.push_back(b1->Get<Hierarchy>().CreateChild());
+		}
+
+		std::atomic<unsigned> count = 0;
+		ParallelVisit(*root, [&](Entity&) { count++; });
+		CHECK(count == 1006);
+
+		JobSystem.Start(3);
+
+		count = 0;
+		ParallelVisit(*root, [&](Entity&) { count++; });
+		CHECK(count == 1006);
+
+		JobSystem.Stop();
+	}
+}
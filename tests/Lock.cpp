@@ -0,0 +1,176 @@
+#include <catch/catch.hpp>
+#include <gemcutter/Application/Lock.h>
+
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gem;
+
+namespace
+{
+	// Runs 'func(threadIndex)' on the given number of threads at once, and waits for them to finish.
+	template<typename Func>
+	void RunThreads(unsigned numThreads, Func func)
+	{
+		std::vector<std::thread> threads;
+		for (unsigned i = 0; i < numThreads; ++i)
+		{
+			threads.emplace_back(func, i);
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	}
+}
+
+TEST_CASE("Locks")
+{
+	constexpr unsigned numThreads = 4;
+	constexpr unsigned numIterations = 20000;
+
+	SECTION("SpinLock")
+	{
+		SpinLock lock;
+		CHECK(lock.try_lock());
+		CHECK(!lock.try_lock());
+		lock.unlock();
+
+		// The counter is deliberately not atomic. Only the lock keeps it consistent.
+		unsigned counter = 0;
+		RunThreads(numThreads, [&](unsigned) {
+			for (unsigned i = 0; i < numIterations; ++i)
+			{
+				std::lock_guard guard(lock);
+				counter++;
+			}
+		});
+
+		CHECK(counter == numThreads * numIterations);
+	}
+
+	SECTION("ReadWriteLock")
+	{
+		ReadWriteLock lock;
+
+		CHECK(lock.try_lock_shared());
+		CHECK(lock.try_lock_shared());
+		CHECK(!lock.try_lock());
+		lock.unlock_shared();
+		lock.unlock_shared();
+
+		CHECK(lock.try_lock());
+		CHECK(!lock.try_lock());
+		CHECK(!lock.try_lock_shared());
+		lock.unlock();
+
+		// Writers keep both values equal. Readers must never see them differ.
+		unsigned a = 0;
+		unsigned b = 0;
+		std::atomic<bool> consistent = true;
+		RunThreads(numThreads, [&](unsigned index) {
+			for (unsigned i = 0; i < numIterations; ++i)
+			{
+				if (index == 0 || i % 8 == 0)
+				{
+					std::lock_guard guard(lock);
+					a++;
+					b++;
+				}
+				else
+				{
+					std::shared_lock guard(lock);
+					if (a != b)
+					{
+						consistent = false;
+					}
+				}
+			}
+		});
+
+		CHECK(consistent);
+		CHECK(a == b);
+		CHECK(a == numIterations + (numThreads - 1) * (numIterations / 8));
+	}
+}
+
+TEST_CASE("Locks Benchmark", "[!benchmark]")
+{
+	constexpr unsigned numIterations = 100000;
+	const unsigned maxThreads = std::max(std::thread::hardware_concurrency(), 2u);
+
+	// A short critical section, typical of guarding a queue or a cache.
+	for (unsigned numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+	{
+		const std::string suffix = " " + std::to_string(numThreads) + " Threads";
+		unsigned counter = 0;
+
+		std::mutex mutex;
+		BENCHMARK("std::mutex" + suffix)
+		{
+			RunThreads(numThreads, [&](unsigned) {
+				for (unsigned i = 0; i < numIterations / numThreads; ++i)
+				{
+					std::lock_guard guard(mutex);
+					counter++;
+				}
+			});
+		}
+
+		SpinLock spinLock;
+		BENCHMARK("SpinLock" + suffix)
+		{
+			RunThreads(numThreads, [&](unsigned) {
+				for (unsigned i = 0; i < numIterations / numThreads; ++i)
+				{
+					std::lock_guard guard(spinLock);
+					counter++;
+				}
+			});
+		}
+	}
+
+	// Mostly readers, with the occasional writer.
+	for (unsigned numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+	{
+		const std::string suffix = " " + std::to_string(numThreads) + " Threads";
+		std::vector<unsigned> data(64, 1);
+		std::atomic<unsigned> sum = 0;
+
+		auto work = [&](auto& lock) {
+			RunThreads(numThreads, [&](unsigned) {
+				unsigned localSum = 0;
+				for (unsigned i = 0; i < numIterations / numThreads; ++i)
+				{
+					if (i % 64 == 0)
+					{
+						std::lock_guard guard(lock);
+						data[i % data.size()]++;
+					}
+					else
+					{
+						std::shared_lock guard(lock);
+						localSum += data[i % data.size()];
+					}
+				}
+				sum += localSum;
+			});
+		};
+
+		std::shared_mutex sharedMutex;
+		BENCHMARK("std::shared_mutex" + suffix)
+		{
+			work(sharedMutex);
+		}
+
+		ReadWriteLock readWriteLock;
+		BENCHMARK("ReadWriteLock" + suffix)
+		{
+			work(readWriteLock);
+		}
+	}
+}
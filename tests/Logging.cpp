@@ -0,0 +1,191 @@
+#include <catch/catch.hpp>
+#include <gemcutter/Application/Logging.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gem;
+
+namespace
+{
+	constexpr const char* LOG_FILE = "Log_Output.txt";
+
+	// Keeps the test's messages out of the console while it runs.
+	// The log is flushed on either side, so that the writer isn't using the console during the swap.
+	class CaptureConsole
+	{
+	public:
+		CaptureConsole() : previous((FlushLog(), std::cout.rdbuf(output.rdbuf()))) {}
+		~CaptureConsole() { FlushLog(); std::cout.rdbuf(previous); }
+
+		std::stringstream output;
+
+	private:
+		std::streambuf* previous;
+	};
+
+	std::vector<std::string> ReadLogFile()
+	{
+		std::vector<std::string> lines;
+		std::ifstream file(LOG_FILE);
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			lines.push_back(line);
+		}
+
+		return lines;
+	}
+}
+
+TEST_CASE("Logging")
+{
+	std::remove(LOG_FILE);
+	CaptureConsole console;
+	OpenOutputLog();
+
+	SECTION("Flush")
+	{
+		Log("First %d", 1);
+		Warning("Second");
+		Error("Third %s", "message");
+		FlushLog();
+
+		const auto lines = ReadLogFile();
+		REQUIRE(lines.size() == 3);
+		CHECK(lines[0] == "Log:     First 1");
+		CHECK(lines[1] == "WARNING: Second");
+		CHECK(lines[2] == "ERROR:   Third message");
+
+		CHECK(console.output.str() == "Log:     First 1\nWARNING: Second\nERROR:   Third message\n");
+	}
+
+	SECTION("Levels and Channels")
+	{
+		SetLogLevel(LogChannel::Render, LogLevel::Warning);
+		CHECK(GetLogLevel(LogChannel::Render) == LogLevel::Warning);
+		CHECK(GetLogLevel(LogChannel::ECS) == MIN_LOG_LEVEL);
+		CHECK_FALSE(IsLogEnabled(LogChannel::Render, LogLevel::Info));
+		CHECK(IsLogEnabled(LogChannel::ECS, LogLevel::Info));
+
+		Log(LogChannel::Render, "Hidden %d", 1);
+		Warning(LogChannel::Render, "Shown %d", 2);
+		Log(LogChannel::ECS, "Shown %d", 3);
+
+		SetLogLevel(LogLevel::Error);
+		Log("Hidden");
+		Warning("Hidden %d", 4);
+		Error(LogChannel::Network, "Shown");
+
+		SetLogLevel(LogLevel::Debug);
+		CHECK(GetLogLevel(LogChannel::Render) == MIN_LOG_LEVEL);
+		FlushLog();
+
+		const auto lines = ReadLogFile();
+		REQUIRE(lines.size() == 3);
+		CHECK(lines[0] == "WARNING: [Render] Shown 2");
+		CHECK(lines[1] == "Log:     [ECS] Shown 3");
+		CHECK(lines[2] == "ERROR:   [Network] Shown");
+	}
+
+	SECTION("Multiple Threads")
+	{
+		constexpr unsigned numThreads = 4;
+		constexpr unsigned numMessages = 200;
+
+		const unsigned droppedBefore = GetNumDroppedLogMessages();
+		std::vector<std::thread> threads;
+		for (unsigned t = 0; t < numThreads; ++t)
+		{
+			threads.emplace_back([t]() {
+				for (unsigned i = 0; i < numMessages; ++i)
+				{
+					Log("%u %u", t, i);
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		FlushLog();
+
+		// Every message is either written, or dropped and reported.
+		unsigned numLogged = 0;
+		unsigned nextIndex[numThreads] = {};
+		bool inOrder = true;
+		for (const std::string& line : ReadLogFile())
+		{
+			unsigned t = 0;
+			unsigned i = 0;
+			if (std::sscanf(line.c_str(), "Log:     %u %u", &t, &i) != 2)
+			{
+				continue;
+			}
+
+			// Messages from the same thread keep their order, even if some are dropped in between.
+			REQUIRE(t < numThreads);
+			inOrder = inOrder && i >= nextIndex[t];
+			nextIndex[t] = i + 1;
+			numLogged++;
+		}
+
+		CHECK(inOrder);
+		CHECK(numLogged + GetNumDroppedLogMessages() - droppedBefore == numThreads * numMessages);
+	}
+
+	SECTION("Overload")
+	{
+		// Far more than a thread's buffer can hold before the writer wakes up.
+		constexpr unsigned numMessages = 20000;
+
+		const unsigned droppedBefore = GetNumDroppedLogMessages();
+		for (unsigned i = 0; i < numMessages; ++i)
+		{
+			Log("%u", i);
+		}
+		FlushLog();
+
+		const unsigned dropped = GetNumDroppedLogMessages() - droppedBefore;
+
+		unsigned numLogged = 0;
+		bool reported = dropped == 0;
+		for (const std::string& line : ReadLogFile())
+		{
+			if (line.rfind("Log:     ", 0) == 0)
+			{
+				numLogged++;
+			}
+			else if (line.find("log messages were dropped") != std::string::npos)
+			{
+				reported = true;
+			}
+		}
+
+		CHECK(numLogged + dropped == numMessages);
+		CHECK(reported);
+	}
+
+	CloseOutputLog();
+	std::remove(LOG_FILE);
+}
+
+TEST_CASE("Logging Benchmark", "[!benchmark]")
+{
+	CaptureConsole console;
+
+	BENCHMARK("Log")
+	{
+		Log("Benchmark message %d", 42);
+	};
+
+	FlushLog();
+}
@@ -0,0 +1,209 @@
+#include <catch/catch.hpp>
+#include <gemcutter/Application/Profiler.h>
+#include <gemcutter/Application/Threading.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace gem;
+
+namespace
+{
+	unsigned CountSamples(const char* name)
+	{
+		const auto& capture = Profiler.GetCapture();
+		return std::count_if(capture.begin(), capture.end(), [name](const ProfileSample& sample) {
+			return std::string(sample.name) == name;
+		});
+	}
+
+	const ProfileSample* FindSample(const char* name)
+	{
+		for (const ProfileSample& sample : Profiler.GetCapture())
+		{
+			if (std::string(sample.name) == name)
+			{
+				return &sample;
+			}
+		}
+
+		return nullptr;
+	}
+}
+
+TEST_CASE("Profiler")
+{
+	SECTION("Not Capturing")
+	{
+		REQUIRE(!Profiler.IsCapturing());
+
+		{
+			GEM_PROFILE_SCOPE("Ignored");
+		}
+
+		Profiler.BeginCapture();
+		Profiler.EndCapture();
+		CHECK(Profiler.GetCapture().empty());
+	}
+
+	SECTION("Nested Scopes")
+	{
+		Profiler.BeginCapture();
+		CHECK(Profiler.IsCapturing());
+		{
+			GEM_PROFILE_SCOPE("Outer");
+			for (unsigned i = 0; i < 3; ++i)
+			{
+				GEM_PROFILE_SCOPE("Inner");
+			}
+		}
+		Profiler.EndCapture();
+		CHECK(!Profiler.IsCapturing());
+
+		CHECK(CountSamples("Outer") == 1);
+		CHECK(CountSamples("Inner") == 3);
+
+		// Every inner scope must be contained by the outer scope.
+		const ProfileSample* outer = FindSample("Outer");
+		REQUIRE(outer);
+		for (const ProfileSample& sample : Profiler.GetCapture())
+		{
+			CHECK(sample.start <= sample.end);
+			CHECK(sample.start >= outer->start);
+			CHECK(sample.end <= outer->end);
+			CHECK(sample.threadId == outer->threadId);
+		}
+
+		// A new capture discards the previous one.
+		Profiler.BeginCapture();
+		Profiler.EndCapture();
+		CHECK(Profiler.GetCapture().empty());
+	}
+
+	SECTION("Dropped Samples")
+	{
+		Profiler.BeginCapture();
+		for (unsigned i = 0; i < ProfilerSingleton::BUFFER_CAPACITY + 10; ++i)
+		{
+			GEM_PROFILE_SCOPE("Overflow");
+		}
+		Profiler.EndCapture();
+
+		CHECK(CountSamples("Overflow") == ProfilerSingleton::BUFFER_CAPACITY);
+		CHECK(Profiler.GetNumDropped() == 10);
+
+		// Collecting makes room for more samples.
+		Profiler.BeginCapture();
+		CHECK(Profiler.GetNumDropped() == 0);
+		for (unsigned i = 0; i < ProfilerSingleton::BUFFER_CAPACITY + 10; ++i)
+		{
+			GEM_PROFILE_SCOPE("Overflow");
+			if (i == 100)
+			{
+				Profiler.Collect();
+			}
+		}
+		Profiler.EndCapture();
+
+		CHECK(CountSamples("Overflow") == ProfilerSingleton::BUFFER_CAPACITY + 10);
+		CHECK(Profiler.GetNumDropped() == 0);
+	}
+
+	SECTION("Multiple Threads")
+	{
+		JobSystem.Start(3);
+		Profiler.BeginCapture();
+
+		JobCounter counter;
+		for (unsigned i = 0; i < 100; ++i)
+		{
+			JobSystem.Run([]() {
+				GEM_PROFILE_SCOPE("Job");
+			}, &counter);
+		}
+		JobSystem.Wait(counter);
+
+		// The worker threads have exited, but their samples are still collected.
+		JobSystem.Stop();
+		Profiler.EndCapture();
+
+		CHECK(CountSamples("Job") == 100);
+		CHECK(Profiler.GetNumDropped() == 0);
+
+		// New threads reuse the buffers left behind.
+		JobSystem.Start(3);
+		Profiler.BeginCapture();
+
+		JobCounter counter2;
+		for (unsigned i = 0; i < 100; ++i)
+		{
+			JobSystem.Run([]() {
+				GEM_PROFILE_SCOPE("Job");
+			}, &counter2);
+		}
+		JobSystem.Wait(counter2);
+
+		JobSystem.Stop();
+		Profiler.EndCapture();
+
+		CHECK(CountSamples("Job") == 100);
+		for (const ProfileSample& sample : Profiler.GetCapture())
+		{
+			CHECK(sample.threadId < 4);
+		}
+	}
+
+	SECTION("Chrome Trace")
+	{
+		Profiler.BeginCapture();
+		{
+			GEM_PROFILE_SCOPE("Frame");
+			GEM_PROFILE_SCOPE("Quoted \"Name\"");
+		}
+		Profiler.EndCapture();
+
+		const char* fileName = "ProfilerTest.json";
+		REQUIRE(Profiler.ExportChromeTrace(fileName));
+
+		std::stringstream contents;
+		contents << std::ifstream(fileName).rdbuf();
+		std::remove(fileName);
+
+		const std::string json = contents.str();
+		CHECK(json.find("\"traceEvents\":[") != std::string::npos);
+		CHECK(json.find("{\"name\":\"Frame\",\"ph\":\"X\"") != std::string::npos);
+		CHECK(json.find("\"name\":\"Quoted \\\"Name\\\"\"") != std::string::npos);
+		CHECK(json.find("\"dur\":") != std::string::npos);
+		CHECK(json.back() == '\n');
+	}
+}
+
+TEST_CASE("Profiler Benchmark", "[!benchmark]")
+{
+	constexpr unsigned numScopes = 1000;
+
+	BENCHMARK("Scopes Not Capturing")
+	{
+		for (unsigned i = 0; i < numScopes; ++i)
+		{
+			GEM_PROFILE_SCOPE("Benchmark");
+		}
+	}
+
+	Profiler.BeginCapture();
+
+	BENCHMARK("Scopes Capturing")
+	{
+		for (unsigned i = 0; i < numScopes; ++i)
+		{
+			GEM_PROFILE_SCOPE("Benchmark");
+		}
+
+		Profiler.Collect();
+	}
+
+	Profiler.EndCapture();
+}
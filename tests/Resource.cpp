@@ -0,0 +1,459 @@
+#include <catch/catch.hpp>
+#include <gemcutter/Application/FileSystem.h>
+#include <gemcutter/Application/Threading.h>
+#include <gemcutter/Resource/Resource.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace gem;
+
+namespace
+{
+	// Loads in two steps, like the assets that touch the graphics context.
+	class SplitAsset : public Resource<SplitAsset>
+	{
+	public:
+		bool Load(std::string filePath, int _value = 1)
+		{
+			return Decode(std::move(filePath), _value) && Upload();
+		}
+
+		bool Decode(std::string filePath, int _value = 1)
+		{
+			decodeThread = std::this_thread::get_id();
+			value = _value;
+			return filePath.find("Missing") == std::string::npos;
+		}
+
+		bool Upload()
+		{
+			uploadThread = std::this_thread::get_id();
+			isUploaded = true;
+			return true;
+		}
+
+		std::thread::id decodeThread;
+		std::thread::id uploadThread;
+		int value = 0;
+		bool isUploaded = false;
+	};
+
+	// Can only be loaded all at once.
+	class WholeAsset : public Resource<WholeAsset>
+	{
+	public:
+		bool Load(std::string)
+		{
+			loadThread = std::this_thread::get_id();
+			return true;
+		}
+
+		std::thread::id loadThread;
+	};
+
+	// Takes a while to load, and counts how many times it was loaded.
+	class SlowAsset : public Resource<SlowAsset>
+	{
+	public:
+		bool Load(std::string)
+		{
+			++numLoads;
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			return true;
+		}
+
+		static inline std::atomic<unsigned> numLoads = 0;
+	};
+
+	// Reports a fixed memory usage.
+	class SizedAsset : public Resource<SizedAsset>
+	{
+	public:
+		bool Load(std::string)
+		{
+			return true;
+		}
+
+		std::size_t GetMemoryUsage() const
+		{
+			return 100;
+		}
+	};
+
+	// Holds the contents of a text file.
+	class TextAsset : public Resource<TextAsset>
+	{
+	public:
+		bool Load(std::string filePath)
+		{
+			return Decode(std::move(filePath)) && Upload();
+		}
+
+		bool Decode(std::string filePath)
+		{
+			return LoadFileAsString(filePath + ".txt", staging);
+		}
+
+		bool Upload()
+		{
+			contents = std::move(staging);
+			return true;
+		}
+
+		std::string staging;
+		std::string contents;
+	};
+
+	// Takes on the contents of a reloaded version in place.
+	class SwappableTextAsset : public Resource<SwappableTextAsset>
+	{
+	public:
+		bool Load(std::string filePath)
+		{
+			return Decode(std::move(filePath)) && Upload();
+		}
+
+		bool Decode(std::string filePath)
+		{
+			return LoadFileAsString(filePath + ".txt", staging);
+		}
+
+		bool Upload()
+		{
+			contents = std::move(staging);
+			return true;
+		}
+
+		void SwapContents(SwappableTextAsset& other)
+		{
+			std::swap(contents, other.contents);
+		}
+
+		std::string staging;
+		std::string contents;
+	};
+
+	void WriteFile(const std::string& fileName, std::string_view contents)
+	{
+		std::ofstream output(fileName, std::ofstream::binary);
+		output.write(contents.data(), contents.size());
+	}
+}
+
+TEST_CASE("Resource")
+{
+	const double previousBudget = GetResourceUploadBudget();
+
+	SECTION("Async Load")
+	{
+		JobSystem.Start(2);
+
+		auto future = LoadAsync<SplitAsset>("Async.asset", 7);
+		REQUIRE(future.IsValid());
+
+		// The upload waits for the main thread.
+		while (GetNumPendingResourceUploads() == 0)
+		{
+			std::this_thread::yield();
+		}
+		CHECK_FALSE(future.IsReady());
+		CHECK(future.Get() == nullptr);
+		CHECK(Resource<SplitAsset>::Find(RootAssetDirectory + "Async.asset") == nullptr);
+
+		ProcessResourceUploads();
+		REQUIRE(future.GetStatus() == LoadStatus::Loaded);
+
+		auto asset = future.Get();
+		REQUIRE(asset);
+		CHECK(asset->value == 7);
+		CHECK(asset->isUploaded);
+		CHECK(asset->decodeThread != std::this_thread::get_id());
+		CHECK(asset->uploadThread == std::this_thread::get_id());
+
+		// Loaded assets are cached.
+		CHECK(Load<SplitAsset>("Async.asset") == asset);
+		auto cached = LoadAsync<SplitAsset>("Async.asset");
+		CHECK(cached.IsReady());
+		CHECK(cached.Get() == asset);
+
+		JobSystem.Stop();
+	}
+
+	SECTION("Wait")
+	{
+		JobSystem.Start(2);
+
+		auto future = LoadAsync<SplitAsset>("Wait.asset");
+		auto asset = future.Wait();
+		REQUIRE(asset);
+		CHECK(asset->isUploaded);
+		CHECK(future.GetStatus() == LoadStatus::Loaded);
+
+		JobSystem.Stop();
+	}
+
+	SECTION("Load From Worker")
+	{
+		JobSystem.Start(2);
+
+		// Like the PipelinedGameLoop, the main thread waits on a job which needs it to finish its loads.
+		std::shared_ptr<SplitAsset> split;
+		std::shared_ptr<WholeAsset> whole;
+		std::shared_ptr<SplitAsset> waited;
+		std::atomic<bool> isStarted = false;
+		JobCounter counter;
+		JobSystem.Run([&]() {
+			isStarted = true;
+			split = Load<SplitAsset>("Worker.asset", 3);
+			whole = Load<WholeAsset>("Worker.asset");
+			waited = LoadAsync<SplitAsset>("WorkerAsync.asset").Wait();
+		}, &counter);
+
+		// Makes sure the job is taken by a worker, rather than by the main thread once it starts waiting.
+		while (!isStarted)
+		{
+			std::this_thread::yield();
+		}
+		JobSystem.Wait(counter);
+
+		REQUIRE(split);
+		CHECK(split->value == 3);
+		CHECK(split->decodeThread != std::this_thread::get_id());
+		CHECK(split->uploadThread == std::this_thread::get_id());
+
+		REQUIRE(whole);
+		CHECK(whole->loadThread == std::this_thread::get_id());
+
+		REQUIRE(waited);
+		CHECK(waited->uploadThread == std::this_thread::get_id());
+
+		JobSystem.Stop();
+	}
+
+	SECTION("Failure")
+	{
+		auto future = LoadAsync<SplitAsset>("Missing.asset");
+		CHECK(future.Wait() == nullptr);
+		CHECK(future.GetStatus() == LoadStatus::Failed);
+		CHECK(Resource<SplitAsset>::Find(RootAssetDirectory + "Missing.asset") == nullptr);
+	}
+
+	SECTION("Whole Asset")
+	{
+		auto future = LoadAsync<WholeAsset>("Whole.asset");
+		CHECK_FALSE(future.IsReady());
+		CHECK(GetNumPendingResourceUploads() == 1);
+
+		ProcessResourceUploads();
+		REQUIRE(future.Get());
+		CHECK(future.Get()->loadThread == std::this_thread::get_id());
+	}
+
+	SECTION("Upload Budget")
+	{
+		SetResourceUploadBudget(0.0);
+
+		ResourceFuture<SplitAsset> futures[3];
+		for (unsigned i = 0; i < 3; ++i)
+		{
+			futures[i] = LoadAsync<SplitAsset>("Budget" + std::to_string(i) + ".asset");
+		}
+		CHECK(GetNumPendingResourceUploads() == 3);
+
+		// At least one upload is run each frame, no matter the budget.
+		ProcessResourceUploads();
+		CHECK(futures[0].IsReady());
+		CHECK_FALSE(futures[1].IsReady());
+		CHECK(GetNumPendingResourceUploads() == 2);
+
+		SetResourceUploadBudget(1000.0);
+		ProcessResourceUploads();
+		CHECK(futures[1].IsReady());
+		CHECK(futures[2].IsReady());
+		CHECK(GetNumPendingResourceUploads() == 0);
+	}
+
+	SECTION("Concurrent Load")
+	{
+		SlowAsset::numLoads = 0;
+
+		std::shared_ptr<SlowAsset> results[4];
+		std::vector<std::thread> threads;
+		for (auto& result : results)
+		{
+			threads.emplace_back([&result]() { result = Load<SlowAsset>("Concurrent.asset"); });
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		// Everyone waited on the same load.
+		CHECK(SlowAsset::numLoads == 1);
+		REQUIRE(results[0]);
+		for (auto& result : results)
+		{
+			CHECK(result == results[0]);
+		}
+
+		// Different files can be loaded at the same time.
+		threads.clear();
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			threads.emplace_back([i]() { Load<SlowAsset>("Parallel" + std::to_string(i) + ".asset"); });
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		CHECK(SlowAsset::numLoads == 5);
+	}
+
+	SECTION("In-Flight Load")
+	{
+		auto future = LoadAsync<WholeAsset>("InFlight.asset");
+		auto other = LoadAsync<WholeAsset>("InFlight.asset");
+		CHECK(GetNumPendingResourceUploads() == 1);
+
+		// A synchronous load waits for the pending one, instead of loading the file again.
+		auto asset = Load<WholeAsset>("InFlight.asset");
+		REQUIRE(asset);
+		CHECK(future.Get() == asset);
+		CHECK(other.Get() == asset);
+		CHECK(GetNumPendingResourceUploads() == 0);
+	}
+
+	SECTION("Failed Load")
+	{
+		CHECK(Load<SplitAsset>("Missing.asset") == nullptr);
+
+		// Failed loads are not cached, so they can be tried again.
+		auto future = LoadAsync<SplitAsset>("Missing.asset");
+		CHECK(GetNumPendingResourceUploads() == 1);
+		CHECK(future.Wait() == nullptr);
+	}
+
+	SECTION("Memory Budget")
+	{
+		auto a = Load<SizedAsset>("A.asset");
+		EnforceResourceBudgets();
+		auto b = Load<SizedAsset>("B.asset");
+		EnforceResourceBudgets();
+		auto c = Load<SizedAsset>("C.asset");
+		CHECK(Load<SizedAsset>("C.asset") == c);
+
+		ResourceStats stats = GetResourceStats<SizedAsset>();
+		CHECK(stats.numAssets == 3);
+		CHECK(stats.memoryUsage == 300);
+		CHECK(stats.numHits == 1);
+		CHECK(stats.numMisses == 3);
+
+		// Assets that are still referenced are never evicted.
+		SetResourceBudget<SizedAsset>(250);
+		EnforceResourceBudgets();
+		CHECK(GetResourceStats<SizedAsset>().numEvictions == 0);
+
+		// 'A' was used more recently than 'C', so 'C' is evicted first.
+		a.reset();
+		c.reset();
+		CHECK(Resource<SizedAsset>::Find(RootAssetDirectory + "A.asset"));
+		EnforceResourceBudgets();
+
+		stats = GetResourceStats<SizedAsset>();
+		CHECK(stats.numAssets == 2);
+		CHECK(stats.memoryUsage == 200);
+		CHECK(stats.memoryBudget == 250);
+		CHECK(stats.numEvictions == 1);
+		CHECK(Resource<SizedAsset>::Find(RootAssetDirectory + "A.asset"));
+		CHECK(Resource<SizedAsset>::Find(RootAssetDirectory + "C.asset") == nullptr);
+
+		// Everything unused can be unloaded at once, regardless of the budget.
+		CHECK(UnloadUnused<SizedAsset>() == 1);
+		stats = GetResourceStats<SizedAsset>();
+		CHECK(stats.numAssets == 1);
+		CHECK(stats.memoryUsage == 100);
+		CHECK(Resource<SizedAsset>::Find(RootAssetDirectory + "B.asset") == b);
+
+		// Assets without GetMemoryUsage() are measured by their size.
+		auto whole = Load<WholeAsset>("Measured.asset");
+		CHECK(GetResourceStats<WholeAsset>().memoryUsage == sizeof(WholeAsset));
+
+		SetResourceBudget<SizedAsset>(0);
+	}
+
+	SECTION("Hot Reload")
+	{
+		const std::string previousRoot = RootAssetDirectory;
+		REQUIRE(MakeDirectory("HotReloadTest/"));
+		RootAssetDirectory = "./HotReloadTest/";
+
+		WriteFile("HotReloadTest/Value.txt", "one");
+		auto asset = Load<TextAsset>("Value");
+		auto swappable = Load<SwappableTextAsset>("Value");
+		REQUIRE(asset);
+		REQUIRE(swappable);
+		CHECK(asset->contents == "one");
+		CHECK(swappable->contents == "one");
+
+		JobSystem.Start(2);
+		REQUIRE(EnableHotReload());
+		CHECK(IsHotReloadEnabled());
+
+		WriteFile("HotReloadTest/Value.txt", "two");
+
+		// The new versions are swapped in once they have been uploaded.
+		std::shared_ptr<TextAsset> reloaded;
+		for (unsigned i = 0; i < 200; ++i)
+		{
+			ReloadChangedResources();
+			ProcessResourceUploads();
+
+			// The file might be reported more than once while it is written, so wait for the final contents.
+			reloaded = Resource<TextAsset>::Find(RootAssetDirectory + "Value");
+			if (reloaded && reloaded->contents == "two" && swappable->contents == "two")
+			{
+				break;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		// Assets without SwapContents() are replaced in the cache, and the previous version is untouched.
+		REQUIRE(reloaded);
+		CHECK(reloaded != asset);
+		CHECK(reloaded->contents == "two");
+		CHECK(Load<TextAsset>("Value") == reloaded);
+		CHECK(GetResourceStats<TextAsset>().numAssets == 1);
+		CHECK(asset->contents == "one");
+
+		// Other assets are updated in place, so existing holders see the new version.
+		CHECK(swappable->contents == "two");
+		CHECK(Resource<SwappableTextAsset>::Find(RootAssetDirectory + "Value") == swappable);
+		CHECK(GetResourceStats<SwappableTextAsset>().numAssets == 1);
+
+		DisableHotReload();
+		CHECK_FALSE(IsHotReloadEnabled());
+		JobSystem.Stop();
+
+		RootAssetDirectory = previousRoot;
+		std::filesystem::remove_all("HotReloadTest");
+	}
+
+	SetResourceUploadBudget(previousBudget);
+	UnloadAll<SplitAsset>();
+	UnloadAll<WholeAsset>();
+	UnloadAll<SlowAsset>();
+	UnloadAll<SizedAsset>();
+	UnloadAll<TextAsset>();
+	UnloadAll<SwappableTextAsset>();
+}
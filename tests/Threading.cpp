@@ -0,0 +1,432 @@
+#include <catch/catch.hpp>
+#include <gemcutter/Application/TaskGraph.h>
+#include <gemcutter/Application/Threading.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gem;
+
+TEST_CASE("Job System")
+{
+	SECTION("Not Running")
+	{
+		REQUIRE(!JobSystem.IsRunning());
+
+		int count = 0;
+		JobCounter counter;
+		JobSystem.Run([&]() { count++; }, &counter);
+		CHECK(count == 1);
+		CHECK(counter.IsDone());
+
+		JobSystem.RunAfter(counter, [&]() { count++; });
+		CHECK(count == 2);
+	}
+
+	JobSystem.Start(3);
+	REQUIRE(JobSystem.IsRunning());
+	CHECK(JobSystem.GetNumWorkers() == 3);
+	CHECK(JobSystem.IsMainThread());
+
+	SECTION("Run")
+	{
+		std::atomic<unsigned> count = 0;
+		JobCounter counter;
+
+		for (unsigned i = 0; i < 1000; ++i)
+		{
+			JobSystem.Run([&]() { count++; }, &counter);
+		}
+
+		JobSystem.Wait(counter);
+		CHECK(counter.IsDone());
+		CHECK(count == 1000);
+	}
+
+	SECTION("Nested")
+	{
+		// Every job schedules more jobs from the thread it is running on.
+		std::atomic<unsigned> count = 0;
+		JobCounter counter;
+
+		for (unsigned i = 0; i < 10; ++i)
+		{
+			JobSystem.Run([&]() {
+				for (unsigned j = 0; j < 100; ++j)
+				{
+					JobSystem.Run([&]() { count++; }, &counter);
+				}
+			}, &counter);
+		}
+
+		JobSystem.Wait(counter);
+		CHECK(count == 1000);
+	}
+
+	SECTION("Dependencies")
+	{
+		std::atomic<unsigned> stage1 = 0;
+		std::atomic<unsigned> stage2 = 0;
+		std::atomic<bool> ordered = true;
+		std::atomic<bool> isReleased = false;
+		JobCounter counter1;
+		JobCounter counter2;
+
+		// Holds the first stage open until the dependents have been checked.
+		JobSystem.Run([&]() {
+			while (!isReleased)
+			{
+				std::this_thread::yield();
+			}
+		}, &counter1);
+
+		for (unsigned i = 0; i < 100; ++i)
+		{
+			JobSystem.Run([&]() { stage1++; }, &counter1);
+		}
+
+		for (unsigned i = 0; i < 100; ++i)
+		{
+			JobSystem.RunAfter(counter1, [&]() {
+				if (stage1 != 100)
+				{
+					ordered = false;
+				}
+				stage2++;
+			}, &counter2);
+		}
+
+		// The dependents are counted as soon as they are scheduled.
+		CHECK(!counter2.IsDone());
+		isReleased = true;
+
+		JobSystem.Wait(counter2);
+		CHECK(counter1.IsDone());
+		CHECK(stage2 == 100);
+		CHECK(ordered);
+	}
+
+	SECTION("Finished Dependency")
+	{
+		JobCounter counter;
+		JobSystem.Run([]() {}, &counter);
+		JobSystem.Wait(counter);
+
+		std::atomic<bool> done = false;
+		JobCounter dependentCounter;
+		JobSystem.RunAfter(counter, [&]() { done = true; }, &dependentCounter);
+
+		JobSystem.Wait(dependentCounter);
+		CHECK(done);
+	}
+
+	SECTION("Main Thread Affinity")
+	{
+		std::vector<int> order;
+		std::atomic<bool> onMainThread = true;
+		JobCounter counter;
+
+		// Scheduled from workers, but run by the main thread in the order they were scheduled.
+		JobCounter workerCounter;
+		JobSystem.Run([&]() {
+			for (int i = 0; i < 10; ++i)
+			{
+				JobSystem.Run([&, i]() {
+					onMainThread = onMainThread && JobSystem.IsMainThread();
+					order.push_back(i);
+				}, &counter, JobAffinity::MainThread);
+			}
+		}, &workerCounter);
+
+		JobSystem.Wait(workerCounter);
+		CHECK(order.empty());
+
+		JobSystem.ProcessMainThreadJobs();
+		CHECK(counter.IsDone());
+		CHECK(onMainThread);
+		CHECK(order == std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 });
+	}
+
+	SECTION("Wait Runs Main Thread Jobs")
+	{
+		bool done = false;
+		JobCounter counter;
+		JobSystem.Run([&]() {
+			JobSystem.Run([&]() { done = true; }, &counter, JobAffinity::MainThread);
+		}, &counter);
+
+		JobSystem.Wait(counter);
+		CHECK(done);
+	}
+
+	SECTION("Wait Wakes For New Jobs")
+	{
+		// The main thread goes to sleep in Wait() long before the main thread job is scheduled.
+		bool done = false;
+		std::atomic<bool> isStarted = false;
+		JobCounter counter;
+		JobSystem.Run([&]() {
+			isStarted = true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			JobSystem.Run([&]() { done = true; }, &counter, JobAffinity::MainThread);
+		}, &counter);
+
+		// Makes sure the job is taken by a worker, rather than by the main thread once it starts waiting.
+		while (!isStarted)
+		{
+			std::this_thread::yield();
+		}
+
+		JobSystem.Wait(counter);
+		CHECK(done);
+	}
+
+	SECTION("Stop Finishes Jobs")
+	{
+		std::atomic<unsigned> count = 0;
+		JobCounter counter;
+
+		for (unsigned i = 0; i < 1000; ++i)
+		{
+			JobSystem.Run([&]() { count++; }, &counter);
+		}
+
+		JobSystem.Stop();
+		CHECK(counter.IsDone());
+		CHECK(count == 1000);
+	}
+
+	if (JobSystem.IsRunning())
+	{
+		JobSystem.Stop();
+	}
+
+	CHECK(!JobSystem.IsRunning());
+	CHECK(JobSystem.GetNumWorkers() == 0);
+}
+
+TEST_CASE("Job System Benchmark", "[!benchmark]")
+{
+	constexpr unsigned numJobs = 10000;
+
+	JobSystem.Start();
+
+	BENCHMARK("Empty Jobs")
+	{
+		JobCounter counter;
+		for (unsigned i = 0; i < numJobs; ++i)
+		{
+			JobSystem.Run([]() {}, &counter);
+		}
+
+		JobSystem.Wait(counter);
+	}
+
+	BENCHMARK("Nested Jobs")
+	{
+		JobCounter counter;
+		for (unsigned i = 0; i < numJobs / 100; ++i)
+		{
+			JobSystem.Run([&]() {
+				for (unsigned j = 0; j < 100; ++j)
+				{
+					JobSystem.Run([]() {}, &counter);
+				}
+			}, &counter);
+		}
+
+		JobSystem.Wait(counter);
+	}
+
+	JobSystem.Stop();
+}
+
+TEST_CASE("Parallel For")
+{
+	SECTION("Not Running")
+	{
+		std::vector<unsigned> values(100, 0);
+		ParallelFor(0, 100, 7, [&](unsigned i) { values[i] = i; });
+
+		for (unsigned i = 0; i < values.size(); ++i)
+		{
+			CHECK(values[i] == i);
+		}
+	}
+
+	JobSystem.Start(3);
+
+	SECTION("Every Index Once")
+	{
+		for (unsigned grain : { 1u, 3u, 64u, 1000u, 5000u })
+		{
+			std::vector<std::atomic<unsigned>> visits(1000);
+			ParallelFor(0, 1000, grain, [&](unsigned i) { visits[i]++; });
+
+			bool once = true;
+			for (auto& count : visits)
+			{
+				once = once && count == 1;
+			}
+
+			CHECK(once);
+		}
+	}
+
+	SECTION("Sub Range")
+	{
+		std::atomic<unsigned> sum = 0;
+		ParallelFor(10, 20, 2, [&](unsigned i) { sum += i; });
+		CHECK(sum == 145);
+
+		ParallelFor(5, 5, 1, [&](unsigned) { sum = 0; });
+		CHECK(sum == 145);
+	}
+
+	SECTION("Nested")
+	{
+		std::atomic<unsigned> count = 0;
+		ParallelFor(0, 16, 1, [&](unsigned) {
+			ParallelFor(0, 100, 10, [&](unsigned) { count++; });
+		});
+
+		CHECK(count == 1600);
+	}
+
+	JobSystem.Stop();
+}
+
+TEST_CASE("Task Graph")
+{
+	std::vector<int> order;
+	std::mutex orderLock;
+	auto record = [&](int id) {
+		return [&, id]() {
+			std::lock_guard guard(orderLock);
+			order.push_back(id);
+		};
+	};
+
+	// 0 -> 1 -> 3
+	// 0 -> 2 -> 3
+	TaskGraph graph;
+	auto t0 = graph.Add(record(0));
+	auto t1 = graph.Add(record(1));
+	auto t2 = graph.Add(record(2));
+	auto t3 = graph.Add(record(3), JobAffinity::MainThread);
+	graph.AddDependency(t1, t0);
+	graph.AddDependency(t2, t0);
+	graph.AddDependency(t3, t1);
+	graph.AddDependency(t3, t2);
+	CHECK(graph.GetNumTasks() == 4);
+	CHECK(graph.IsAcyclic());
+
+	SECTION("Not Running")
+	{
+		graph.Run();
+		REQUIRE(order.size() == 4);
+		CHECK(order.front() == 0);
+		CHECK(order.back() == 3);
+	}
+
+	SECTION("Running")
+	{
+		JobSystem.Start(3);
+
+		for (unsigned i = 0; i < 100; ++i)
+		{
+			order.clear();
+			graph.Run();
+
+			REQUIRE(order.size() == 4);
+			CHECK(order.front() == 0);
+			CHECK(order.back() == 3);
+		}
+
+		// A wide and deep graph, where every task depends on the previous layer.
+		TaskGraph layers;
+		std::atomic<unsigned> count = 0;
+		std::atomic<bool> ordered = true;
+		std::vector<TaskGraph::TaskId> previous;
+		for (unsigned layer = 0; layer < 10; ++layer)
+		{
+			std::vector<TaskGraph::TaskId> current;
+			for (unsigned i = 0; i < 10; ++i)
+			{
+				current.push_back(layers.Add([&, layer]() {
+					if (count.fetch_add(1) < layer * 10)
+					{
+						ordered = false;
+					}
+				}));
+
+				for (auto id : previous)
+				{
+					layers.AddDependency(current.back(), id);
+				}
+			}
+
+			previous = std::move(current);
+		}
+
+		layers.Run();
+		CHECK(count == 100);
+		CHECK(ordered);
+
+		JobSystem.Stop();
+	}
+
+	SECTION("Cycle")
+	{
+		graph.AddDependency(t0, t3);
+		CHECK(!graph.IsAcyclic());
+	}
+
+	SECTION("Clear")
+	{
+		graph.Clear();
+		CHECK(graph.GetNumTasks() == 0);
+
+		graph.Run();
+		CHECK(order.empty());
+	}
+}
+
+TEST_CASE("Parallel For Benchmark", "[!benchmark]")
+{
+	// Enough work per index that the scaling is visible over the scheduling overhead.
+	std::vector<float> values(1 << 20);
+	auto work = [&](unsigned i) {
+		float x = static_cast<float>(i);
+		for (unsigned j = 0; j < 16; ++j)
+		{
+			x = std::sqrt(x * x + 1.0f);
+		}
+		values[i] = x;
+	};
+
+	const unsigned maxThreads = std::max(std::thread::hardware_concurrency(), 2u);
+	for (unsigned numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+	{
+		if (numThreads > 1)
+		{
+			JobSystem.Start(numThreads - 1);
+		}
+
+		BENCHMARK("ParallelFor " + std::to_string(numThreads) + " Threads")
+		{
+			ParallelFor(0, values.size(), 4096, work);
+		}
+
+		if (JobSystem.IsRunning())
+		{
+			JobSystem.Stop();
+		}
+	}
+}
@@ -0,0 +1,114 @@
+#include <catch/catch.hpp>
+#include <gemcutter/Application/Timer.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace gem;
+
+TEST_CASE("Timer")
+{
+	SECTION("Resolution")
+	{
+		CHECK(Timer::IsSupported());
+		CHECK(Timer::GetTicksPerSecond() == 1000000000);
+		CHECK(Timer::GetTicksPerMS() == 1000000);
+	}
+
+	SECTION("Elapsed Time")
+	{
+		Timer timer;
+		CHECK(!timer.IsElapsedSeconds(10.0));
+
+		timer.AddTimeSeconds(10.0);
+		CHECK(timer.IsElapsedSeconds(10.0));
+		CHECK(timer.GetElapsedMS() >= 10000.0);
+
+		timer.SubtractTimeMS(10000.0);
+		CHECK(!timer.IsElapsedSeconds(10.0));
+		CHECK(timer.GetElapsedSeconds() < 1.0);
+
+		timer.AddTimeMS(500.0);
+		CHECK(timer.IsElapsedMS(500.0));
+
+		timer.Reset();
+		CHECK(!timer.IsElapsedMS(500.0));
+	}
+
+	SECTION("SleepUntil")
+	{
+		// Deadlines shorter than a typical sleep are spun out, longer ones mostly slept.
+		for (std::int64_t ms : { 0, 1, 5, 20 })
+		{
+			const std::int64_t deadline = Timer::GetCurrentTick() + ms * Timer::GetTicksPerMS();
+			Timer::SleepUntil(deadline);
+
+			const std::int64_t wakeTime = Timer::GetCurrentTick();
+			CHECK(wakeTime >= deadline);
+			// Generous, since the test machine can be busy.
+			CHECK(wakeTime - deadline < 5 * Timer::GetTicksPerMS());
+		}
+
+		// Deadlines in the past return right away.
+		Timer timer;
+		Timer::SleepUntil(Timer::GetCurrentTick() - Timer::GetTicksPerSecond());
+		CHECK(timer.GetElapsedMS() < 5.0);
+	}
+
+	SECTION("Sleep Resolution")
+	{
+		// Without the scope, Windows would round the sleep up to its default 15.6ms resolution.
+		const SleepResolutionScope resolution;
+		{
+			const SleepResolutionScope nested;
+		}
+
+		Timer timer;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		CHECK(timer.GetElapsedMS() < 5.0);
+	}
+
+	SECTION("Frame Clock")
+	{
+		FrameClock clock;
+		CHECK(clock.GetDeltaTicks() == 0);
+		CHECK(clock.GetElapsedSeconds() == 0.0);
+
+		std::int64_t previous = clock.GetFrameTick();
+		for (unsigned i = 0; i < 100; ++i)
+		{
+			const std::int64_t frame = clock.Tick();
+			CHECK(frame == clock.GetFrameTick());
+			CHECK(frame >= previous);
+			CHECK(clock.GetDeltaTicks() == frame - previous);
+			previous = frame;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		clock.Tick();
+		CHECK(clock.GetDeltaSeconds() >= 0.002);
+		CHECK(clock.GetElapsedSeconds() >= 0.002);
+
+		// The frame's time stays fixed until the next tick.
+		const std::int64_t frame = clock.GetFrameTick();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		CHECK(clock.GetFrameTick() == frame);
+
+		clock.Reset();
+		CHECK(clock.GetDeltaTicks() == 0);
+		CHECK(clock.GetFrameTick() >= frame);
+	}
+}
+
+TEST_CASE("Timer Benchmark", "[!benchmark]")
+{
+	BENCHMARK("GetCurrentTick")
+	{
+		Timer::GetCurrentTick();
+	}
+
+	BENCHMARK("SleepUntil 1ms")
+	{
+		Timer::SleepUntil(Timer::GetCurrentTick() + Timer::GetTicksPerMS());
+	}
+}
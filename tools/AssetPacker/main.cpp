@@ -0,0 +1,81 @@
+// Copyright (c) 2022 Emilian Cioca
+#include <gemcutter/Application/CmdArgs.h>
+#include <gemcutter/Application/FileSystem.h>
+#include <gemcutter/Application/Logging.h>
+#include <gemcutter/Resource/AssetPack.h>
+
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+	// Adds every file in the directory and its subdirectories, named by their path from the root directory.
+	bool AddDirectory(gem::AssetPackWriter& writer, const std::string& directory, const std::string& packPath, const std::string& excludedFile)
+	{
+		gem::DirectoryData data;
+		if (!gem::ParseDirectory(data, directory))
+		{
+			gem::Error("Could not read the directory \"%s\".", directory.c_str());
+			return false;
+		}
+
+		for (const std::string& file : data.files)
+		{
+			const std::string filePath = directory + '/' + file;
+			if (packPath.empty() && file == excludedFile)
+			{
+				continue;
+			}
+
+			if (!writer.AddFile(packPath + file, filePath))
+			{
+				return false;
+			}
+		}
+
+		for (const std::string& folder : data.folders)
+		{
+			if (!AddDirectory(writer, directory + '/' + folder, packPath + folder + '/', excludedFile))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+// Combines the packed assets in a directory into a single asset pack, to be loaded with gem::MountAssetPack().
+// Usage: asset_packer -src <packed asset directory> [-dest Assets.pack]
+int main()
+{
+	std::string source;
+	if (!gem::GetCommandLineArg("-src", source))
+	{
+		gem::Error("Missing the \"-src\" argument.");
+		return EXIT_FAILURE;
+	}
+
+	while (!source.empty() && (source.back() == '/' || source.back() == '\\'))
+	{
+		source.pop_back();
+	}
+
+	std::string destination = "Assets.pack";
+	gem::GetCommandLineArg("-dest", destination);
+
+	// The pack might be saved into the directory that it is built from.
+	gem::AssetPackWriter writer;
+	if (!AddDirectory(writer, source, "", gem::ExtractFile(destination)))
+	{
+		return EXIT_FAILURE;
+	}
+
+	if (!writer.Save(destination))
+	{
+		return EXIT_FAILURE;
+	}
+
+	gem::Log("Packed %u files into \"%s\".", writer.GetNumFiles(), destination.c_str());
+	return EXIT_SUCCESS;
+}
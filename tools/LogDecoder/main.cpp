@@ -0,0 +1,46 @@
+// Copyright (c) 2022 Emilian Cioca
+#include <gemcutter/Application/BinaryLog.h>
+#include <gemcutter/Application/CmdArgs.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Converts a binary log to text.
+// Usage: log_decoder [-input Log_Output.bin] [-output file.txt]
+// The text is printed to the console unless an output file is given.
+int main()
+{
+	std::string inputFile = "Log_Output.bin";
+	gem::GetCommandLineArg("-input", inputFile);
+
+	std::ifstream input(inputFile, std::ifstream::binary);
+	if (!input)
+	{
+		gem::Error("Could not open \"%s\".", inputFile.c_str());
+		return EXIT_FAILURE;
+	}
+
+	std::string outputFile;
+	if (gem::GetCommandLineArg("-output", outputFile))
+	{
+		std::ofstream output(outputFile);
+		if (!output)
+		{
+			gem::Error("Could not open \"%s\" for writing.", outputFile.c_str());
+			return EXIT_FAILURE;
+		}
+
+		if (!gem::DecodeBinaryLog(input, output))
+		{
+			return EXIT_FAILURE;
+		}
+	}
+	else if (!gem::DecodeBinaryLog(input, std::cout))
+	{
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -1,15 +1,18 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "MeshEncoder.h"
 
+#include <gemcutter/Application/FileSystem.h>
 #include <gemcutter/Math/Matrix.h>
 #include <gemcutter/Math/Vector.h>
 #include <gemcutter/Resource/Encoder.h>
 
-#include <fstream>
+#include <cfloat>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
 #include <vector>
 
 #define CURRENT_VERSION 2
-#define CHAR_BUFFER_SIZE 128
 
 // Indices for three points; one triangle. v1/vt1/vn1 v2/vt2/vn2 v3/vt3/vn3
 struct MeshFace
@@ -23,6 +26,32 @@ struct MeshFace
 	gem::vec4 tangent[3];
 };
 
+namespace
+{
+	// Reads one point of a face, in the format "v", "v/vt", "v//vn", or "v/vt/vn".
+	// Missing indices are left as 0.
+	void ParseFacePoint(std::string_view text, unsigned& vertex, unsigned& texture, unsigned& normal)
+	{
+		vertex = 0;
+		texture = 0;
+		normal = 0;
+
+		for (unsigned* index : { &vertex, &texture, &normal })
+		{
+			const std::size_t slash = text.find('/');
+			const std::string_view number = text.substr(0, slash);
+			std::from_chars(number.data(), number.data() + number.size(), *index);
+
+			if (slash == std::string_view::npos)
+			{
+				break;
+			}
+
+			text.remove_prefix(slash + 1);
+		}
+	}
+}
+
 MeshEncoder::MeshEncoder()
 	: Encoder(CURRENT_VERSION)
 {
@@ -98,15 +127,13 @@ bool MeshEncoder::Convert(std::string_view source, std::string_view destination,
 	const bool packTangents = metadata.GetBool("tangents");
 
 	// Load ASCII file.
-	std::ifstream input;
-	input.open(source.data());
-	if (!input)
+	gem::FileReader input;
+	if (!input.OpenAsMapped(source))
 	{
 		gem::Error("Input file could not be opened or processed.");
 		return false;
 	}
 
-	char inputString[CHAR_BUFFER_SIZE] = { '\0' };
 	bool hasUvs = false;
 	bool hasNormals = false;
 
@@ -120,122 +147,74 @@ bool MeshEncoder::Convert(std::string_view source, std::string_view destination,
 	gem::vec3 minBounds{ FLT_MAX };
 	gem::vec3 maxBounds{ FLT_MIN };
 
-	while (!input.eof())
+	while (!input.IsEOF())
 	{
-		input.getline(inputString, CHAR_BUFFER_SIZE);
+		const std::string_view keyword = input.GetWordView();
 
-		if (inputString[0] == 'v')
+		if (keyword == "vt")
 		{
-			if (inputString[1] == 't')
-			{
-				hasUvs = true;
-
-				if (!(packUvs || packTangents))
-					continue;
+			hasUvs = true;
 
+			if (packUvs || packTangents)
+			{
 				// Load texture coordinates.
-				char* endPtr;
 				gem::vec2 temp;
-				temp.x = std::strtof(inputString + 3, &endPtr);
-				temp.y = std::strtof(endPtr + 1, nullptr);
+				temp.x = input.GetFloat();
+				temp.y = input.GetFloat();
 
 				textureData.push_back(temp);
 			}
-			else if (inputString[1] == 'n')
-			{
-				hasNormals = true;
-
-				if (!(packNormals || packTangents))
-					continue;
+		}
+		else if (keyword == "vn")
+		{
+			hasNormals = true;
 
+			if (packNormals || packTangents)
+			{
 				// Load normals.
-				char* endPtr;
 				gem::vec3 temp;
-				temp.x = std::strtof(inputString + 3, &endPtr);
-				temp.y = std::strtof(endPtr + 1, &endPtr);
-				temp.z = std::strtof(endPtr + 1, nullptr);
+				temp.x = input.GetFloat();
+				temp.y = input.GetFloat();
+				temp.z = input.GetFloat();
 
 				normalData.push_back(temp);
 			}
-			else
-			{
-				// Load vertices.
-				char* endPtr;
-				gem::vec3 temp;
-				temp.x = std::strtof(inputString + 2, &endPtr);
-				temp.y = std::strtof(endPtr + 1, &endPtr);
-				temp.z = std::strtof(endPtr + 1, nullptr);
+		}
+		else if (keyword == "v")
+		{
+			// Load vertices.
+			gem::vec3 temp;
+			temp.x = input.GetFloat();
+			temp.y = input.GetFloat();
+			temp.z = input.GetFloat();
 
-				if (temp.x < minBounds.x) minBounds.x = temp.x;
-				if (temp.y < minBounds.y) minBounds.y = temp.y;
-				if (temp.z < minBounds.z) minBounds.z = temp.z;
+			if (temp.x < minBounds.x) minBounds.x = temp.x;
+			if (temp.y < minBounds.y) minBounds.y = temp.y;
+			if (temp.z < minBounds.z) minBounds.z = temp.z;
 
-				if (temp.x > maxBounds.x) maxBounds.x = temp.x;
-				if (temp.y > maxBounds.y) maxBounds.y = temp.y;
-				if (temp.z > maxBounds.z) maxBounds.z = temp.z;
+			if (temp.x > maxBounds.x) maxBounds.x = temp.x;
+			if (temp.y > maxBounds.y) maxBounds.y = temp.y;
+			if (temp.z > maxBounds.z) maxBounds.z = temp.z;
 
-				vertexData.push_back(temp);
-			}
+			vertexData.push_back(temp);
 		}
-		else if (inputString[0] == 'f')
+		else if (keyword == "f")
 		{
 			// Load face indices.
 			MeshFace face;
-			char* endPtr;
-
-			// Each permutation of data formats.
-			if (hasUvs && hasNormals)
-			{
-				// Format of "f #/#/# #/#/# #/#/#"
-				face.vertices[0] = std::strtol(inputString + 2, &endPtr, 10);
-				face.textures[0] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.normals[0] = std::strtol(endPtr + 1, &endPtr, 10);
-
-				face.vertices[1] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.textures[1] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.normals[1] = std::strtol(endPtr + 1, &endPtr, 10);
-
-				face.vertices[2] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.textures[2] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.normals[2] = std::strtol(endPtr + 1, nullptr, 10);
-			}
-			else if (hasUvs && !hasNormals)
+			for (unsigned i = 0; i < 3; ++i)
 			{
-				// Format: "f #/# #/# #/#"
-				face.vertices[0] = std::strtol(inputString + 2, &endPtr, 10);
-				face.textures[0] = std::strtol(endPtr + 1, &endPtr, 10);
-
-				face.vertices[1] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.textures[1] = std::strtol(endPtr + 1, &endPtr, 10);
-
-				face.vertices[2] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.textures[2] = std::strtol(endPtr + 1, nullptr, 10);
-			}
-			else if (!hasUvs && hasNormals)
-			{
-				// Format: "f #//# #//# #//#"
-				face.vertices[0] = std::strtol(inputString + 2, &endPtr, 10);
-				face.normals[0] = std::strtol(endPtr + 2, &endPtr, 10);
-
-				face.vertices[1] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.normals[1] = std::strtol(endPtr + 2, &endPtr, 10);
-
-				face.vertices[2] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.normals[2] = std::strtol(endPtr + 2, nullptr, 10);
-			}
-			else
-			{
-				// Format: "f # # #"
-				face.vertices[0] = std::strtol(inputString + 2, &endPtr, 10);
-				face.vertices[1] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.vertices[2] = std::strtol(endPtr + 1, nullptr, 10);
+				ParseFacePoint(input.GetWordView(), face.vertices[i], face.textures[i], face.normals[i]);
 			}
 
 			faceData.push_back(face);
 		}
+
+		// Skip the rest of the line, including comments and unsupported statements.
+		input.GetLineView();
 	}
 
-	input.close();
+	input.Close();
 
 	// Apply scale.
 	if (scale != 1.0f)